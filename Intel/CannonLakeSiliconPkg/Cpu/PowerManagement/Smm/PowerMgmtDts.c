@@ -52,6 +52,18 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINT8               (*mDtsThresholdTable) [3];
 GLOBAL_REMOVE_IF_UNREFERENCED UINT8               gIsPackageTempMsrAvailable;
 GLOBAL_REMOVE_IF_UNREFERENCED UINT8               mThreadsPerCore;
 GLOBAL_REMOVE_IF_UNREFERENCED UINT8               *mCoreTemp;
+GLOBAL_REMOVE_IF_UNREFERENCED UINT8               mDtsThresholdIndex[MAX_UINT8 + 1];
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN               mDtsNumberOfCores;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN               *mDtsCoreCpu;
+GLOBAL_REMOVE_IF_UNREFERENCED VOID                **mDtsCoreTempBuffer;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN               mDtsNumberOfPackages;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN               *mDtsPackageCpu;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN               *mDtsCpuPackage;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN               *mDtsPackageCpuList;
+GLOBAL_REMOVE_IF_UNREFERENCED UINT8               *mDtsPackageTemp;
+GLOBAL_REMOVE_IF_UNREFERENCED VOID                **mDtsPackageTempBuffer;
+GLOBAL_REMOVE_IF_UNREFERENCED UINT32              mDtsThreadWakeCount;
+GLOBAL_REMOVE_IF_UNREFERENCED DTS_SMI_STATISTICS  mDtsSmiStatistics;
 
 ///
 /// The table is updated for the current CPU.
@@ -121,33 +133,70 @@ DigitalThermalSensorUpdatePTID (
   VOID
   )
 {
-  UINT8 Index;
+  UINTN Index;
 
   ///
-  /// Get DTS temperature for all cores.
+  /// Get DTS temperature for all cores. The cores are sampled in parallel.
   ///
-  for (Index = 0; Index < gSmst->NumberOfCpus / mThreadsPerCore; Index++) {
+  for (Index = 0; Index < mDtsNumberOfCores; Index++) {
     mCoreTemp[Index] = 0;
-    RunOnSpecificLogicalProcessor (DigitalThermalSensorUpdateTemperature, Index * mThreadsPerCore, &mCoreTemp[Index]);
   }
+  RunOnLogicalProcessorList (
+    DigitalThermalSensorUpdateTemperature,
+    mDtsCoreCpu,
+    mDtsNumberOfCores,
+    mDtsCoreTempBuffer,
+    NULL
+    );
 
   mCpuNvsAreaPtr->BspDigitalThermalSensorTemperature = mCoreTemp[0];
 
-  if ((gSmst->NumberOfCpus / mThreadsPerCore) > 1) {
+  if (mDtsNumberOfCores > 1) {
     mCpuNvsAreaPtr->ApDigitalThermalSensorTemperature = mCoreTemp[1];
   }
 
-  if ((gSmst->NumberOfCpus / mThreadsPerCore) > 2) {
+  if (mDtsNumberOfCores > 2) {
     mCpuNvsAreaPtr->Ap2DigitalThermalSensorTemperature = mCoreTemp[2];
   }
 
-  if ((gSmst->NumberOfCpus / mThreadsPerCore) > 3) {
+  if (mDtsNumberOfCores > 3) {
     mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature = mCoreTemp[3];
   }
 
   return EFI_SUCCESS;
 }
 
+/**
+  Reprogram the thresholds of the cores reported through the CPU NVS area.
+  Note for DTS purpose BspDigitalThermalSensorTemperature is always Core 0.
+  However, SMM BSP could be any logical processor.
+**/
+VOID
+DigitalThermalSensorSetCoreThreshold (
+  VOID
+  )
+{
+  VOID  *BufferList[4];
+  UINTN NumberOfCores;
+
+  BufferList[0] = &mCpuNvsAreaPtr->BspDigitalThermalSensorTemperature;
+  BufferList[1] = &mCpuNvsAreaPtr->ApDigitalThermalSensorTemperature;
+  BufferList[2] = &mCpuNvsAreaPtr->Ap2DigitalThermalSensorTemperature;
+  BufferList[3] = &mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature;
+
+  ///
+  /// Start all cores together so the threshold update costs a single wait.
+  ///
+  NumberOfCores = MIN (mDtsNumberOfCores, ARRAY_SIZE (BufferList));
+  RunOnLogicalProcessorList (
+    DigitalThermalSensorSetThreshold,
+    mDtsCoreCpu,
+    NumberOfCores,
+    BufferList,
+    NULL
+    );
+}
+
 /**
   SMI handler to handle Digital Thermal Sensor CPU Local APIC SMI
   for thermal Out Of Spec interrupt
@@ -212,8 +261,15 @@ DtsOutOfSpecSmiCallback (
 /**
   Call from SMI handler to handle Package thermal temperature Digital Thermal Sensor CPU Local APIC SMI
   for thermal threshold interrupt
+
+  The package thermal status is sampled once per package. Only when a package
+  threshold fired, or every SMI update is requested, are the cores woken up to
+  refresh the per-core temperatures and re-arm their Local APIC.
+
+  @retval TRUE     The thresholds were reprogrammed.
+  @retval FALSE    No package event was pending.
 **/
-VOID
+BOOLEAN
 PackageThermalDTS (
   VOID
   )
@@ -236,6 +292,13 @@ PackageThermalDTS (
       /// Handle Package events
       ///
 
+      ///
+      /// Update temperatures for PTID only when the package reported a threshold crossing
+      ///
+      if ((PkgEventType == DtsEventThreshold) || mUpdateDtsInEverySmi) {
+        DigitalThermalSensorUpdatePTID ();
+      }
+
       ///
       /// Set the thermal trip toints as needed.
       ///
@@ -258,6 +321,55 @@ PackageThermalDTS (
     /// Enable Local APIC SMI on all logical processors
     ///
     RunOnAllLogicalProcessors (DigitalThermalSensorEnableSmi, NULL);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/**
+  Update the DTS SMI statistics at the end of a DTS SMI.
+
+  @param[in] StartTime         Performance counter value at handler entry.
+  @param[in] StartWakeCount    mDtsThreadWakeCount value at handler entry.
+  @param[in] EventHandled      TRUE if the thresholds were reprogrammed.
+**/
+VOID
+DtsUpdateSmiStatistics (
+  IN UINT64  StartTime,
+  IN UINT32  StartWakeCount,
+  IN BOOLEAN EventHandled
+  )
+{
+  UINT64 Residency;
+  UINT32 ThreadWakeCount;
+
+  Residency       = GetTimeInNanoSecond (GetPerformanceCounter () - StartTime);
+  ThreadWakeCount = mDtsThreadWakeCount - StartWakeCount;
+
+  mDtsSmiStatistics.SmiCount++;
+  if (EventHandled) {
+    mDtsSmiStatistics.EventCount++;
+  }
+  if (ThreadWakeCount == 0) {
+    mDtsSmiStatistics.FastPathCount++;
+  }
+  mDtsSmiStatistics.LastThreadWakeCount   = ThreadWakeCount;
+  mDtsSmiStatistics.TotalThreadWakeCount += ThreadWakeCount;
+  mDtsSmiStatistics.LastResidency         = Residency;
+  mDtsSmiStatistics.MaxResidency          = MAX (mDtsSmiStatistics.MaxResidency, Residency);
+  mDtsSmiStatistics.TotalResidency       += Residency;
+
+  if (EventHandled) {
+    DEBUG ((
+      DEBUG_VERBOSE,
+      "DTS SMI: %ld ns, %d thread wakes (SMIs %d, events %d, fast path %d)\n",
+      Residency,
+      ThreadWakeCount,
+      mDtsSmiStatistics.SmiCount,
+      mDtsSmiStatistics.EventCount,
+      mDtsSmiStatistics.FastPathCount
+      ));
   }
 }
 
@@ -280,8 +392,10 @@ DtsSmiCallback (
   IN OUT UINTN   *SourceSize           OPTIONAL
   )
 {
-  UINTN          Index;
   DTS_EVENT_TYPE EventType;
+  UINT64         StartTime;
+  UINT32         StartWakeCount;
+  BOOLEAN        EventHandled;
   ///
   /// If not enabled; return.  (The DTS will be disabled upon S3 entry
   /// and will remain disabled until after re-initialized upon wake.)
@@ -289,12 +403,20 @@ DtsSmiCallback (
   if (!mDtsEnabled) {
     return EFI_SUCCESS;
   }
+
+  StartTime      = GetPerformanceCounter ();
+  StartWakeCount = mDtsThreadWakeCount;
+  EventHandled   = FALSE;
   ///
   /// Get the Package thermal temperature
   ///
   if (gIsPackageTempMsrAvailable) {
-    RunOnAllLogicalProcessors (DigitalThermalSensorEnableSmi, NULL);
-    PackageThermalDTS ();
+    ///
+    /// The package thermal interrupt reaches every logical processor, so a thread that
+    /// lost its enable through INIT-SIPI-SIPI does not hide the event. Only wake the APs
+    /// when an event is handled; PackageThermalDTS() re-arms all of them then.
+    ///
+    EventHandled = PackageThermalDTS ();
   } else {
     ///
     /// We enable the Thermal interrupt on the AP's prior to the event check
@@ -303,14 +425,12 @@ DtsSmiCallback (
     /// interrupt to be re-enabled due to chipset-based SMIs without waiting
     /// to receive a DTS event on the BSP.)
     ///
-    for (Index = 0; Index < gSmst->NumberOfCpus; Index++) {
-      if (Index == gSmst->CurrentlyExecutingCpu) continue;
-      RunOnSpecificLogicalProcessor (DigitalThermalSensorEnableSmi, Index, NULL);
-    }
+    RunOnAllLogicalProcessors (DigitalThermalSensorEnableSmi, NULL);
     ///
     /// Check is this a DTS SMI event or the flag of update DTS temperature and threshold value in every SMI
     ///
     if (DigitalThermalSensorEventCheck (&EventType) || mUpdateDtsInEverySmi) {
+      EventHandled = TRUE;
       ///
       /// Disable Local APIC SMI before programming the threshold
       ///
@@ -338,42 +458,9 @@ DtsSmiCallback (
         mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature  = 0;
 
         ///
-        /// Set the BSP thermal sensor thresholds.
-        /// Note for DTS purpose BspDigitalThermalSensorTemperature is always Core 0.
-        /// However, SMM BSP could be any logical processor.
-        ///
-        RunOnSpecificLogicalProcessor (
-          DigitalThermalSensorSetThreshold,
-          0,
-          &mCpuNvsAreaPtr->BspDigitalThermalSensorTemperature
-          );
-
-        ///
-        /// Set the AP thermal sensor thresholds and update temperatures
+        /// Set the BSP and AP thermal sensor thresholds and update temperatures
         ///
-        if ((gSmst->NumberOfCpus / mThreadsPerCore) > 1) {
-          RunOnSpecificLogicalProcessor (
-            DigitalThermalSensorSetThreshold,
-            1 * mThreadsPerCore,
-            &mCpuNvsAreaPtr->ApDigitalThermalSensorTemperature
-            );
-        }
-
-        if ((gSmst->NumberOfCpus / mThreadsPerCore) > 2) {
-          RunOnSpecificLogicalProcessor (
-            DigitalThermalSensorSetThreshold,
-            2 * mThreadsPerCore,
-            &mCpuNvsAreaPtr->Ap2DigitalThermalSensorTemperature
-            );
-        }
-
-        if ((gSmst->NumberOfCpus / mThreadsPerCore) > 3) {
-          RunOnSpecificLogicalProcessor (
-            DigitalThermalSensorSetThreshold,
-            3 * mThreadsPerCore,
-            &mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature
-            );
-        }
+        DigitalThermalSensorSetCoreThreshold ();
 
         ///
         /// Set SWGPE Status to generate an SCI if we had any events
@@ -390,6 +477,8 @@ DtsSmiCallback (
     }
   }
 
+  DtsUpdateSmiStatistics (StartTime, StartWakeCount, EventHandled);
+
   return EFI_SUCCESS;
 }
 
@@ -442,6 +531,10 @@ DtsIoTrapCallback (
         mCpuNvsAreaPtr->PackageDTSTemperature               = 0;
 
         if (gIsPackageTempMsrAvailable) {
+          ///
+          /// Update temperatures for PTID
+          ///
+          DigitalThermalSensorUpdatePTID ();
           PackageDigitalThermalSensorSetThreshold (&mCpuNvsAreaPtr->PackageDTSTemperature);
         } else {
           ///
@@ -457,42 +550,9 @@ DtsIoTrapCallback (
           mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature  = 0;
 
           ///
-          /// Set the BSP thermal sensor thresholds.
-          /// Note for DTS purpose BspDigitalThermalSensorTemperature is always Core 0.
-          /// However, SMM BSP could be any logical processor.
-          ///
-          RunOnSpecificLogicalProcessor (
-            DigitalThermalSensorSetThreshold,
-            0,
-            &mCpuNvsAreaPtr->BspDigitalThermalSensorTemperature
-            );
-
+          /// Set the BSP and AP thermal sensor thresholds and update temperatures
           ///
-          /// Set the AP thermal sensor thresholds and update temperatures
-          ///
-          if ((gSmst->NumberOfCpus / mThreadsPerCore) > 1) {
-            RunOnSpecificLogicalProcessor (
-              DigitalThermalSensorSetThreshold,
-              1 * mThreadsPerCore,
-              &mCpuNvsAreaPtr->ApDigitalThermalSensorTemperature
-              );
-          }
-
-          if ((gSmst->NumberOfCpus / mThreadsPerCore) > 2) {
-            RunOnSpecificLogicalProcessor (
-              DigitalThermalSensorSetThreshold,
-              2 * mThreadsPerCore,
-              &mCpuNvsAreaPtr->Ap2DigitalThermalSensorTemperature
-              );
-          }
-
-          if ((gSmst->NumberOfCpus / mThreadsPerCore) > 3) {
-            RunOnSpecificLogicalProcessor (
-              DigitalThermalSensorSetThreshold,
-              3 * mThreadsPerCore,
-              &mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature
-              );
-          }
+          DigitalThermalSensorSetCoreThreshold ();
         }
         ///
         /// Re-enable the DTS.
@@ -583,6 +643,8 @@ InitThresholdTable (
 {
   UINTN i;
   UINT8 Delta;
+  UINTN Temperature;
+  UINT8 ThresholdEntry;
 
   ///
   /// If the table must be updated, shift the thresholds by the difference between
@@ -600,6 +662,18 @@ InitThresholdTable (
     }
   }
 
+  ///
+  /// Resolve the threshold table entry of every possible temperature once, so
+  /// the SMI handlers do not walk the table on each event.
+  ///
+  for (Temperature = 0; Temperature <= MAX_UINT8; Temperature++) {
+    ThresholdEntry = 0;
+    while ((Temperature > mDtsThresholdTable[ThresholdEntry][0]) && (ThresholdEntry < (mNoOfThresholdRanges - 1))) {
+      ThresholdEntry++;
+    }
+    mDtsThresholdIndex[Temperature] = ThresholdEntry;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -631,6 +705,10 @@ InitDigitalThermalSensor (
     mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature  = 0;
     mCpuNvsAreaPtr->PackageDTSTemperature               = 0;
     if (gIsPackageTempMsrAvailable) {
+      ///
+      /// Update temperatures for PTID
+      ///
+      DigitalThermalSensorUpdatePTID ();
       PackageDigitalThermalSensorSetThreshold (&mCpuNvsAreaPtr->PackageDTSTemperature);
     } else {
       ///
@@ -646,42 +724,9 @@ InitDigitalThermalSensor (
       mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature  = 0;
 
       ///
-      /// Set the BSP thermal sensor thresholds.
-      /// Note for DTS purpose BspDigitalThermalSensorTemperature is always Core 0.
-      /// However, SMM BSP could be any logical processor.
-      ///
-      RunOnSpecificLogicalProcessor (
-        DigitalThermalSensorSetThreshold,
-        0,
-        &mCpuNvsAreaPtr->BspDigitalThermalSensorTemperature
-        );
-
+      /// Set the BSP and AP thermal sensor thresholds and update temperatures
       ///
-      /// Set the AP thermal sensor thresholds and update temperatures
-      ///
-      if ((gSmst->NumberOfCpus / mThreadsPerCore) > 1) {
-        RunOnSpecificLogicalProcessor (
-          DigitalThermalSensorSetThreshold,
-          1 * mThreadsPerCore,
-          &mCpuNvsAreaPtr->ApDigitalThermalSensorTemperature
-          );
-      }
-
-      if ((gSmst->NumberOfCpus / mThreadsPerCore) > 2) {
-        RunOnSpecificLogicalProcessor (
-          DigitalThermalSensorSetThreshold,
-          2 * mThreadsPerCore,
-          &mCpuNvsAreaPtr->Ap2DigitalThermalSensorTemperature
-          );
-      }
-
-      if ((gSmst->NumberOfCpus / mThreadsPerCore) > 3) {
-        RunOnSpecificLogicalProcessor (
-          DigitalThermalSensorSetThreshold,
-          3 * mThreadsPerCore,
-          &mCpuNvsAreaPtr->Ap3DigitalThermalSensorTemperature
-          );
-      }
+      DigitalThermalSensorSetCoreThreshold ();
     }
 
     mCpuNvsAreaPtr->EnableDigitalThermalSensor = CPU_FEATURE_ENABLE;
@@ -841,7 +886,10 @@ DigitalThermalSensorEventCheck (
   ///
   *EventType = DtsEventNone;
 
-  RunOnAllLogicalProcessors (DigitalThermalSensorEventCheckMsr, EventType);
+  ///
+  /// IA32_THERM_STATUS is core scoped, so one thread per core is sampled.
+  ///
+  RunOnLogicalProcessorList (DigitalThermalSensorEventCheckMsr, mDtsCoreCpu, mDtsNumberOfCores, NULL, EventType);
   ///
   /// Return TRUE if any logical processor reported an event.
   ///
@@ -852,9 +900,33 @@ DigitalThermalSensorEventCheck (
   return FALSE;
 }
 
+/**
+  Return the list of logical processors used to access package scoped MSRs,
+  one per package. The current processor is used for its own package.
+
+  @retval Pointer to mDtsNumberOfPackages logical processor indexes.
+**/
+UINTN *
+DtsGetPackageCpuList (
+  VOID
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < mDtsNumberOfPackages; Index++) {
+    mDtsPackageCpuList[Index] = mDtsPackageCpu[Index];
+  }
+  mDtsPackageCpuList[mDtsCpuPackage[gSmst->CurrentlyExecutingCpu]] = gSmst->CurrentlyExecutingCpu;
+
+  return mDtsPackageCpuList;
+}
+
 /**
   Checks for a Package Thermal Event by reading MSR.
 
+  IA32_PACKAGE_THERM_STATUS is read once per package. On a single package
+  system no AP is woken up.
+
   @param[in] PkgEventType - DTS_EVENT_TYPE to indicate which DTS event type has been detected.
 
   @retval TRUE means this is a Package DTS Thermal event
@@ -865,15 +937,49 @@ DigitalThermalSensorEventCheckPackageMsr (
   DTS_EVENT_TYPE *PkgEventType
   )
 {
-  MSR_REGISTER MsrData;
-
   ///
   /// Clear event status
   ///
   *PkgEventType = DtsEventNone;
 
+  RunOnLogicalProcessorList (
+    PackageDigitalThermalSensorEventCheckMsr,
+    DtsGetPackageCpuList (),
+    mDtsNumberOfPackages,
+    NULL,
+    PkgEventType
+    );
+  ///
+  /// Return TRUE if processor reported an event.
+  ///
+  if (*PkgEventType != DtsEventNone) {
+    return TRUE;
+  }
+
+  return FALSE;
+
+}
+
+/**
+  Checks for a Package Thermal Event by reading the package MSR.
+
+  This function must be MP safe.
+
+  @param[in] Buffer    Pointer to DTS_EVENT_TYPE
+**/
+VOID
+EFIAPI
+PackageDigitalThermalSensorEventCheckMsr (
+  IN VOID *Buffer
+  )
+{
+  MSR_REGISTER   MsrData;
+  DTS_EVENT_TYPE *PkgEventType;
+
+  PkgEventType = (DTS_EVENT_TYPE *) Buffer;
+
   ///
-  /// If Processor has already been flagged as Out-Of-Spec,
+  /// If any package has already been flagged as Out-Of-Spec,
   /// just return.
   ///
   if (*PkgEventType != DtsEventOutOfSpec) {
@@ -897,15 +1003,6 @@ DigitalThermalSensorEventCheckPackageMsr (
       *PkgEventType = DtsEventThreshold;
     }
   }
-  ///
-  /// Return TRUE if processor reported an event.
-  ///
-  if (*PkgEventType != DtsEventNone) {
-    return TRUE;
-  }
-
-  return FALSE;
-
 }
 
 /**
@@ -1008,6 +1105,58 @@ PackageDigitalThermalSensorSetOutOfSpecInterrupt (
 
 }
 
+/**
+  Build the thermal interrupt MSR value for the given temperature.
+
+  @param[in] Temperature      Current temperature.
+  @param[in] ThermInterrupt   Current thermal interrupt MSR value.
+
+  @retval Thermal interrupt MSR value with the thresholds of Temperature.
+**/
+UINT64
+DigitalThermalSensorGetThreshold (
+  IN UINT8   Temperature,
+  IN UINT64  ThermInterrupt
+  )
+{
+  UINT8        ThresholdEntry;
+  MSR_REGISTER MsrData;
+
+  ///
+  /// Look up the Digital Thermal Sensor Threshold Table entry of the current temperature.
+  ///
+  ThresholdEntry = mDtsThresholdIndex[Temperature];
+  ///
+  /// Update the threshold values
+  ///
+  MsrData.Qword = ThermInterrupt;
+  ///
+  /// Low temp is threshold #2
+  ///
+  MsrData.Bytes.ThirdByte = mDtsThresholdTable[ThresholdEntry][1];
+  ///
+  /// High temp is threshold #1
+  ///
+  MsrData.Bytes.SecondByte = mDtsThresholdTable[ThresholdEntry][2];
+
+  ///
+  /// Enable interrupts
+  ///
+  MsrData.Qword |= (UINT64) TH1_ENABLE;
+  MsrData.Qword |= (UINT64) TH2_ENABLE;
+
+  ///
+  /// If the high temp is at TjMax (offset == 0)
+  /// We disable the int to avoid generating a large number of SMI because of TM1/TM2
+  /// causing many threshold crossings
+  ///
+  if (MsrData.Bytes.SecondByte == 0x80) {
+    MsrData.Qword &= (UINT64) ~TH1_ENABLE;
+  }
+
+  return MsrData.Qword;
+}
+
 /**
   Read the temperature and reconfigure the thresholds.
   This function must be AP safe.
@@ -1022,8 +1171,9 @@ DigitalThermalSensorSetThreshold (
   VOID *Buffer
   )
 {
-  UINT8        ThresholdEntry;
   MSR_REGISTER MsrData;
+  UINT64       ThermInterrupt;
+  UINT64       NewThermInterrupt;
   UINT8        Temperature;
 
   ///
@@ -1049,49 +1199,22 @@ DigitalThermalSensorSetThreshold (
       *((UINT8 *) Buffer) = Temperature;
     }
     ///
-    /// Compare the current temperature to the Digital Thermal Sensor Threshold Table until
-    /// a matching Value is found.
+    /// Only write the thresholds when they change.
     ///
-    ThresholdEntry = 0;
-    while ((Temperature > mDtsThresholdTable[ThresholdEntry][0]) && (ThresholdEntry < (mNoOfThresholdRanges - 1))) {
-      ThresholdEntry++;
+    ThermInterrupt    = AsmReadMsr64 (EFI_MSR_IA32_THERM_INTERRUPT);
+    NewThermInterrupt = DigitalThermalSensorGetThreshold (Temperature, ThermInterrupt);
+    if (NewThermInterrupt != ThermInterrupt) {
+      AsmWriteMsr64 (EFI_MSR_IA32_THERM_INTERRUPT, NewThermInterrupt);
     }
-    ///
-    /// Update the threshold values
-    ///
-    MsrData.Qword = AsmReadMsr64 (EFI_MSR_IA32_THERM_INTERRUPT);
-    ///
-    /// Low temp is threshold #2
-    ///
-    MsrData.Bytes.ThirdByte = mDtsThresholdTable[ThresholdEntry][1];
-    ///
-    /// High temp is threshold #1
-    ///
-    MsrData.Bytes.SecondByte = mDtsThresholdTable[ThresholdEntry][2];
-
-    ///
-    /// Enable interrupts
-    ///
-    MsrData.Qword |= (UINT64) TH1_ENABLE;
-    MsrData.Qword |= (UINT64) TH2_ENABLE;
-
-    ///
-    /// If the high temp is at TjMax (offset == 0)
-    /// We disable the int to avoid generating a large number of SMI because of TM1/TM2
-    /// causing many threshold crossings
-    ///
-    if (MsrData.Bytes.SecondByte == 0x80) {
-      MsrData.Qword &= (UINT64) ~TH1_ENABLE;
-    }
-
-    AsmWriteMsr64 (EFI_MSR_IA32_THERM_INTERRUPT, MsrData.Qword);
   }
   ///
   ///  Clear the threshold log bits
   ///
   MsrData.Qword = AsmReadMsr64 (MSR_IA32_THERM_STATUS);
-  MsrData.Qword &= (UINT64) ~THERM_STATUS_THRESHOLD_LOG_MASK;
-  AsmWriteMsr64 (MSR_IA32_THERM_STATUS, MsrData.Qword);
+  if ((MsrData.Qword & THERM_STATUS_THRESHOLD_LOG_MASK) != 0) {
+    MsrData.Qword &= (UINT64) ~THERM_STATUS_THRESHOLD_LOG_MASK;
+    AsmWriteMsr64 (MSR_IA32_THERM_STATUS, MsrData.Qword);
+  }
 
   return;
 }
@@ -1099,6 +1222,9 @@ DigitalThermalSensorSetThreshold (
 /**
   Read the temperature and reconfigure the thresholds on the package
 
+  The thresholds of all packages are reprogrammed together and the highest
+  package temperature is returned.
+
   @param[in] Buffer        Pointer to UINT8 to update with the current temperature
 
   @retval EFI_SUCCESS   Digital Thermal Sensor threshold programmed successfully
@@ -1108,8 +1234,44 @@ PackageDigitalThermalSensorSetThreshold (
   VOID *Buffer
   )
 {
-  UINT8        ThresholdEntry;
+  UINTN Index;
+
+  for (Index = 0; Index < mDtsNumberOfPackages; Index++) {
+    mDtsPackageTemp[Index] = *((UINT8 *) Buffer);
+  }
+
+  RunOnLogicalProcessorList (
+    PackageDigitalThermalSensorSetThresholdMsr,
+    DtsGetPackageCpuList (),
+    mDtsNumberOfPackages,
+    mDtsPackageTempBuffer,
+    NULL
+    );
+
+  for (Index = 0; Index < mDtsNumberOfPackages; Index++) {
+    if (mDtsPackageTemp[Index] > *((UINT8 *) Buffer)) {
+      *((UINT8 *) Buffer) = mDtsPackageTemp[Index];
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read the package temperature and reconfigure the package thresholds.
+  This function must be AP safe.
+
+  @param[in] Buffer        Pointer to UINT8 to update with the current temperature
+**/
+VOID
+EFIAPI
+PackageDigitalThermalSensorSetThresholdMsr (
+  VOID *Buffer
+  )
+{
   MSR_REGISTER MsrData;
+  UINT64       ThermInterrupt;
+  UINT64       NewThermInterrupt;
   UINT8        Temperature;
 
   ///
@@ -1122,13 +1284,8 @@ PackageDigitalThermalSensorSetThreshold (
   ///
   if (MsrData.Qword & B_OUT_OF_SPEC_STATUS) {
     *((UINT8 *) Buffer) = DTS_CRITICAL_TEMPERATURE;
-    return EFI_SUCCESS;
+    return;
   } else if (MsrData.Qword & B_READING_VALID) {
-    ///
-    /// Update temperatures for PTID
-    ///
-    DigitalThermalSensorUpdatePTID ();
-
     ///
     /// Find the DTS temperature.
     ///
@@ -1140,51 +1297,22 @@ PackageDigitalThermalSensorSetThreshold (
       *((UINT8 *) Buffer) = Temperature;
     }
     ///
-    /// Compare the current temperature to the Digital Thermal Sensor Threshold Table until
-    /// a matching Value is found.
-    ///
-    ThresholdEntry = 0;
-    while ((Temperature > mDtsThresholdTable[ThresholdEntry][0]) && (ThresholdEntry < (mNoOfThresholdRanges - 1))) {
-      ThresholdEntry++;
-    }
-    ///
-    /// Update the threshold values
-    ///
-    MsrData.Qword = AsmReadMsr64 (EFI_MSR_IA32_PACKAGE_THERM_INTERRUPT);
-    ///
-    /// Low temp is threshold #2
-    ///
-    MsrData.Bytes.ThirdByte = mDtsThresholdTable[ThresholdEntry][1];
-    ///
-    /// High temp is threshold #1
-    ///
-    MsrData.Bytes.SecondByte = mDtsThresholdTable[ThresholdEntry][2];
-
-    ///
-    /// Enable interrupts
-    ///
-    MsrData.Qword |= (UINT64) TH1_ENABLE;
-    MsrData.Qword |= (UINT64) TH2_ENABLE;
-
-    ///
-    /// If the high temp is at TjMax (offset == 0)
-    /// We disable the int to avoid generating a large number of SMI because of TM1/TM2
-    /// causing many threshold crossings
+    /// Only write the thresholds when they change.
     ///
-    if (MsrData.Bytes.SecondByte == 0x80) {
-      MsrData.Qword &= (UINT64) ~TH1_ENABLE;
+    ThermInterrupt    = AsmReadMsr64 (EFI_MSR_IA32_PACKAGE_THERM_INTERRUPT);
+    NewThermInterrupt = DigitalThermalSensorGetThreshold (Temperature, ThermInterrupt);
+    if (NewThermInterrupt != ThermInterrupt) {
+      AsmWriteMsr64 (EFI_MSR_IA32_PACKAGE_THERM_INTERRUPT, NewThermInterrupt);
     }
-
-    AsmWriteMsr64 (EFI_MSR_IA32_PACKAGE_THERM_INTERRUPT, MsrData.Qword);
   }
   ///
   ///  Clear the threshold log bits
   ///
   MsrData.Qword = AsmReadMsr64 (EFI_MSR_IA32_PACKAGE_THERM_STATUS);
-  MsrData.Qword &= (UINT64) ~THERM_STATUS_THRESHOLD_LOG_MASK;
-  AsmWriteMsr64 (EFI_MSR_IA32_PACKAGE_THERM_STATUS, MsrData.Qword);
-
-  return EFI_SUCCESS;
+  if ((MsrData.Qword & THERM_STATUS_THRESHOLD_LOG_MASK) != 0) {
+    MsrData.Qword &= (UINT64) ~THERM_STATUS_THRESHOLD_LOG_MASK;
+    AsmWriteMsr64 (EFI_MSR_IA32_PACKAGE_THERM_STATUS, MsrData.Qword);
+  }
 }
 
 /**
@@ -1325,7 +1453,10 @@ InstallDigitalThermalSensor (
   NumCores = (UINT16) (MsrData.Dwords.Low >> N_CORE_COUNT_OFFSET);
   mThreadsPerCore = (UINT8) (NumThreads / NumCores);
 
-  mCoreTemp = AllocatePool (sizeof (UINT8) * gSmst->NumberOfCpus / mThreadsPerCore);
+  Status = DtsInitCpuTopology ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
   ///
   /// Locate Cpu Nvs area
@@ -1437,6 +1568,8 @@ typedef struct {
   VOID             *Buffer;
 } PROCEDURE_WRAPPER_DATA;
 
+PROCEDURE_WRAPPER_DATA *mProcedureWrapperData = NULL; // One entry per logical processor for RunOnLogicalProcessorList.
+
 
 /**
   Wrapper used to track number of APs completed, so BSP can wait before continuing.
@@ -1491,6 +1624,7 @@ RunOnSpecificLogicalProcessor (
       mProcedureWrapperCount = 0;
       return Status;
     }
+    mDtsThreadWakeCount++;
 
     while (mProcedureWrapperCount > 0);  //Wait for AP
   }
@@ -1536,6 +1670,8 @@ RunOnAllLogicalProcessors (
       if (ApStatus != EFI_SUCCESS) {
         InterlockedDecrement (&mProcedureWrapperCount); // Error, so wrapper function didn't decrement.
         Status = ApStatus;  // Report error if 1 AP reported error.
+      } else {
+        mDtsThreadWakeCount++;
       }
     }
   }
@@ -1545,3 +1681,152 @@ RunOnAllLogicalProcessors (
   return Status;
 }
 
+/**
+  Runs the specified procedure on a list of logical processors. All APs in the
+  list are started before the procedure runs on the current processor, and the
+  caller waits once for all of them.
+
+  @param[in] Procedure     The function to be run.
+  @param[in] CpuList       Logical processor indexes to run the procedure on.
+  @param[in] CpuCount      Number of entries in CpuList.
+  @param[in] BufferList    Per-processor parameter buffers. If NULL, Buffer is passed to all.
+  @param[in] Buffer        Pointer to a parameter buffer shared by all processors.
+
+  @retval EFI_SUCCESS   Function executed successfully.
+**/
+STATIC
+EFI_STATUS
+RunOnLogicalProcessorList (
+  IN EFI_AP_PROCEDURE     Procedure,
+  IN UINTN                *CpuList,
+  IN UINTN                CpuCount,
+  IN VOID                 **BufferList, OPTIONAL
+  IN OUT VOID             *Buffer       OPTIONAL
+  )
+{
+  UINTN      Index;
+  UINTN      BspIndex;
+  EFI_STATUS Status = EFI_SUCCESS;
+  EFI_STATUS ApStatus;
+
+  BspIndex = CpuCount;
+  mProcedureWrapperCount = 0;
+
+  ///
+  /// Start the APs first so they run in parallel with the BSP.
+  ///
+  for (Index = 0; Index < CpuCount; Index++) {
+    mProcedureWrapperData[Index].Procedure = Procedure;
+    mProcedureWrapperData[Index].Buffer    = (BufferList != NULL) ? BufferList[Index] : Buffer;
+    if (CpuList[Index] == gSmst->CurrentlyExecutingCpu) {
+      BspIndex = Index;
+      continue;
+    }
+
+    InterlockedIncrement (&mProcedureWrapperCount);
+    ApStatus = gSmst->SmmStartupThisAp (ProcedureWrapper, CpuList[Index], &mProcedureWrapperData[Index]);
+    ASSERT_EFI_ERROR (ApStatus);
+
+    if (ApStatus != EFI_SUCCESS) {
+      InterlockedDecrement (&mProcedureWrapperCount); // Error, so wrapper function didn't decrement.
+      Status = ApStatus;  // Report error if 1 AP reported error.
+    } else {
+      mDtsThreadWakeCount++;
+    }
+  }
+
+  if (BspIndex < CpuCount) {
+    (*Procedure) (mProcedureWrapperData[BspIndex].Buffer);  // Run the procedure on BSP.
+  }
+
+  while (mProcedureWrapperCount > 0);  //Wait for APs
+
+  return Status;
+}
+
+/**
+  Collect the package and core layout of the logical processors so that
+  package and core scoped MSRs are only accessed from one thread each.
+
+  @retval EFI_SUCCESS            Layout collected.
+  @retval EFI_OUT_OF_RESOURCES   Error when allocating required memory buffer.
+**/
+EFI_STATUS
+DtsInitCpuTopology (
+  VOID
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpService;
+  EFI_PROCESSOR_INFORMATION ProcessorInfo;
+  UINTN                     NumberOfCpus;
+  UINTN                     Index;
+  UINTN                     Package;
+  UINT32                    *PackageId;
+
+  NumberOfCpus           = gSmst->NumberOfCpus;
+  mCoreTemp              = AllocateZeroPool (NumberOfCpus * sizeof (UINT8));
+  mDtsCoreCpu            = AllocateZeroPool (NumberOfCpus * sizeof (UINTN));
+  mDtsCoreTempBuffer     = AllocateZeroPool (NumberOfCpus * sizeof (VOID *));
+  mDtsPackageCpu         = AllocateZeroPool (NumberOfCpus * sizeof (UINTN));
+  mDtsCpuPackage         = AllocateZeroPool (NumberOfCpus * sizeof (UINTN));
+  mDtsPackageCpuList     = AllocateZeroPool (NumberOfCpus * sizeof (UINTN));
+  mDtsPackageTemp        = AllocateZeroPool (NumberOfCpus * sizeof (UINT8));
+  mDtsPackageTempBuffer  = AllocateZeroPool (NumberOfCpus * sizeof (VOID *));
+  mProcedureWrapperData  = AllocateZeroPool (NumberOfCpus * sizeof (PROCEDURE_WRAPPER_DATA));
+  PackageId              = AllocateZeroPool (NumberOfCpus * sizeof (UINT32));
+  if ((mCoreTemp == NULL) || (mDtsCoreCpu == NULL) || (mDtsCoreTempBuffer == NULL) ||
+      (mDtsPackageCpu == NULL) || (mDtsCpuPackage == NULL) || (mDtsPackageCpuList == NULL) ||
+      (mDtsPackageTemp == NULL) || (mDtsPackageTempBuffer == NULL) ||
+      (mProcedureWrapperData == NULL) || (PackageId == NULL)) {
+    ASSERT (FALSE);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ///
+  /// SMM CPU indexes match the MP services processor numbers.
+  ///
+  Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **) &MpService);
+  if (EFI_ERROR (Status)) {
+    MpService = NULL;
+  }
+
+  for (Index = 0; Index < NumberOfCpus; Index++) {
+    Status = EFI_NOT_FOUND;
+    if (MpService != NULL) {
+      Status = MpService->GetProcessorInfo (MpService, Index, &ProcessorInfo);
+    }
+    if (EFI_ERROR (Status)) {
+      ///
+      /// Assume a single package with mThreadsPerCore threads per core.
+      ///
+      ProcessorInfo.Location.Package = 0;
+      ProcessorInfo.Location.Thread  = (UINT32) (Index % mThreadsPerCore);
+    }
+
+    if (ProcessorInfo.Location.Thread == 0) {
+      mDtsCoreCpu[mDtsNumberOfCores]        = Index;
+      mDtsCoreTempBuffer[mDtsNumberOfCores] = &mCoreTemp[mDtsNumberOfCores];
+      mDtsNumberOfCores++;
+    }
+
+    for (Package = 0; Package < mDtsNumberOfPackages; Package++) {
+      if (PackageId[Package] == ProcessorInfo.Location.Package) {
+        break;
+      }
+    }
+    if (Package == mDtsNumberOfPackages) {
+      PackageId[Package]              = ProcessorInfo.Location.Package;
+      mDtsPackageCpu[Package]         = Index;
+      mDtsPackageTempBuffer[Package]  = &mDtsPackageTemp[Package];
+      mDtsNumberOfPackages++;
+    }
+    mDtsCpuPackage[Index] = Package;
+  }
+  FreePool (PackageId);
+
+  DEBUG ((DEBUG_INFO, "DTS: %d packages, %d cores\n", mDtsNumberOfPackages, mDtsNumberOfCores));
+
+  return EFI_SUCCESS;
+}
+
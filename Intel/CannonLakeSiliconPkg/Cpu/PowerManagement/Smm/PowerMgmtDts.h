@@ -40,6 +40,7 @@
 //
 #include <Protocol/SmmSxDispatch2.h>
 #include <Protocol/SmmIoTrapDispatch2.h>
+#include <Protocol/MpService.h>
 #include <CpuDataStruct.h>
 #include <Protocol/CpuNvsArea.h>
 #include <Private/CpuInitDataHob.h>
@@ -116,6 +117,21 @@ typedef enum {
   DtsEventMax
 } DTS_EVENT_TYPE;
 
+///
+/// DTS SMI statistics. Residency is in nanoseconds; thread wakes count the
+/// APs started through SmmStartupThisAp while handling the SMI.
+///
+typedef struct {
+  UINT32 SmiCount;              ///< DTS SMI handler invocations while DTS is enabled
+  UINT32 EventCount;            ///< Invocations that reprogrammed the thresholds
+  UINT32 FastPathCount;         ///< Invocations handled without waking any AP
+  UINT32 LastThreadWakeCount;
+  UINT64 TotalThreadWakeCount;
+  UINT64 LastResidency;
+  UINT64 MaxResidency;
+  UINT64 TotalResidency;
+} DTS_SMI_STATISTICS;
+
 //
 // Function declarations
 //
@@ -137,6 +153,41 @@ RunOnSpecificLogicalProcessor (
   IN OUT VOID             *Buffer
   );
 
+/**
+  Runs the specified procedure on a list of logical processors. All APs in the
+  list are started before the procedure runs on the current processor, and the
+  caller waits once for all of them.
+
+  @param[in] Procedure     The function to be run.
+  @param[in] CpuList       Logical processor indexes to run the procedure on.
+  @param[in] CpuCount      Number of entries in CpuList.
+  @param[in] BufferList    Per-processor parameter buffers. If NULL, Buffer is passed to all.
+  @param[in] Buffer        Pointer to a parameter buffer shared by all processors.
+
+  @retval EFI_SUCCESS   Function executed successfully.
+**/
+STATIC
+EFI_STATUS
+RunOnLogicalProcessorList (
+  IN EFI_AP_PROCEDURE     Procedure,
+  IN UINTN                *CpuList,
+  IN UINTN                CpuCount,
+  IN VOID                 **BufferList, OPTIONAL
+  IN OUT VOID             *Buffer       OPTIONAL
+  );
+
+/**
+  Collect the package and core layout of the logical processors so that
+  package and core scoped MSRs are only accessed from one thread each.
+
+  @retval EFI_SUCCESS            Layout collected.
+  @retval EFI_OUT_OF_RESOURCES   Error when allocating required memory buffer.
+**/
+EFI_STATUS
+DtsInitCpuTopology (
+  VOID
+  );
+
 /**
   SMI handler to handle Digital Thermal Sensor CPU Local APIC SMI
   for thermal threshold interrupt
@@ -160,13 +211,22 @@ DtsSmiCallback (
   Call from SMI handler to handle Package thermal temperature Digital Thermal Sensor CPU Local APIC SMI
   for thermal threshold interrupt
 
-  @retval None
+  @retval TRUE     The thresholds were reprogrammed.
+  @retval FALSE    No package event was pending.
 **/
-VOID
+BOOLEAN
 PackageThermalDTS (
   VOID
   );
 
+/**
+  Reprogram the thresholds of the cores reported through the CPU NVS area.
+**/
+VOID
+DigitalThermalSensorSetCoreThreshold (
+  VOID
+  );
+
 /**
   Perform first time initialization of the Digital Thermal Sensor
 
@@ -225,6 +285,19 @@ DigitalThermalSensorEventCheckMsr (
   IN VOID *Buffer
   );
 
+/**
+  Checks for a Package Thermal Event by reading the package MSR.
+
+  This function must be MP safe.
+
+  @param[in] Buffer    Pointer to DTS_EVENT_TYPE
+**/
+VOID
+EFIAPI
+PackageDigitalThermalSensorEventCheckMsr (
+  IN VOID *Buffer
+  );
+
 /**
   Checks for a Package Thermal Event by reading MSR.
 
@@ -277,6 +350,18 @@ PackageDigitalThermalSensorSetThreshold (
   VOID *Buffer
   );
 
+/**
+  Read the package temperature and reconfigure the package thresholds.
+  This function must be AP safe.
+
+  @param[in] Buffer        Pointer to UINT8 to update with the current temperature
+**/
+VOID
+EFIAPI
+PackageDigitalThermalSensorSetThresholdMsr (
+  VOID *Buffer
+  );
+
 /**
   Set the Out Of Spec Interrupt in all cores
   This function must be AP safe.
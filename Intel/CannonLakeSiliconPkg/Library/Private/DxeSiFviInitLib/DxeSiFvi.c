@@ -41,6 +41,7 @@
 #include <Library/DebugLib.h>
 #include <Library/PciSegmentLib.h>
 #include <Library/S3BootScriptLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Protocol/PciIo.h>
 #include <Protocol/Smbios.h>
@@ -54,8 +55,6 @@
 #include <SiFvi.h>
 #include <SaAccess.h>
 #include <SiConfigHob.h>
-#include <PchInfoHob.h>
-#include <Private/PchConfigHob.h>
 #include <Private/Library/PmcPrivateLib.h>
 #include <IndustryStandard/FirmwareVersionInfo.h>
 
@@ -71,6 +70,10 @@ typedef struct {
 
 #pragma pack(pop)
 
+#define FVI_UPDATE_ME                   BIT0
+#define FVI_UPDATE_PCH                  BIT1
+#define FVI_UPDATE_SA                   BIT2
+
 /**
   Create and update PCH related FVI Records.
 
@@ -143,8 +146,10 @@ CreateAndUpdatePchFviRecords (
         PchFviData[RAID_VER].Version.Revision     = 0;
         PchFviData[RAID_VER].Version.BuildNumber  = 0;
         FoundLegacyRaid = TRUE;
+        break;
       }
     }
+    FreePool (HandleBuffer);
   }
   //
   // Search EFI RST OPROM
@@ -180,12 +185,17 @@ CreateAndUpdatePchFviRecords (
                           &gEfiDriverSupportedEfiVersionProtocolGuid,
                           (VOID **) &DriverEfiVersion
                           );
+          if (EFI_ERROR (Status)) {
+            continue;
+          }
           PchFviData[RAID_VER].Version.MajorVersion = (UINT8) ((DriverEfiVersion->FirmwareVersion & 0x00FF0000) >> 16);
           PchFviData[RAID_VER].Version.MinorVersion = (UINT8)  (DriverEfiVersion->FirmwareVersion & 0x000000FF);
           PchFviData[RAID_VER].Version.Revision     = 0;
           PchFviData[RAID_VER].Version.BuildNumber  = 0;
+          break;
         }
       }
+      FreePool (HandleBuffer);
     }
   }
 }
@@ -216,57 +226,26 @@ UpdateMeFvi (
 }
 
 /**
-  Update PCH Smbios FVI data
+  Update PCH Smbios FVI data.
+  CRID values and status string are already resolved by the PEI FVI HOB, so only
+  the CRID register programming and the RAID OPROM version are left for DXE.
 
   @param[in] PchFviData           A pointer to the INTEL_FIRMWARE_VERSION_INFO
-  @param[in, out] PchFviStrings   A pointer to the FVI Strings information
 **/
 VOID
 UpdatePchFvi (
-  IN INTEL_FIRMWARE_VERSION_INFO *PchFviData,
-  IN OUT CHAR8                   **PchFviStrings
+  IN INTEL_FIRMWARE_VERSION_INFO *PchFviData
   )
 {
-  STATIC CONST UINT8              StrEnabled[sizeof (PCH_CRID_ENABLED)] = PCH_CRID_ENABLED;
-  STATIC CONST UINT8              StrDisabled[sizeof (PCH_CRID_DISABLED)] = PCH_CRID_DISABLED;
-  UINT8                           Index;
-  EFI_PEI_HOB_POINTERS            HobPtr;
-  PCH_CONFIG_HOB                  *PchConfigHob;
-  PCH_INFO_HOB                    *PchInfoHob;
-
   //
   // Do Crid programming as late as possible so others can get the ture PCH stepping.
   //
-  HobPtr.Guid = GetFirstGuidHob (&gPchConfigHobGuid);
-  ASSERT (HobPtr.Guid != NULL);
-  PchConfigHob = (PCH_CONFIG_HOB *) GET_GUID_HOB_DATA (HobPtr.Guid);
-
-  HobPtr.Guid = GetFirstGuidHob (&gPchInfoHobGuid);
-  ASSERT (HobPtr.Guid != NULL);
-  PchInfoHob = (PCH_INFO_HOB *) GET_GUID_HOB_DATA (HobPtr.Guid);
-
-  PchFviData[PCH_CRID_ORIGINAL].Version.BuildNumber = (UINT16) PchInfoHob->CridOrgRid;
-  if (PchInfoHob->CridSupport && PchConfigHob->General.Crid) {
-    PmcSetCrid0WithS3BootScript ();
-    PchFviData[PCH_CRID_NEW].Version.BuildNumber = (UINT16) PchInfoHob->CridNewRid;
-  } else {
-    PchFviData[PCH_CRID_NEW].Version.BuildNumber = (UINT16) PchInfoHob->CridOrgRid;
-  }
-  PmcLockCridWithS3BootScript ();
-
-  //
-  // Search the position of VersionString for PCH_CRID_STATUS
-  //
-  for (Index = 1; Index < PchFviData[PCH_CRID_STATUS].VersionString; Index++) {
-    *PchFviStrings += AsciiStrSize ((CHAR8 *) *PchFviStrings);
-  }
   if (PchFviData[PCH_CRID_ORIGINAL].Version.BuildNumber != PchFviData[PCH_CRID_NEW].Version.BuildNumber) {
     DEBUG ((DEBUG_INFO, "PCH_CRID_NEW.BuildNumber = %x\n", PchFviData[PCH_CRID_NEW].Version.BuildNumber));
     DEBUG ((DEBUG_INFO, "PCH_CRID_ORIGINAL.BuildNumber = %x\n", PchFviData[PCH_CRID_ORIGINAL].Version.BuildNumber));
-    AsciiStrnCpyS (*PchFviStrings, SMBIOS_STRING_MAX_LENGTH, (CHAR8 *) &StrEnabled, sizeof (StrEnabled));
-  } else {
-    AsciiStrnCpyS (*PchFviStrings, SMBIOS_STRING_MAX_LENGTH, (CHAR8 *) &StrDisabled, sizeof (StrDisabled));
+    PmcSetCrid0WithS3BootScript ();
   }
+  PmcLockCridWithS3BootScript ();
 
   CreateAndUpdatePchFviRecords (PchFviData);
 }
@@ -349,6 +328,7 @@ UpdateFviInfo (
   EFI_SMBIOS_TABLE_HEADER     *Record;
   INTEL_FIRMWARE_VERSION_INFO *FviData;
   FIRMWARE_VERSION_STRINGS    *FviString;
+  UINT8                       Pending;
 
   DEBUG ((DEBUG_INFO, "UpdateFviInfo(): Update SMBIOS FVI OEM Type.\n"));
 
@@ -359,6 +339,11 @@ UpdateFviInfo (
   }
 
   SmbiosHandle = SMBIOS_HANDLE_PI_RESERVED;
+  //
+  // The FVI records were installed together from the PEI FVI HOBs, so stop
+  // walking the SMBIOS table once the ME, PCH and SA records have been seen.
+  //
+  Pending = FVI_UPDATE_ME | FVI_UPDATE_PCH | FVI_UPDATE_SA;
 
   do {
     Status = Smbios->GetNext (Smbios, &SmbiosHandle, NULL, &Record, NULL);
@@ -370,18 +355,22 @@ UpdateFviInfo (
       FviData   = (INTEL_FIRMWARE_VERSION_INFO *)((UINT8 *)Record + sizeof (EFI_SMBIOS_TABLE_HEADER) + sizeof (UINT8));
       FviString = (FIRMWARE_VERSION_STRINGS *)((UINT8 *)Record + Record->Length);
 
-      if (AsciiStrnCmp ((CHAR8 *) &FviString->ComponentName, ME_FVI_STRING, AsciiStrLen (ME_FVI_STRING)) == 0) {
+      if (((Pending & FVI_UPDATE_ME) != 0) &&
+          (AsciiStrnCmp ((CHAR8 *) &FviString->ComponentName, ME_FVI_STRING, AsciiStrLen (ME_FVI_STRING)) == 0)) {
         UpdateMeFvi(FviData);
-      }
-      if (AsciiStrnCmp ((CHAR8 *) &FviString->ComponentName, PCH_FVI_STRING, AsciiStrLen (PCH_FVI_STRING)) == 0) {
-        UpdatePchFvi(FviData, (CHAR8 **) &FviString);
-      }
-      if (AsciiStrnCmp ((CHAR8 *) &FviString->ComponentName, SA_FVI_STRING, AsciiStrLen (SA_FVI_STRING)) == 0) {
+        Pending &= (UINT8) ~FVI_UPDATE_ME;
+      } else if (((Pending & FVI_UPDATE_PCH) != 0) &&
+                 (AsciiStrnCmp ((CHAR8 *) &FviString->ComponentName, PCH_FVI_STRING, AsciiStrLen (PCH_FVI_STRING)) == 0)) {
+        UpdatePchFvi(FviData);
+        Pending &= (UINT8) ~FVI_UPDATE_PCH;
+      } else if (((Pending & FVI_UPDATE_SA) != 0) &&
+                 (AsciiStrnCmp ((CHAR8 *) &FviString->ComponentName, SA_FVI_STRING, AsciiStrLen (SA_FVI_STRING)) == 0)) {
         UpdateSaFvi(FviData);
+        Pending &= (UINT8) ~FVI_UPDATE_SA;
       }
 
     }
-  } while (Status == EFI_SUCCESS);
+  } while ((Status == EFI_SUCCESS) && (Pending != 0));
 
   return EFI_SUCCESS;
 }
@@ -47,6 +47,8 @@
 #include <Library/MemoryAllocationLib.h>
 #include <MeBiosPayloadHob.h>
 #include <Private/PchHsio.h>
+#include <PchInfoHob.h>
+#include <Private/PchConfigHob.h>
 #include <MemInfoHob.h>
 #include <Private/SaConfigHob.h>
 #include <IndustryStandard/FirmwareVersionInfo.h>
@@ -317,7 +319,9 @@ BuildMeFviHob (
 }
 
 /**
-  This function builds the PCH FVI Hob
+  This function builds the PCH FVI Hob.
+  CRID values are known once PchInfoHob and PchConfigHob exist, so they are
+  resolved here and DXE only has to program the CRID registers.
 
   @retval EFI_SUCCESS          - Successfully built the Hob
 **/
@@ -326,6 +330,35 @@ BuildPchFviHob (
   VOID
   )
 {
+  STATIC CONST CHAR8              StrEnabled[sizeof (PCH_CRID_ENABLED)] = PCH_CRID_ENABLED;
+  EFI_HOB_GUID_TYPE               *GuidHob;
+  PCH_INFO_HOB                    *PchInfoHob;
+  PCH_CONFIG_HOB                  *PchConfigHob;
+
+  PchInfoHob   = NULL;
+  PchConfigHob = NULL;
+  GuidHob = GetFirstGuidHob (&gPchInfoHobGuid);
+  if (GuidHob != NULL) {
+    PchInfoHob = (PCH_INFO_HOB *) GET_GUID_HOB_DATA (GuidHob);
+  }
+  GuidHob = GetFirstGuidHob (&gPchConfigHobGuid);
+  if (GuidHob != NULL) {
+    PchConfigHob = (PCH_CONFIG_HOB *) GET_GUID_HOB_DATA (GuidHob);
+  }
+
+  if (PchInfoHob != NULL) {
+    mPchFviData[PCH_CRID_ORIGINAL].Version.BuildNumber = (UINT16) PchInfoHob->CridOrgRid;
+    mPchFviData[PCH_CRID_NEW].Version.BuildNumber      = (UINT16) PchInfoHob->CridOrgRid;
+    if ((PchConfigHob != NULL) && PchInfoHob->CridSupport && PchConfigHob->General.Crid) {
+      mPchFviData[PCH_CRID_NEW].Version.BuildNumber = (UINT16) PchInfoHob->CridNewRid;
+    }
+    if (mPchFviData[PCH_CRID_ORIGINAL].Version.BuildNumber != mPchFviData[PCH_CRID_NEW].Version.BuildNumber) {
+      mPchFviStrings[PCH_CRID_STATUS].VersionString = (CHAR8 *) StrEnabled;
+    }
+  } else {
+    DEBUG ((DEBUG_ERROR, "BuildPchFviHob: No PCH Info HOB available\n"));
+  }
+
   //
   // Default value of Silicon Init version
   //
@@ -385,6 +385,7 @@ PciSerialControllerDriverStart (
 
   SerialDevice->Signature               = SERIAL_DEV_SIGNATURE;
   SerialDevice->Type                    = UART16450;
+  SerialDevice->TransmitFifoDepth       = 1;
   SerialDevice->SoftwareLoopbackEnable  = FALSE;
   SerialDevice->HardwareFlowControl     = FALSE;
   SerialDevice->Handle                  = NULL;
@@ -696,10 +697,7 @@ PciSerialFifoAdd (
   ///
   Fifo->Data[Fifo->Last] = Data;
   Fifo->Surplus--;
-  Fifo->Last++;
-  if (Fifo->Last == SERIAL_MAX_BUFFER_SIZE) {
-    Fifo->Last = 0;
-  }
+  Fifo->Last = (Fifo->Last + 1) & SERIAL_FIFO_INDEX_MASK;
 
   return EFI_SUCCESS;
 }
@@ -730,14 +728,77 @@ PciSerialFifoRemove (
   ///
   *Data = Fifo->Data[Fifo->First];
   Fifo->Surplus++;
-  Fifo->First++;
-  if (Fifo->First == SERIAL_MAX_BUFFER_SIZE) {
-    Fifo->First = 0;
-  }
+  Fifo->First = (Fifo->First + 1) & SERIAL_FIFO_INDEX_MASK;
 
   return EFI_SUCCESS;
 }
 
+/**
+  Add a block of data to specific FIFO
+
+  @param[in] Fifo                 A pointer to the Data Structure SERIAL_DEV_FIFO
+  @param[in] Buffer               The data added to FIFO
+  @param[in] Count                Number of bytes in Buffer
+
+  @retval                         Number of bytes added, limited by the free space in the FIFO
+**/
+UINT32
+PciSerialFifoAddBuffer (
+  IN SERIAL_DEV_FIFO              *Fifo,
+  IN CONST UINT8                  *Buffer,
+  IN UINT32                       Count
+  )
+{
+  UINT32  Chunk;
+
+  Count = MIN (Count, Fifo->Surplus);
+
+  ///
+  /// Copy up to the end of Data[], then wrap around to the beginning
+  ///
+  Chunk = MIN (Count, SERIAL_MAX_BUFFER_SIZE - Fifo->Last);
+  CopyMem (&Fifo->Data[Fifo->Last], Buffer, Chunk);
+  CopyMem (&Fifo->Data[0], Buffer + Chunk, Count - Chunk);
+
+  Fifo->Surplus -= Count;
+  Fifo->Last     = (Fifo->Last + Count) & SERIAL_FIFO_INDEX_MASK;
+
+  return Count;
+}
+
+/**
+  Remove a block of data from specific FIFO
+
+  @param[in]  Fifo                A pointer to the Data Structure SERIAL_DEV_FIFO
+  @param[out] Buffer              The data removed from FIFO
+  @param[in]  Count               Size of Buffer in bytes
+
+  @retval                         Number of bytes removed, limited by the data in the FIFO
+**/
+UINT32
+PciSerialFifoRemoveBuffer (
+  IN  SERIAL_DEV_FIFO             *Fifo,
+  OUT UINT8                       *Buffer,
+  IN  UINT32                      Count
+  )
+{
+  UINT32  Chunk;
+
+  Count = MIN (Count, SERIAL_MAX_BUFFER_SIZE - Fifo->Surplus);
+
+  ///
+  /// Copy up to the end of Data[], then wrap around to the beginning
+  ///
+  Chunk = MIN (Count, SERIAL_MAX_BUFFER_SIZE - Fifo->First);
+  CopyMem (Buffer, &Fifo->Data[Fifo->First], Chunk);
+  CopyMem (Buffer + Chunk, &Fifo->Data[0], Count - Chunk);
+
+  Fifo->Surplus += Count;
+  Fifo->First    = (Fifo->First + Count) & SERIAL_FIFO_INDEX_MASK;
+
+  return Count;
+}
+
 /**
   Reads and writes all avaliable data.
 
@@ -754,71 +815,64 @@ PciSerialReceiveTransmit (
 {
   SERIAL_PORT_LSR Lsr;
   UINT8           Data;
-  BOOLEAN         ReceiveFifoFull;
+  UINT8           Burst[SERIAL_MAX_BUFFER_SIZE];
+  UINT32          Count;
   SERIAL_PORT_MSR Msr;
   SERIAL_PORT_MCR Mcr;
   UINTN           TimeOut;
 
-  Data = 0;
+  Msr.Data = 0;
 
   ///
   /// Begin the read or write
   ///
   if (SerialDevice->SoftwareLoopbackEnable) {
-    do {
-      ReceiveFifoFull = PciSerialFifoFull (&SerialDevice->Receive);
-      if (!PciSerialFifoEmpty (&SerialDevice->Transmit)) {
-        PciSerialFifoRemove (&SerialDevice->Transmit, &Data);
-        if (ReceiveFifoFull) {
-          return EFI_OUT_OF_RESOURCES;
-        }
-
-        PciSerialFifoAdd (&SerialDevice->Receive, Data);
+    while (!PciSerialFifoEmpty (&SerialDevice->Transmit)) {
+      if (PciSerialFifoFull (&SerialDevice->Receive)) {
+        return EFI_OUT_OF_RESOURCES;
       }
-    } while (!PciSerialFifoEmpty (&SerialDevice->Transmit));
+      Count = PciSerialFifoRemoveBuffer (&SerialDevice->Transmit, Burst, SerialDevice->Receive.Surplus);
+      PciSerialFifoAddBuffer (&SerialDevice->Receive, Burst, Count);
+    }
   } else {
-    ReceiveFifoFull = PciSerialFifoFull (&SerialDevice->Receive);
     do {
       Lsr.Data = READ_LSR (SerialDevice->PciIo, SerialDevice->BarIndex);
       ///
-      /// Flush incomming data to prevent a an overrun during a long write
+      /// Drain incoming data while RBR holds data to prevent an overrun during a long write
       ///
-      if (Lsr.Bits.DR && !ReceiveFifoFull) {
-        ReceiveFifoFull = PciSerialFifoFull (&SerialDevice->Receive);
-        if (!ReceiveFifoFull) {
-          if (Lsr.Bits.FIFOE || Lsr.Bits.OE || Lsr.Bits.PE || Lsr.Bits.FE || Lsr.Bits.BI) {
-            if (Lsr.Bits.FIFOE || Lsr.Bits.PE || Lsr.Bits.FE || Lsr.Bits.BI) {
-              Data = READ_RBR (SerialDevice->PciIo, SerialDevice->BarIndex);
-              continue;
-            }
-          }
-          ///
-          /// Make sure the receive data will not be missed, Assert DTR
-          ///
-          if (SerialDevice->HardwareFlowControl) {
-            Mcr.Data = READ_MCR (SerialDevice->PciIo, SerialDevice->BarIndex);
-            Mcr.Bits.DTRC &= 0;
-            WRITE_MCR (SerialDevice->PciIo, SerialDevice->BarIndex, Mcr.Data);
-          }
+      if (Lsr.Bits.DR && !PciSerialFifoFull (&SerialDevice->Receive)) {
+        ///
+        /// Make sure the receive data will not be missed, Assert DTR
+        ///
+        if (SerialDevice->HardwareFlowControl) {
+          Mcr.Data = READ_MCR (SerialDevice->PciIo, SerialDevice->BarIndex);
+          Mcr.Bits.DTRC &= 0;
+          WRITE_MCR (SerialDevice->PciIo, SerialDevice->BarIndex, Mcr.Data);
+        }
 
+        do {
           Data = READ_RBR (SerialDevice->PciIo, SerialDevice->BarIndex);
-
           ///
-          /// Deassert DTR
+          /// Characters received with a framing, parity or break error are discarded
           ///
-          if (SerialDevice->HardwareFlowControl) {
-            Mcr.Data = READ_MCR (SerialDevice->PciIo, SerialDevice->BarIndex);
-            Mcr.Bits.DTRC |= 1;
-            WRITE_MCR (SerialDevice->PciIo, SerialDevice->BarIndex, Mcr.Data);
+          if (!(Lsr.Bits.FIFOE || Lsr.Bits.PE || Lsr.Bits.FE || Lsr.Bits.BI)) {
+            PciSerialFifoAdd (&SerialDevice->Receive, Data);
           }
+          Lsr.Data = READ_LSR (SerialDevice->PciIo, SerialDevice->BarIndex);
+        } while (Lsr.Bits.DR && !PciSerialFifoFull (&SerialDevice->Receive));
 
-          PciSerialFifoAdd (&SerialDevice->Receive, Data);
-
-          continue;
+        ///
+        /// Deassert DTR
+        ///
+        if (SerialDevice->HardwareFlowControl) {
+          Mcr.Data = READ_MCR (SerialDevice->PciIo, SerialDevice->BarIndex);
+          Mcr.Bits.DTRC |= 1;
+          WRITE_MCR (SerialDevice->PciIo, SerialDevice->BarIndex, Mcr.Data);
         }
       }
       ///
-      /// Do the write
+      /// Do the write. THRE means the whole transmit FIFO is empty, so it can be
+      /// refilled with up to TransmitFifoDepth bytes without another LSR read.
       ///
       if (Lsr.Bits.THRE && !PciSerialFifoEmpty (&SerialDevice->Transmit)) {
         ///
@@ -845,18 +899,13 @@ PciSerialReceiveTransmit (
 
             Msr.Data = READ_MSR (SerialDevice->PciIo, SerialDevice->BarIndex);
           }
-
-          if (Msr.Bits.CTS) {
-            PciSerialFifoRemove (&SerialDevice->Transmit, &Data);
-            WRITE_THR (SerialDevice->PciIo, SerialDevice->BarIndex, Data);
-          }
         }
         ///
         /// write the data out
         ///
-        if (!SerialDevice->HardwareFlowControl) {
-          PciSerialFifoRemove (&SerialDevice->Transmit, &Data);
-          WRITE_THR (SerialDevice->PciIo, SerialDevice->BarIndex, Data);
+        if (!SerialDevice->HardwareFlowControl || Msr.Bits.CTS) {
+          Count = PciSerialFifoRemoveBuffer (&SerialDevice->Transmit, Burst, SerialDevice->TransmitFifoDepth);
+          WRITE_THR_FIFO (SerialDevice->PciIo, SerialDevice->BarIndex, Burst, Count);
         }
         ///
         /// Make sure the transmit data will not be missed
@@ -900,6 +949,7 @@ PciSerialReset (
   SERIAL_PORT_IER Ier;
   SERIAL_PORT_MCR Mcr;
   SERIAL_PORT_FCR Fcr;
+  SERIAL_PORT_IIR Iir;
   EFI_TPL         Tpl;
 
   SerialDevice  = SERIAL_DEV_FROM_THIS (This);
@@ -924,11 +974,26 @@ PciSerialReset (
   WRITE_IER (SerialDevice->PciIo, SerialDevice->BarIndex, Ier.Data);
 
   ///
-  /// Disable the FIFO.
+  /// Enable and reset the FIFOs. Transmit bursts are only used when the UART
+  /// reports FIFO mode (16550A), otherwise the FIFO is left disabled.
   ///
-  Fcr.Bits.TRFIFOE = 0;
+  Fcr.Data         = 0;
+  Fcr.Bits.TRFIFOE = 1;
+  Fcr.Bits.RESETRF = 1;
+  Fcr.Bits.RESETTF = 1;
   WRITE_FCR (SerialDevice->PciIo, SerialDevice->BarIndex, Fcr.Data);
 
+  Iir.Data = READ_IIR (SerialDevice->PciIo, SerialDevice->BarIndex);
+  if (Iir.Bits.FIFOES == 3) {
+    SerialDevice->Type              = UART16550A;
+    SerialDevice->TransmitFifoDepth = SERIAL_PORT_16550A_FIFO_DEPTH;
+  } else {
+    Fcr.Data = 0;
+    WRITE_FCR (SerialDevice->PciIo, SerialDevice->BarIndex, Fcr.Data);
+    SerialDevice->Type              = UART16450;
+    SerialDevice->TransmitFifoDepth = 1;
+  }
+
   ///
   /// Turn off loopback and disable device interrupt.
   ///
@@ -1488,7 +1553,7 @@ PciSerialWrite (
 {
   SERIAL_DEV      *SerialDevice;
   UINT8           *CharBuffer;
-  UINT32          Index;
+  UINT32          Pending;
   UINTN           Elapsed;
   UINTN           ActualWrite;
   EFI_TPL         Tpl;
@@ -1510,37 +1575,42 @@ PciSerialWrite (
 
   CharBuffer  = (UINT8 *) Buffer;
 
-  for (Index = 0; Index < *BufferSize; Index++) {
-    PciSerialFifoAdd (&SerialDevice->Transmit, CharBuffer[Index]);
+  while ((ActualWrite < *BufferSize) || !PciSerialFifoEmpty (&SerialDevice->Transmit)) {
+    ActualWrite += PciSerialFifoAddBuffer (
+                     &SerialDevice->Transmit,
+                     &CharBuffer[ActualWrite],
+                     (UINT32) MIN (*BufferSize - ActualWrite, SERIAL_MAX_BUFFER_SIZE)
+                     );
+    Pending = SERIAL_MAX_BUFFER_SIZE - SerialDevice->Transmit.Surplus;
 
-    while
-    (
-      PciSerialReceiveTransmit (SerialDevice) != EFI_SUCCESS ||
-      PciSerialFifoEmpty (&SerialDevice->Transmit) == FALSE
-      ) {
+    if ((PciSerialReceiveTransmit (SerialDevice) == EFI_SUCCESS) &&
+        ((SERIAL_MAX_BUFFER_SIZE - SerialDevice->Transmit.Surplus) < Pending)) {
       ///
-      ///  Unsuccessful write so check if timeout has expired, if not,
-      ///  stall for a bit, increment time elapsed, and try again
+      ///  Successful write so reset timeout
       ///
-      if (Elapsed >= This->Mode->Timeout) {
-        *BufferSize = ActualWrite;
-        if (PciSerialFifoEmpty (&SerialDevice->Transmit)) {
-          gBS->RestoreTPL (Tpl);
-          return EFI_TIMEOUT;
-        }
-      }
-
-      MicroSecondDelay (TIMEOUT_STALL_INTERVAL);
-
-      Elapsed += TIMEOUT_STALL_INTERVAL;
-    } // end while
-    ActualWrite++;
+      Elapsed = 0;
+      continue;
+    }
     ///
-    ///  Successful write so reset timeout
+    ///  Unsuccessful write so check if timeout has expired, if not,
+    ///  stall for a bit, increment time elapsed, and try again
     ///
-    Elapsed = 0;
+    if (Elapsed >= This->Mode->Timeout) {
+      ///
+      ///  Data still queued in the software FIFO is dropped and not reported as written
+      ///
+      *BufferSize = ActualWrite - Pending;
+      SerialDevice->Transmit.First   = 0;
+      SerialDevice->Transmit.Last    = 0;
+      SerialDevice->Transmit.Surplus = SERIAL_MAX_BUFFER_SIZE;
+      gBS->RestoreTPL (Tpl);
+      return EFI_TIMEOUT;
+    }
+
+    MicroSecondDelay (TIMEOUT_STALL_INTERVAL);
 
-  } // end for
+    Elapsed += TIMEOUT_STALL_INTERVAL;
+  }
   ///
   /// FW expects DTR bit to be SET before sending data. So enable DTR bit always.
   ///
@@ -1573,7 +1643,8 @@ PciSerialRead (
   )
 {
   SERIAL_DEV  *SerialDevice;
-  UINT32      Index;
+  UINTN       Index;
+  UINT32      Count;
   UINT8       *CharBuffer;
   UINTN       Elapsed;
   EFI_STATUS  Status;
@@ -1607,34 +1678,45 @@ PciSerialRead (
   }
 
   CharBuffer = (UINT8 *) Buffer;
-  for (Index = 0; Index < *BufferSize; Index++) {
-    while (PciSerialFifoRemove (&SerialDevice->Receive, &(CharBuffer[Index])) != EFI_SUCCESS) {
+  Index      = 0;
+  while (Index < *BufferSize) {
+    Count = PciSerialFifoRemoveBuffer (
+              &SerialDevice->Receive,
+              &CharBuffer[Index],
+              (UINT32) MIN (*BufferSize - Index, SERIAL_MAX_BUFFER_SIZE)
+              );
+    if (Count != 0) {
       ///
-      ///  Unsuccessful read so check if timeout has expired, if not,
-      ///  stall for a bit, increment time elapsed, and try again
-      ///  Need this time out to get conspliter to work.
+      ///  Successful read so reset timeout
       ///
-      if (Elapsed >= This->Mode->Timeout) {
-        *BufferSize = Index;
-        gBS->RestoreTPL (Tpl);
-        return EFI_TIMEOUT;
-      }
-
-      MicroSecondDelay (TIMEOUT_STALL_INTERVAL);
-      Elapsed += TIMEOUT_STALL_INTERVAL;
+      Index  += Count;
+      Elapsed = 0;
+      continue;
+    }
 
-      Status = PciSerialReceiveTransmit (SerialDevice);
-      if (Status == EFI_DEVICE_ERROR) {
-        *BufferSize = Index;
-        gBS->RestoreTPL (Tpl);
-        return EFI_DEVICE_ERROR;
-      }
-    } // end while
+    Status = PciSerialReceiveTransmit (SerialDevice);
+    if (Status == EFI_DEVICE_ERROR) {
+      *BufferSize = Index;
+      gBS->RestoreTPL (Tpl);
+      return EFI_DEVICE_ERROR;
+    }
+    if (!PciSerialFifoEmpty (&SerialDevice->Receive)) {
+      continue;
+    }
     ///
-    ///  Successful read so reset timeout
+    ///  Unsuccessful read so check if timeout has expired, if not,
+    ///  stall for a bit, increment time elapsed, and try again
+    ///  Need this time out to get conspliter to work.
     ///
-    Elapsed = 0;
-  } // end for
+    if (Elapsed >= This->Mode->Timeout) {
+      *BufferSize = Index;
+      gBS->RestoreTPL (Tpl);
+      return EFI_TIMEOUT;
+    }
+
+    MicroSecondDelay (TIMEOUT_STALL_INTERVAL);
+    Elapsed += TIMEOUT_STALL_INTERVAL;
+  }
   PciSerialReceiveTransmit (SerialDevice);
 
   gBS->RestoreTPL (Tpl);
@@ -1743,6 +1825,40 @@ PciSerialWritePort (
               );
 }
 
+/**
+  PCI I/O - write a block of bytes to the same register
+
+  @param[in] PciIo                Pointer of Pci IO protocol
+  @param[in] BarIndex             Index of the BAR within PCI device
+  @param[in] Offset               Offset of the BARIndex within PCI device
+  @param[in] Buffer               Values to be written, in order
+  @param[in] Count                Number of bytes in Buffer
+**/
+VOID
+PciSerialWritePortFifo (
+  IN EFI_PCI_IO_PROTOCOL          *PciIo,
+  IN UINT16                       BarIndex,
+  IN UINT16                       Offset,
+  IN UINT8                        *Buffer,
+  IN UINTN                        Count
+  )
+{
+  if (Count == 0) {
+    return;
+  }
+  ///
+  /// FIFO width keeps the register offset fixed while Buffer is advanced
+  ///
+  PciIo->Io.Write (
+              PciIo,
+              EfiPciIoWidthFifoUint8,
+              (UINT8) BarIndex,
+              (UINT16) Offset,
+              Count,
+              Buffer
+              );
+}
+
 /**
   Sol driver entry
 
@@ -55,7 +55,8 @@
 // Internal Data Structures
 //
 #define SERIAL_DEV_SIGNATURE    SIGNATURE_32 ('s', 'e', 'r', 'd')
-#define SERIAL_MAX_BUFFER_SIZE  16
+#define SERIAL_MAX_BUFFER_SIZE  64   ///< Must be a power of two
+#define SERIAL_FIFO_INDEX_MASK  (SERIAL_MAX_BUFFER_SIZE - 1)
 #define TIMEOUT_STALL_INTERVAL  300
 
 ///
@@ -63,8 +64,8 @@
 ///  Purpose:  To define Receive FIFO and Transmit FIFO
 ///  Context:  Used by serial data transmit and receive
 ///  Fields:
-///      First UINT32: The index of the first data in array Data[]
-///      Last  UINT32: The index, which you can put a new data into array Data[]
+///      First UINT32: The index of the first data in array Data[], wraps with SERIAL_FIFO_INDEX_MASK
+///      Last  UINT32: The index, which you can put a new data into array Data[], wraps with SERIAL_FIFO_INDEX_MASK
 ///      Surplus UINT32: Identify how many data you can put into array Data[]
 ///      Data[]  UINT8 : An array, which used to store data
 ///
@@ -100,6 +101,7 @@ typedef enum {
 ///                  which you want to transmit by UART
 ///      SoftwareLoopbackEnable BOOLEAN:
 ///      Type    EFI_UART_TYPE: Specify the UART type of certain serial device
+///      TransmitFifoDepth UINT32: Number of bytes that can be written to THR once THRE is set
 ///
 typedef struct {
   UINTN                     Signature;
@@ -116,6 +118,7 @@ typedef struct {
   BOOLEAN                   SoftwareLoopbackEnable;
   BOOLEAN                   HardwareFlowControl;
   EFI_UART_TYPE             Type;
+  UINT32                    TransmitFifoDepth;
   EFI_UNICODE_STRING_TABLE  *ControllerNameTable;
 } SERIAL_DEV;
 
@@ -150,6 +153,7 @@ extern EFI_COMPONENT_NAME_PROTOCOL  mPciSerialComponentName;
 #define SERIAL_PORT_MIN_BAUD_RATE           50
 
 #define SERIAL_PORT_MAX_RECEIVE_FIFO_DEPTH  16
+#define SERIAL_PORT_16550A_FIFO_DEPTH       16
 #define SERIAL_PORT_MIN_TIMEOUT             1           ///< 1 uS
 #define SERIAL_PORT_MAX_TIMEOUT             10000000000 ///< 10000 seconds
 //
@@ -434,6 +438,7 @@ typedef union {
 #define READ_SCR(IO, B)       PciSerialReadPort (IO, B, SERIAL_REGISTER_SCR)
 
 #define WRITE_THR(IO, B, D)   PciSerialWritePort (IO, B, SERIAL_REGISTER_THR, D)
+#define WRITE_THR_FIFO(IO, B, D, C) PciSerialWritePortFifo (IO, B, SERIAL_REGISTER_THR, D, C)
 #define WRITE_DLL(IO, B, D)   PciSerialWritePort (IO, B, SERIAL_REGISTER_DLL, D)
 #define WRITE_DLM(IO, B, D)   PciSerialWritePort (IO, B, SERIAL_REGISTER_DLM, D)
 #define WRITE_IER(IO, B, D)   PciSerialWritePort (IO, B, SERIAL_REGISTER_IER, D)
@@ -570,6 +575,38 @@ PciSerialFifoRemove (
   OUT UINT8                       *Data
   );
 
+/**
+  Add a block of data to specific FIFO
+
+  @param[in] Fifo                 A pointer to the Data Structure SERIAL_DEV_FIFO
+  @param[in] Buffer               The data added to FIFO
+  @param[in] Count                Number of bytes in Buffer
+
+  @retval                         Number of bytes added, limited by the free space in the FIFO
+**/
+UINT32
+PciSerialFifoAddBuffer (
+  IN SERIAL_DEV_FIFO              *Fifo,
+  IN CONST UINT8                  *Buffer,
+  IN UINT32                       Count
+  );
+
+/**
+  Remove a block of data from specific FIFO
+
+  @param[in]  Fifo                A pointer to the Data Structure SERIAL_DEV_FIFO
+  @param[out] Buffer              The data removed from FIFO
+  @param[in]  Count               Size of Buffer in bytes
+
+  @retval                         Number of bytes removed, limited by the data in the FIFO
+**/
+UINT32
+PciSerialFifoRemoveBuffer (
+  IN  SERIAL_DEV_FIFO             *Fifo,
+  OUT UINT8                       *Buffer,
+  IN  UINT32                      Count
+  );
+
 /**
   Reads and writes all avaliable data.
 
@@ -746,6 +783,24 @@ PciSerialWritePort (
   IN UINT8                        Data
   );
 
+/**
+  PCI I/O - write a block of bytes to the same register
+
+  @param[in] PciIo                Pointer of Pci IO protocol
+  @param[in] BarIndex             Index of the BAR within PCI device
+  @param[in] Offset               Offset of the BARIndex within PCI device
+  @param[in] Buffer               Values to be written, in order
+  @param[in] Count                Number of bytes in Buffer
+**/
+VOID
+PciSerialWritePortFifo (
+  IN EFI_PCI_IO_PROTOCOL          *PciIo,
+  IN UINT16                       BarIndex,
+  IN UINT16                       Offset,
+  IN UINT8                        *Buffer,
+  IN UINTN                        Count
+  );
+
 /**
   Sol driver entry
 
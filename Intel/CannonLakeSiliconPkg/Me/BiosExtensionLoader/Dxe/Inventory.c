@@ -44,6 +44,7 @@
 #include "BiosExtensionLoader.h"
 #include "Inventory.h"
 #include <Library/UefiLib.h>
+#include <Library/TimerLib.h>
 
 GLOBAL_REMOVE_IF_UNREFERENCED AMT_MEDIA_FRU mAmtMediaFru;
 GLOBAL_REMOVE_IF_UNREFERENCED AMT_PCI_FRU   mAmtPciFru;
@@ -473,57 +474,153 @@ Done:
 
 
 /**
-  Get Nvme device identify data.
+  Starts an identify command on a pass thru protocol. The command runs in non-blocking mode
+  when the protocol supports it. The command is outstanding while Command->Event is not NULL,
+  InventoryIdentifyCommandPending() collects the result once the event is signalled.
+  EFI_NOT_READY returned by the pass thru protocol itself is reported as EFI_DEVICE_ERROR.
+
+  @param[in]      Type              Type of the pass thru protocol
+  @param[in]      PassThru          EFI_ATA_PASS_THRU_PROTOCOL or EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL instance
+  @param[in]      Port              ATA port number or NVMe NamespaceId
+  @param[in]      PortMultiplierPort ATA port multiplier port number, ignored for NVMe
+  @param[in, out] Command           Prepared command, must stay valid until the command completes
+**/
+VOID
+InventoryIdentifyCommandStart (
+  IN     INVENTORY_IDENTIFY_TYPE               Type,
+  IN     VOID                                  *PassThru,
+  IN     UINT32                                Port,
+  IN     UINT16                                PortMultiplierPort,
+  IN OUT INVENTORY_IDENTIFY_COMMAND            *Command
+  )
+{
+  EFI_ATA_PASS_THRU_PROTOCOL                   *AtaDevice;
+  EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL           *NvmeDevice;
+  BOOLEAN                                      NonBlocking;
+
+  AtaDevice  = (EFI_ATA_PASS_THRU_PROTOCOL *) PassThru;
+  NvmeDevice = (EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL *) PassThru;
+
+  if (Type == InventoryIdentifyAta) {
+    NonBlocking = (BOOLEAN) ((AtaDevice->Mode->Attributes & EFI_ATA_PASS_THRU_ATTRIBUTES_NONBLOCKIO) != 0);
+  } else {
+    NonBlocking = (BOOLEAN) ((NvmeDevice->Mode->Attributes & EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_NONBLOCKIO) != 0);
+  }
+
+  Command->Event = NULL;
+  if (NonBlocking) {
+    if (EFI_ERROR (gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Command->Event))) {
+      Command->Event = NULL;
+    }
+  }
+
+  if (Type == InventoryIdentifyAta) {
+    Command->Status = AtaDevice->PassThru (AtaDevice, (UINT16) Port, PortMultiplierPort, &Command->Cmd.Ata.Packet, Command->Event);
+  } else {
+    Command->Status = NvmeDevice->PassThru (NvmeDevice, Port, &Command->Cmd.Nvme.Packet, Command->Event);
+  }
+
+  ///
+  /// The pass thru protocol could not accept the command, treat it as failed
+  ///
+  if (Command->Status == EFI_NOT_READY) {
+    Command->Status = EFI_DEVICE_ERROR;
+  }
+
+  if (Command->Event != NULL) {
+    if (EFI_ERROR (Command->Status)) {
+      gBS->CloseEvent (Command->Event);
+      Command->Event = NULL;
+    } else {
+      Command->Status = EFI_NOT_READY;
+    }
+  }
+
+  if (EFI_ERROR (Command->Status) && (Command->Event == NULL)) {
+    DEBUG ((DEBUG_WARN, "Identify Command Status=%r\n", Command->Status));
+  }
+}
+
+/**
+  Checks whether an identify command is still outstanding and collects the result of a
+  non-blocking command once its event has been signalled.
 
-  @param[in]   NvmeDevice        The pointer to the NVME_PASS_THRU_DEVICE data structure.
-  @param[in]   NamespaceId       NamespaceId for an NVM Express namespace present on the NVM Express controller
-  @param[in]   IdentifyStructure Specifies the information to be returned to host.
-  @param[out]  Buffer            The buffer used to store the identify controller data.
+  @param[in]      Type              Type of the pass thru protocol
+  @param[in, out] Command           Identify command
 
-  @return EFI_SUCCESS            Successfully get the identify controller data.
-  @return EFI_DEVICE_ERROR       Fail to get the identify controller data.
+  @retval TRUE                      The command is still outstanding
+  @retval FALSE                     The command has completed, Command->Status holds the result
 **/
-EFI_STATUS
+BOOLEAN
+InventoryIdentifyCommandPending (
+  IN     INVENTORY_IDENTIFY_TYPE               Type,
+  IN OUT INVENTORY_IDENTIFY_COMMAND            *Command
+  )
+{
+  if (Command->Event == NULL) {
+    return FALSE;
+  }
+
+  if (gBS->CheckEvent (Command->Event) == EFI_NOT_READY) {
+    return TRUE;
+  }
+
+  ///
+  /// Non-blocking pass thru reports the command result in the status block / completion entry only
+  ///
+  if (Type == InventoryIdentifyAta) {
+    Command->Status = ((Command->Cmd.Ata.Asb.AtaStatus & ATA_STSREG_ERR) != 0) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+  } else {
+    Command->Status = (NVME_CQE_STATUS (Command->Cmd.Nvme.Completion.DW3) != 0) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+  }
+  gBS->CloseEvent (Command->Event);
+  Command->Event = NULL;
+
+  return FALSE;
+}
+
+/**
+  Get Nvme device identify data.
+
+  @param[in]      NvmeDevice        The pointer to the NVME_PASS_THRU_DEVICE data structure.
+  @param[in]      NamespaceId       NamespaceId for an NVM Express namespace present on the NVM Express controller
+  @param[in]      IdentifyStructure Specifies the information to be returned to host.
+  @param[out]     Buffer            The buffer used to store the identify controller data.
+  @param[in, out] Command           Command storage, must stay valid until the command completes.
+**/
+VOID
 NvmeIdentifyCommand (
-  IN  EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL    *NvmeDevice,
-  IN  UINT32                                NamespaceId,
-  IN  UINT32                                IdentifyStructure,
-  OUT VOID                                  *Buffer
+  IN     EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL    *NvmeDevice,
+  IN     UINT32                                NamespaceId,
+  IN     UINT32                                IdentifyStructure,
+  OUT    VOID                                  *Buffer,
+  IN OUT INVENTORY_IDENTIFY_COMMAND            *Command
   )
 {
-  EFI_STATUS                                Status;
-  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET  CommandPacket;
-  EFI_NVM_EXPRESS_COMMAND                   Command;
-  EFI_NVM_EXPRESS_COMPLETION                Completion;
+  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET  *CommandPacket;
 
-  ZeroMem (&CommandPacket, sizeof(EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
-  ZeroMem (&Command, sizeof(EFI_NVM_EXPRESS_COMMAND));
-  ZeroMem (&Completion, sizeof(EFI_NVM_EXPRESS_COMPLETION));
+  ZeroMem (&Command->Cmd.Nvme, sizeof (Command->Cmd.Nvme));
+  CommandPacket = &Command->Cmd.Nvme.Packet;
 
   DEBUG ((DEBUG_INFO, "Sending Identify Command with Cns = %d\n", IdentifyStructure));
 
-  Command.Cdw0.Opcode          = NVME_ADMIN_IDENTIFY_CMD;
+  Command->Cmd.Nvme.Command.Cdw0.Opcode = NVME_ADMIN_IDENTIFY_CMD;
 
-  Command.Nsid                 = NamespaceId;
+  Command->Cmd.Nvme.Command.Nsid        = NamespaceId;
 
-  CommandPacket.NvmeCmd        = &Command;
-  CommandPacket.NvmeCompletion = &Completion;
-  CommandPacket.TransferBuffer = Buffer;
-  CommandPacket.TransferLength = sizeof (NVME_ADMIN_CONTROLLER_DATA);
-  CommandPacket.CommandTimeout = NVME_GENERIC_TIMEOUT;
-  CommandPacket.QueueType      = NVME_ADMIN_QUEUE;
+  CommandPacket->NvmeCmd        = &Command->Cmd.Nvme.Command;
+  CommandPacket->NvmeCompletion = &Command->Cmd.Nvme.Completion;
+  CommandPacket->TransferBuffer = Buffer;
+  CommandPacket->TransferLength = sizeof (NVME_ADMIN_CONTROLLER_DATA);
+  CommandPacket->CommandTimeout = NVME_GENERIC_TIMEOUT;
+  CommandPacket->QueueType      = NVME_ADMIN_QUEUE;
   //
   // Set bit 0 (Cns bit) to 0 to identify a namespace / 1 to identify a controller
   //
-  Command.Cdw10                = IdentifyStructure;
-  Command.Flags                = CDW10_VALID;
-
-  Status = NvmeDevice->PassThru (NvmeDevice, NamespaceId, &CommandPacket, NULL);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_WARN, "Identify Command Status=%r\n", Status));
-  }
+  Command->Cmd.Nvme.Command.Cdw10       = IdentifyStructure;
+  Command->Cmd.Nvme.Command.Flags       = CDW10_VALID;
 
-  return Status;
+  InventoryIdentifyCommandStart (InventoryIdentifyNvme, NvmeDevice, NamespaceId, 0, Command);
 }
 
 /**
@@ -595,41 +692,106 @@ IsPassThruProtocolAvailable (
   @param[in]          Port                Port number on the ATA controller
   @param[in]          PortMultiplierPort  Port multiplier port number on the ATA controller
   @param[out]         ControllerData      The buffer used to store the identify controller data.
+  @param[in, out]     Command             Command storage, must stay valid until the command completes.
+**/
+VOID
+GetHddIdentifyData (
+  IN     EFI_ATA_PASS_THRU_PROTOCOL             *AtaDevice,
+  IN     UINT16                                 Port,
+  IN     UINT16                                 PortMultiplierPort,
+  OUT    ATA_IDENTIFY_DATA                      *ControllerData,
+  IN OUT INVENTORY_IDENTIFY_COMMAND             *Command
+  )
+{
+  EFI_ATA_PASS_THRU_COMMAND_PACKET         *Packet;
+
+  ZeroMem (&Command->Cmd.Ata, sizeof (Command->Cmd.Ata));
+  Packet = &Command->Cmd.Ata.Packet;
+
+  Command->Cmd.Ata.Acb.AtaCommand = ATA_CMD_IDENTIFY_DRIVE;
+
+  Packet->Protocol            = EFI_ATA_PASS_THRU_PROTOCOL_PIO_DATA_IN;
+  Packet->Acb                 = &Command->Cmd.Ata.Acb;
+  Packet->Asb                 = &Command->Cmd.Ata.Asb;
+  Packet->InDataBuffer        = ControllerData;
+  Packet->InTransferLength    = sizeof (ATA_IDENTIFY_DATA);
+  Packet->Length              = EFI_ATA_PASS_THRU_LENGTH_BYTES | EFI_ATA_PASS_THRU_LENGTH_SECTOR_COUNT;
+  Packet->Timeout             = EFI_TIMER_PERIOD_SECONDS (3);
+
+  InventoryIdentifyCommandStart (InventoryIdentifyAta, AtaDevice, Port, PortMultiplierPort, Command);
+}
+
+/**
+  Get ATA device identify data cached by the ATA bus driver, without sending a command to the device.
+
+  @param[in]   Controller         Handle of the ATA pass thru controller.
+  @param[in]   AtaDevice          The pointer to the EFI_ATA_PASS_THRU_PROTOCOL.
+  @param[in]   Port               Port number on the ATA controller
+  @param[in]   PortMultiplierPort Port multiplier port number on the ATA controller
+  @param[out]  IdentifyData       The buffer used to store the device identify data.
 
-  @return             EFI_SUCCESS         Successfully get the identify controller data.
-  @return             EFI_DEVICE_ERROR    Fail to get the identify controller data.
+  @return EFI_SUCCESS             Successfully got the device identify data.
+  @return Other                   No Disk Info instance exists for the device.
 **/
 EFI_STATUS
-GetHddIdentifyData (
-  IN EFI_ATA_PASS_THRU_PROTOCOL             *AtaDevice,
-  IN UINT16                                 Port,
-  IN UINT16                                 PortMultiplierPort,
-  OUT ATA_IDENTIFY_DATA                     *ControllerData
+GetAtaIdentifyDataFromDiskInfo (
+  IN  EFI_HANDLE                        Controller,
+  IN  EFI_ATA_PASS_THRU_PROTOCOL        *AtaDevice,
+  IN  UINT16                            Port,
+  IN  UINT16                            PortMultiplierPort,
+  OUT ATA_IDENTIFY_DATA                 *IdentifyData
   )
 {
-  EFI_STATUS                               Status;
-  EFI_ATA_PASS_THRU_COMMAND_PACKET         Packet;
-  EFI_ATA_COMMAND_BLOCK                    Acb;
-  EFI_ATA_STATUS_BLOCK                     Asb;
+  EFI_STATUS                           Status;
+  EFI_DEVICE_PATH_PROTOCOL             *ControllerPath;
+  EFI_DEVICE_PATH_PROTOCOL             *DeviceNode;
+  EFI_DEVICE_PATH_PROTOCOL             *DevicePath;
+  EFI_DEVICE_PATH_PROTOCOL             *RemainingPath;
+  EFI_HANDLE                           Handle;
+  EFI_DISK_INFO_PROTOCOL               *DiskInfo;
+  UINT32                               BufferSize;
 
-  ZeroMem (&Packet, sizeof(EFI_ATA_PASS_THRU_COMMAND_PACKET));
-  ZeroMem (&Acb, sizeof(EFI_ATA_COMMAND_BLOCK));
-  ZeroMem (&Asb, sizeof(EFI_ATA_STATUS_BLOCK));
+  ControllerPath = DevicePathFromHandle (Controller);
+  if (ControllerPath == NULL) {
+    return EFI_NOT_FOUND;
+  }
 
-  Acb.AtaCommand             = ATA_CMD_IDENTIFY_DRIVE;
+  Status = AtaDevice->BuildDevicePath (AtaDevice, Port, PortMultiplierPort, &DeviceNode);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-  Packet.Protocol            = EFI_ATA_PASS_THRU_PROTOCOL_PIO_DATA_IN;
-  Packet.Acb                 = &Acb;
-  Packet.Asb                 = &Asb;
-  Packet.InDataBuffer        = ControllerData;
-  Packet.InTransferLength    = sizeof (ATA_IDENTIFY_DATA);
-  Packet.Length              = EFI_ATA_PASS_THRU_LENGTH_BYTES | EFI_ATA_PASS_THRU_LENGTH_SECTOR_COUNT;
-  Packet.Timeout             = EFI_TIMER_PERIOD_SECONDS (3);
+  DevicePath = AppendDevicePathNode (ControllerPath, DeviceNode);
+  FreePool (DeviceNode);
+  if (DevicePath == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-  Status = AtaDevice->PassThru (AtaDevice, Port, PortMultiplierPort, &Packet, NULL);
+  ///
+  /// Disk Info must be installed on the device handle itself, not on the controller
+  ///
+  RemainingPath = DevicePath;
+  Status = gBS->LocateDevicePath (&gEfiDiskInfoProtocolGuid, &RemainingPath, &Handle);
+  if (!EFI_ERROR (Status) && !IsDevicePathEnd (RemainingPath)) {
+    Status = EFI_NOT_FOUND;
+  }
+  FreePool (DevicePath);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-  return Status;
+  Status = gBS->HandleProtocol (Handle, &gEfiDiskInfoProtocolGuid, (VOID **) &DiskInfo);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (!CompareGuid (&DiskInfo->Interface, &gEfiDiskInfoAhciInterfaceGuid) &&
+      !CompareGuid (&DiskInfo->Interface, &gEfiDiskInfoIdeInterfaceGuid)) {
+    return EFI_UNSUPPORTED;
+  }
 
+  BufferSize = sizeof (ATA_IDENTIFY_DATA);
+  return DiskInfo->Identify (DiskInfo, IdentifyData, &BufferSize);
 }
 
 /**
@@ -676,30 +838,66 @@ GetIdentifyDataFromDiskInfo (
 
 
 /**
-  Detects all Ata Devices with Ata Pass Thru Protocol installed and adds them to
-  media table.
+  Allocates a new identify request.
+
+  @param[in, out] Requests        Array of identify requests
+  @param[in, out] RequestCount    Number of identify requests in Requests
+  @param[in]      Type            Type of the pass thru protocol
+
+  @return Pointer to the new request, NULL if the media table is full or allocation failed
+**/
+INVENTORY_IDENTIFY_REQUEST *
+InventoryAllocateIdentifyRequest (
+  IN OUT INVENTORY_IDENTIFY_REQUEST        **Requests,
+  IN OUT UINTN                             *RequestCount,
+  IN     INVENTORY_IDENTIFY_TYPE           Type
+  )
+{
+  INVENTORY_IDENTIFY_REQUEST               *Request;
+
+  if (*RequestCount == PCI_MAX_DEVICE + 1) {
+    return NULL;
+  }
+
+  Request = AllocateZeroPool (sizeof (INVENTORY_IDENTIFY_REQUEST));
+  if (Request == NULL) {
+    return NULL;
+  }
+
+  Request->Type                = Type;
+  Request->Command[0].Status   = EFI_NOT_STARTED;
+  Request->Command[1].Status   = EFI_NOT_STARTED;
+  Requests[(*RequestCount)++]  = Request;
+
+  return Request;
+}
+
+/**
+  Issues identify requests for all Ata Devices with Ata Pass Thru Protocol installed.
+  Identify data already cached by the ATA bus driver is taken from Disk Info,
+  the remaining devices get a (non-blocking when supported) IDENTIFY DEVICE command.
 
-  @param[in]   MediaDeviceCount   A pointer to number of media devices in media table.
+  @param[in, out] Requests        Array of identify requests
+  @param[in, out] RequestCount    Number of identify requests in Requests
 
-  @return EFI_SUCCESS             Successfully added Ata devices into media table.
+  @return EFI_SUCCESS             Identify requests were issued for all Ata devices.
   @return EFI_BUFFER_TOO_SMALL    Maximum number of media table entries was reached.
-  @return Other                   Failed to add Ata devices into media table.
+  @return Other                   Failed to locate Ata Pass Thru Protocol.
 **/
 EFI_STATUS
-DetectAtaDevices (
-  IN OUT UINT8                             *MediaDeviceCount
+StartAtaIdentifyRequests (
+  IN OUT INVENTORY_IDENTIFY_REQUEST        **Requests,
+  IN OUT UINTN                             *RequestCount
   )
 {
   EFI_STATUS                           Status;
   UINTN                                HandleNum;
   EFI_HANDLE                           *AtaPassThruHandles;
   UINTN                                Index;
-  UINTN                                WordOffset;
   EFI_ATA_PASS_THRU_PROTOCOL           *AtaDevice;
-  EFI_ATA_IDENTIFY_DATA                AtaIdentifyData;
+  INVENTORY_IDENTIFY_REQUEST           *Request;
   UINT16                               Port;
   UINT16                               PortMultiplierPort;
-  UINT64                               DriveSize;
 
   Status = gBS->LocateHandleBuffer (
                   ByProtocol,
@@ -724,99 +922,66 @@ DetectAtaDevices (
                     );
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "gBS->Handle Protocol : Status = %r\n", Status));
-      return Status;
+      continue;
     }
 
     //
-    // Go through all of the ports and portmultiplierports and get identify data
+    // Go through all of the ports and portmultiplierports and start identify
     //
     Port = 0xFFFF;
 
-    while (TRUE) {
-
-      Status = AtaDevice->GetNextPort (AtaDevice, &Port);
-      if (EFI_ERROR (Status)) {
-        if (Status == EFI_NOT_FOUND) {
-          return EFI_SUCCESS;
-        } else {
-          return Status;
-        }
-      }
-
+    while (AtaDevice->GetNextPort (AtaDevice, &Port) == EFI_SUCCESS) {
       PortMultiplierPort = 0xFFFF;
 
-      while (TRUE) {
-        Status = AtaDevice->GetNextDevice (AtaDevice, Port, &PortMultiplierPort);
-        if (EFI_ERROR (Status)) {
-          if (Status == EFI_NOT_FOUND) {
-            break;
-          } else {
-            return Status;
-          }
-        }
-
-        ZeroMem (&AtaIdentifyData, sizeof(ATA_IDENTIFY_DATA));
-        Status = GetHddIdentifyData (AtaDevice, Port, PortMultiplierPort, &AtaIdentifyData);
-        if (EFI_ERROR (Status)) {
-          continue;
+      while (AtaDevice->GetNextDevice (AtaDevice, Port, &PortMultiplierPort) == EFI_SUCCESS) {
+        Request = InventoryAllocateIdentifyRequest (Requests, RequestCount, InventoryIdentifyAta);
+        if (Request == NULL) {
+          FreePool (AtaPassThruHandles);
+          return EFI_BUFFER_TOO_SMALL;
         }
 
-        DriveSize = AtaIdentifyData.maximum_lba_for_48bit_addressing[0];
-        ///
-        /// Lower byte goes first: word[100] is the lowest word, word[103] is highest
-        ///
-        for (WordOffset = 1; WordOffset < 4; WordOffset++) {
-          DriveSize |= LShiftU64 (AtaIdentifyData.maximum_lba_for_48bit_addressing[WordOffset], 16 * WordOffset);
-        }
-        DriveSize = MultU64x32 (DriveSize, 512);
-
-        mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].Interface = MEBX_MEDIA_IN_SATA;
-        mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].DevType = MEBX_MEDIA_DT_HDD;
-        SwapEntries ((CHAR8 *) AtaIdentifyData.ModelName, (UINT8)MEDIA_DEVICE_MODEL_NO_MAX_LENGTH);
-        SwapEntries ((CHAR8 *) AtaIdentifyData.SerialNo, (UINT8)MEDIA_DEVICE_SERIAL_NO_MAX_LENGTH);
-        CopyMem (mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SerialNo, AtaIdentifyData.SerialNo, MEDIA_DEVICE_SERIAL_NO_MAX_LENGTH);
-        CopyMem (mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].VersionNo, AtaIdentifyData.FirmwareVer, MEDIA_DEVICE_VERSION_NO_MAX_LENGTH);
-        CopyMem (mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].ModelNo, AtaIdentifyData.ModelName, MEDIA_DEVICE_MODEL_NO_MAX_LENGTH);
-        mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SupportedCmdSets[0] = AtaIdentifyData.command_set_supported_82;
-        mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SupportedCmdSets[1] = AtaIdentifyData.command_set_supported_83;
-        mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SupportedCmdSets[2] = AtaIdentifyData.command_set_feature_extn;
-        mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].MaxMediaSize = DriveSize;
-        (*MediaDeviceCount)++;
-        if ((*MediaDeviceCount) == PCI_MAX_DEVICE + 1) {
-          return EFI_BUFFER_TOO_SMALL;
+        Request->Command[0].Status = GetAtaIdentifyDataFromDiskInfo (
+                                       AtaPassThruHandles[Index],
+                                       AtaDevice,
+                                       Port,
+                                       PortMultiplierPort,
+                                       &Request->AtaData
+                                       );
+        if (EFI_ERROR (Request->Command[0].Status)) {
+          GetHddIdentifyData (AtaDevice, Port, PortMultiplierPort, &Request->AtaData, &Request->Command[0]);
         }
       }
     }
   }
 
-  return Status;
+  FreePool (AtaPassThruHandles);
+  return EFI_SUCCESS;
 }
 
-
 /**
-  Detects all Nvm Express Devices with Nvm Express Pass Thru Protocol installed and adds them to
-  media table.
+  Issues identify requests for all Nvm Express Devices with Nvm Express Pass Thru Protocol installed.
+  Identify Namespace and Identify Controller are issued at the same time for every namespace.
 
-  @param[in]   MediaDeviceCount   A pointer to number of media devices in media table.
+  @param[in, out] Requests        Array of identify requests
+  @param[in, out] RequestCount    Number of identify requests in Requests
 
-  @return EFI_SUCCESS             Successfully added Ata devices into media table.
+  @return EFI_SUCCESS             Identify requests were issued for all Nvme devices.
   @return EFI_BUFFER_TOO_SMALL    Maximum number of media table entries was reached.
-  @return Other                   Failed to add Nvme devices into media table.
+  @return Other                   Failed to locate Nvm Express Pass Thru Protocol.
 **/
 EFI_STATUS
-DetectNvmeDevices (
-  IN OUT UINT8                             *MediaDeviceCount
+StartNvmeIdentifyRequests (
+  IN OUT INVENTORY_IDENTIFY_REQUEST        **Requests,
+  IN OUT UINTN                             *RequestCount
   )
 {
   EFI_STATUS                           Status;
   EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL   *NvmeDevice;
-  NVME_ADMIN_CONTROLLER_DATA           ControllerData;
-  NVME_ADMIN_NAMESPACE_DATA            NamespaceData;
+  INVENTORY_IDENTIFY_REQUEST           *Request;
   UINT32                               NamespaceId;
   UINTN                                HandleNum;
   EFI_HANDLE                           *NvmePassThruHandles;
   UINTN                                Index;
-  UINT64                               DriveSize;
 
   Status = gBS->LocateHandleBuffer (
                   ByProtocol,
@@ -840,57 +1005,190 @@ DetectNvmeDevices (
                     );
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "gBS->Handle Protocol : Status=%r\n", Status));
-      return Status;
+      continue;
     }
 
     NamespaceId = NVME_ALL_NAMESPACES;
 
-    while (TRUE) {
-      Status = NvmeDevice->GetNextNamespace (NvmeDevice, &NamespaceId);
-      if (EFI_ERROR (Status)) {
-        if (Status == EFI_NOT_FOUND) {
-          Status = EFI_SUCCESS;
-          break;
-        } else {
-          return Status;
-        }
+    while (NvmeDevice->GetNextNamespace (NvmeDevice, &NamespaceId) == EFI_SUCCESS) {
+      Request = InventoryAllocateIdentifyRequest (Requests, RequestCount, InventoryIdentifyNvme);
+      if (Request == NULL) {
+        FreePool (NvmePassThruHandles);
+        return EFI_BUFFER_TOO_SMALL;
       }
-      ZeroMem (&ControllerData, sizeof(NVME_ADMIN_CONTROLLER_DATA));
-      ZeroMem (&NamespaceData, sizeof(NVME_ADMIN_NAMESPACE_DATA));
-      Status = NvmeIdentifyCommand (NvmeDevice, NamespaceId, NVME_IDENTIFY_NAMESPACE_STRUCT, (VOID *) &NamespaceData);
-      if (EFI_ERROR (Status)) {
+      Request->NvmeDevice = NvmeDevice;
+      NvmeIdentifyCommand (NvmeDevice, NamespaceId, NVME_IDENTIFY_NAMESPACE_STRUCT, &Request->NamespaceData, &Request->Command[0]);
+      NvmeIdentifyCommand (NvmeDevice, NamespaceId, NVME_IDENTIFY_CONTROLLER_STRUCT, &Request->ControllerData, &Request->Command[1]);
+    }
+  }
+
+  FreePool (NvmePassThruHandles);
+  return EFI_SUCCESS;
+}
+
+/**
+  Waits until all outstanding identify commands have completed.
+
+  @param[in, out] Requests        Array of identify requests
+  @param[in]      RequestCount    Number of identify requests in Requests
+**/
+VOID
+WaitIdentifyRequests (
+  IN OUT INVENTORY_IDENTIFY_REQUEST        **Requests,
+  IN     UINTN                             RequestCount
+  )
+{
+  INVENTORY_IDENTIFY_REQUEST           *Request;
+  UINTN                                Index;
+  UINTN                                Elapsed;
+  BOOLEAN                              Pending;
+
+  for (Elapsed = 0; ; Elapsed += INVENTORY_IDENTIFY_POLL_INTERVAL) {
+    Pending = FALSE;
+    for (Index = 0; Index < RequestCount; Index++) {
+      Request = Requests[Index];
+      if (InventoryIdentifyCommandPending (Request->Type, &Request->Command[0])) {
+        Pending = TRUE;
+      }
+      if (Request->Type != InventoryIdentifyNvme) {
+        continue;
+      }
+      if (InventoryIdentifyCommandPending (Request->Type, &Request->Command[1])) {
+        Pending = TRUE;
         continue;
       }
-      DriveSize = MultU64x32 (NamespaceData.Ncap, 512);
       //
       // Due to the fact that RAID Driver expects other value of NamespaceId parameter than AHCI driver,
-      // need to send the Identify Controller command twice - once with the NamespaceId retrieved
-      // using GetNextNamespace. If it fails we need to set NamespaceId = 0.
+      // the Identify Controller command is sent with the NamespaceId retrieved using GetNextNamespace first.
+      // If it fails it is sent once again with NamespaceId = 0.
       //
-      Status = NvmeIdentifyCommand (NvmeDevice, NamespaceId, NVME_IDENTIFY_CONTROLLER_STRUCT, (VOID *) &ControllerData);
-      if (EFI_ERROR (Status)) {
+      if (EFI_ERROR (Request->Command[1].Status) && !Request->ControllerIdRetried) {
         DEBUG ((DEBUG_WARN, "NvmeIdentifyCommand Error. Sending Identify Command once again\n"));
-        Status = NvmeIdentifyCommand (NvmeDevice, NVME_CONTROLLER_ID, NVME_IDENTIFY_CONTROLLER_STRUCT, (VOID *) &ControllerData);
-        if (EFI_ERROR (Status)) {
-          continue;
+        Request->ControllerIdRetried = TRUE;
+        NvmeIdentifyCommand (Request->NvmeDevice, NVME_CONTROLLER_ID, NVME_IDENTIFY_CONTROLLER_STRUCT, &Request->ControllerData, &Request->Command[1]);
+        if (Request->Command[1].Event != NULL) {
+          Pending = TRUE;
         }
       }
-      mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].Interface = MEBX_MEDIA_IN_PCIE;
-      mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].DevType   = MEBX_MEDIA_DT_HDD;
-      CopyMem (mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].ModelNo, ControllerData.Mn, MEDIA_DEVICE_MODEL_NO_MAX_LENGTH);
-      CopyMem (mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SerialNo,ControllerData.Sn, MEDIA_DEVICE_SERIAL_NO_MAX_LENGTH);
-      CopyMem (mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].VersionNo, ControllerData.Fr, MEDIA_DEVICE_VERSION_NO_MAX_LENGTH);
-      mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SupportedCmdSets[0] = ControllerData.Oacs;
-      mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].SupportedCmdSets[1] = ControllerData.Oncs;
-      mAmtMediaFru.MediaDevInfo[*MediaDeviceCount].MaxMediaSize = DriveSize;
-      (*MediaDeviceCount)++;
-      if ((*MediaDeviceCount) == PCI_MAX_DEVICE + 1) {
-        return EFI_BUFFER_TOO_SMALL;
-      }
     }
+
+    if (!Pending) {
+      return;
+    }
+    if (Elapsed >= INVENTORY_IDENTIFY_TIMEOUT) {
+      DEBUG ((DEBUG_ERROR, "Media inventory: identify commands timed out\n"));
+      return;
+    }
+    MicroSecondDelay (INVENTORY_IDENTIFY_POLL_INTERVAL);
   }
+}
 
-  return Status;
+/**
+  Adds a successfully identified device to media table.
+
+  @param[in]      Request         Completed identify request
+  @param[in, out] MediaDeviceCount A pointer to number of media devices in media table.
+**/
+VOID
+AddIdentifiedMedia (
+  IN     INVENTORY_IDENTIFY_REQUEST        *Request,
+  IN OUT UINT8                             *MediaDeviceCount
+  )
+{
+  MEBX_FRU_MEDIA_DEVICES               *MediaDevInfo;
+  ATA_IDENTIFY_DATA                    *AtaIdentifyData;
+  UINTN                                WordOffset;
+  UINT64                               DriveSize;
+
+  if (EFI_ERROR (Request->Command[0].Status) ||
+      ((Request->Type == InventoryIdentifyNvme) && EFI_ERROR (Request->Command[1].Status))) {
+    return;
+  }
+
+  MediaDevInfo = &mAmtMediaFru.MediaDevInfo[*MediaDeviceCount];
+  ZeroMem (MediaDevInfo, sizeof (MEBX_FRU_MEDIA_DEVICES));
+  MediaDevInfo->StructSize = sizeof (MEBX_FRU_MEDIA_DEVICES);
+
+  if (Request->Type == InventoryIdentifyAta) {
+    AtaIdentifyData = &Request->AtaData;
+    DriveSize = AtaIdentifyData->maximum_lba_for_48bit_addressing[0];
+    ///
+    /// Lower byte goes first: word[100] is the lowest word, word[103] is highest
+    ///
+    for (WordOffset = 1; WordOffset < 4; WordOffset++) {
+      DriveSize |= LShiftU64 (AtaIdentifyData->maximum_lba_for_48bit_addressing[WordOffset], 16 * WordOffset);
+    }
+    DriveSize = MultU64x32 (DriveSize, 512);
+
+    MediaDevInfo->Interface = MEBX_MEDIA_IN_SATA;
+    MediaDevInfo->DevType   = MEBX_MEDIA_DT_HDD;
+    SwapEntries ((CHAR8 *) AtaIdentifyData->ModelName, (UINT8)MEDIA_DEVICE_MODEL_NO_MAX_LENGTH);
+    SwapEntries ((CHAR8 *) AtaIdentifyData->SerialNo, (UINT8)MEDIA_DEVICE_SERIAL_NO_MAX_LENGTH);
+    CopyMem (MediaDevInfo->SerialNo, AtaIdentifyData->SerialNo, MEDIA_DEVICE_SERIAL_NO_MAX_LENGTH);
+    CopyMem (MediaDevInfo->VersionNo, AtaIdentifyData->FirmwareVer, MEDIA_DEVICE_VERSION_NO_MAX_LENGTH);
+    CopyMem (MediaDevInfo->ModelNo, AtaIdentifyData->ModelName, MEDIA_DEVICE_MODEL_NO_MAX_LENGTH);
+    MediaDevInfo->SupportedCmdSets[0] = AtaIdentifyData->command_set_supported_82;
+    MediaDevInfo->SupportedCmdSets[1] = AtaIdentifyData->command_set_supported_83;
+    MediaDevInfo->SupportedCmdSets[2] = AtaIdentifyData->command_set_feature_extn;
+    MediaDevInfo->MaxMediaSize        = DriveSize;
+  } else {
+    MediaDevInfo->Interface = MEBX_MEDIA_IN_PCIE;
+    MediaDevInfo->DevType   = MEBX_MEDIA_DT_HDD;
+    CopyMem (MediaDevInfo->ModelNo, Request->ControllerData.Mn, MEDIA_DEVICE_MODEL_NO_MAX_LENGTH);
+    CopyMem (MediaDevInfo->SerialNo, Request->ControllerData.Sn, MEDIA_DEVICE_SERIAL_NO_MAX_LENGTH);
+    CopyMem (MediaDevInfo->VersionNo, Request->ControllerData.Fr, MEDIA_DEVICE_VERSION_NO_MAX_LENGTH);
+    MediaDevInfo->SupportedCmdSets[0] = Request->ControllerData.Oacs;
+    MediaDevInfo->SupportedCmdSets[1] = Request->ControllerData.Oncs;
+    MediaDevInfo->MaxMediaSize        = MultU64x32 (Request->NamespaceData.Ncap, 512);
+  }
+
+  (*MediaDeviceCount)++;
+}
+
+/**
+  Identifies all Ata and Nvm Express Devices with Pass Thru Protocol installed and adds them to
+  media table. Identify commands are issued to all devices first and collected afterwards,
+  so devices on different controllers are identified in parallel.
+
+  @param[in, out] MediaDeviceCount A pointer to number of media devices in media table.
+
+  @return EFI_SUCCESS             Successfully added devices into media table.
+  @return EFI_BUFFER_TOO_SMALL    Maximum number of media table entries was reached.
+**/
+EFI_STATUS
+DetectPassThruDevices (
+  IN OUT UINT8                             *MediaDeviceCount
+  )
+{
+  EFI_STATUS                           Status;
+  INVENTORY_IDENTIFY_REQUEST           *Requests[PCI_MAX_DEVICE + 1];
+  UINTN                                RequestCount;
+  UINTN                                Index;
+
+  RequestCount = 0;
+
+  Status = StartAtaIdentifyRequests (Requests, &RequestCount);
+  if (Status != EFI_BUFFER_TOO_SMALL) {
+    Status = StartNvmeIdentifyRequests (Requests, &RequestCount);
+  }
+
+  WaitIdentifyRequests (Requests, RequestCount);
+
+  for (Index = 0; Index < RequestCount; Index++) {
+    AddIdentifiedMedia (Requests[Index], MediaDeviceCount);
+    ///
+    /// Buffers of commands that timed out may still be written by the controller, leave them allocated
+    ///
+    if ((Requests[Index]->Command[0].Event == NULL) &&
+        (Requests[Index]->Command[1].Event == NULL)) {
+      FreePool (Requests[Index]);
+    }
+  }
+
+  if ((Status == EFI_BUFFER_TOO_SMALL) || ((*MediaDeviceCount) == PCI_MAX_DEVICE + 1)) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  return EFI_SUCCESS;
 }
 
 /**
@@ -943,12 +1241,7 @@ BuildMediaList (
 
   MediaDeviceCount  = 0;
 
-  Status = DetectAtaDevices (&MediaDeviceCount);
-  if (Status == EFI_BUFFER_TOO_SMALL) {
-    return;
-  }
-
-  Status = DetectNvmeDevices (&MediaDeviceCount);
+  Status = DetectPassThruDevices (&MediaDeviceCount);
   if (Status == EFI_BUFFER_TOO_SMALL) {
     return;
   }
@@ -282,6 +282,55 @@ typedef struct {
   UINT8  VendorData[1024];    /* Vendor specific data */
 } NVME_ADMIN_CONTROLLER_DATA;
 
+///
+/// Status Field (SCT and SC) of the NVMe completion queue entry Dword 3
+///
+#define NVME_CQE_STATUS(Dw3)            (((Dw3) >> 17) & 0x7FF)
+
+#define INVENTORY_IDENTIFY_POLL_INTERVAL  100                         ///< us
+#define INVENTORY_IDENTIFY_TIMEOUT        (2 * NVME_GENERIC_TIMEOUT)  ///< us, covers the NVMe controller identify retry
+
+typedef enum {
+  InventoryIdentifyAta,
+  InventoryIdentifyNvme
+} INVENTORY_IDENTIFY_TYPE;
+
+///
+/// Identify command issued through a pass thru protocol.
+/// Non-blocking commands are outstanding while Event is not NULL; Status is EFI_NOT_READY until
+/// completion is collected and never EFI_NOT_READY once the command has finished.
+///
+typedef struct {
+  EFI_EVENT                                   Event;
+  EFI_STATUS                                  Status;
+  union {
+    struct {
+      EFI_ATA_PASS_THRU_COMMAND_PACKET        Packet;
+      EFI_ATA_COMMAND_BLOCK                   Acb;
+      EFI_ATA_STATUS_BLOCK                    Asb;
+    } Ata;
+    struct {
+      EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET Packet;
+      EFI_NVM_EXPRESS_COMMAND                 Command;
+      EFI_NVM_EXPRESS_COMPLETION              Completion;
+    } Nvme;
+  } Cmd;
+} INVENTORY_IDENTIFY_COMMAND;
+
+///
+/// Identify request for one media device: an ATA device uses Command[0] for IDENTIFY DEVICE,
+/// an NVMe namespace uses Command[0] for Identify Namespace and Command[1] for Identify Controller.
+///
+typedef struct {
+  INVENTORY_IDENTIFY_TYPE                     Type;
+  EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL          *NvmeDevice;
+  BOOLEAN                                     ControllerIdRetried;
+  INVENTORY_IDENTIFY_COMMAND                  Command[2];
+  ATA_IDENTIFY_DATA                           AtaData;
+  NVME_ADMIN_NAMESPACE_DATA                   NamespaceData;
+  NVME_ADMIN_CONTROLLER_DATA                  ControllerData;
+} INVENTORY_IDENTIFY_REQUEST;
+
 /**
   AMT only need to know removable PCI device information.
 
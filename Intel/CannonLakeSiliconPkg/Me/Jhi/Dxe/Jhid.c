@@ -67,8 +67,15 @@ SESSION_GUID_LIST {
   {TRUE, {0xc0223910, 0x52e3, 0x46ee, {0xa6, 0x9e, 0x74, 0xb1, 0x1d, 0x35, 0x49, 0xa8}}},
   {TRUE, {0x3c1189ae, 0xdc86, 0x4d50, {0x85, 0xdd, 0x25, 0xc0, 0x0b, 0x76, 0xda, 0xb2}}},
 };
+#define JHI_SESSION_HANDLE_MAX  (sizeof (SessionGuidList) / sizeof (SessionGuidList[0]))
 STATIC
 UINTN mSessionGuidIndex = 0;
+///
+/// Session handles are owned by the slot of SessionGuidList they use, so a session
+/// handle is validated by address instead of walking the applet session list.
+///
+STATIC
+JHI_I_SESSION_HANDLE mSessionHandleSlab [JHI_SESSION_HANDLE_MAX];
 STATIC
 JHI_I_HANDLE *mAppHandle = NULL;  // a handle that is passed by the application when calling any jhi API function.
 
@@ -246,19 +253,16 @@ SessionHandleCreate (
     return NULL;
   }
 
-  JhiSessionHandle = (JHI_I_SESSION_HANDLE *) AllocateZeroPool (sizeof (JHI_I_SESSION_HANDLE));
-  if (JhiSessionHandle == NULL) {
-    DEBUG_JHI_DRIVER ((DEBUG_ERROR, "SessionHandleCreate fail, insufficient memory for JHI_I_SESSION_HANDLE.\n"));
-    return NULL;
-  }
-
-  JhiSessionHandle->Signature = JHI_SESSION_HANDLE_INSTANCE_SIGNATURE;
-  JhiSessionHandle->JhiAppletHandle = JhiAppletHandle;
   GuidListIndex = SessionGuidCreate ();
   if (GuidListIndex == (UINTN) (-1)) {
     DEBUG_JHI_DRIVER ((DEBUG_ERROR, "SessionHandleCreate fail, no free Session Guid available.\n"));
     return NULL;
   }
+
+  JhiSessionHandle = &mSessionHandleSlab [GuidListIndex];
+  ZeroMem (JhiSessionHandle, sizeof (JHI_I_SESSION_HANDLE));
+  JhiSessionHandle->Signature = JHI_SESSION_HANDLE_INSTANCE_SIGNATURE;
+  JhiSessionHandle->JhiAppletHandle = JhiAppletHandle;
   JhiSessionHandle->GuidListIndex = GuidListIndex;
   SessionGuidList [GuidListIndex].Free = FALSE;
   CopyMem (JhiSessionHandle->SessionID, &SessionGuidList [GuidListIndex].Guid, sizeof (GUID));  //  UuidCreate (JhiSessionHandle->SessionID);
@@ -295,7 +299,8 @@ SessionHandleDestroy (
 
   SessionGuidDestroy (JhiSessionHandle->GuidListIndex);
   RemoveEntryList (&JhiSessionHandle->Link);
-  FreePool (JhiSessionHandle);
+  JhiSessionHandle->Signature = 0;
+  JhiSessionHandle->JhiAppletHandle = NULL;
 
   DEBUG_JHI_DRIVER_VERBOSE ((DEBUG_INFO, "SessionHandleDestroy done\n"));
   return TRUE;
@@ -315,9 +320,8 @@ SessionHandleValid (
   IN JHI_I_SESSION_HANDLE* JhiSessionHandle
   )
 {
-  LIST_ENTRY            *Link;
-  JHI_I_APPLET_HANDLE *JhiAppletHandle;
-  JHI_I_SESSION_HANDLE *Session;
+  UINTN   Offset;
+  UINTN   Index;
   BOOLEAN Valid = FALSE;
 
   DEBUG_JHI_DRIVER_VERBOSE ((DEBUG_INFO, "SessionHandleValid\n"));
@@ -327,37 +331,61 @@ SessionHandleValid (
     return FALSE;
   }
 
+  ///
+  /// Only handles that point at the start of a slab entry can be live sessions.
+  ///
+  if ((JhiSessionHandle < &mSessionHandleSlab [0]) ||
+      (JhiSessionHandle >= &mSessionHandleSlab [JHI_SESSION_HANDLE_MAX])) {
+    DEBUG_JHI_DRIVER ((DEBUG_ERROR, "SessionHandleValid fail, handle out of range.\n"));
+    return FALSE;
+  }
+  Offset = (UINTN) JhiSessionHandle - (UINTN) &mSessionHandleSlab [0];
+  if ((Offset % sizeof (JHI_I_SESSION_HANDLE)) != 0) {
+    DEBUG_JHI_DRIVER ((DEBUG_ERROR, "SessionHandleValid fail, handle misaligned.\n"));
+    return FALSE;
+  }
+  Index = Offset / sizeof (JHI_I_SESSION_HANDLE);
+
   if (JhiSessionHandle->Signature != JHI_SESSION_HANDLE_INSTANCE_SIGNATURE) {
     DEBUG_JHI_DRIVER ((DEBUG_ERROR, "SessionHandleValid fail, Signature mismatch(%08x != %08x)!\n",
                        JhiSessionHandle->Signature, JHI_SESSION_HANDLE_INSTANCE_SIGNATURE));
     return FALSE;
   }
 
-  JhiAppletHandle = JhiSessionHandle->JhiAppletHandle;
-  if (JhiAppletHandle == NULL) {
-    return FALSE;
-  }
-
-  for (
-        Link = GetFirstNode (&JhiAppletHandle->SessionListHead);
-        !IsNull (&JhiAppletHandle->SessionListHead, Link);
-        Link = GetNextNode (&JhiAppletHandle->SessionListHead, Link)) {
-    Session = CR (
-                Link,
-                JHI_I_SESSION_HANDLE,
-                Link,
-                JHI_SESSION_HANDLE_INSTANCE_SIGNATURE
-                );
-    if (Session == JhiSessionHandle) {
-      Valid = TRUE;
-      break;
-    }
+  if ((JhiSessionHandle->JhiAppletHandle != NULL) &&
+      (JhiSessionHandle->GuidListIndex == Index) &&
+      (SessionGuidList [Index].Free == FALSE)) {
+    Valid = TRUE;
   }
 
   DEBUG_JHI_DRIVER_VERBOSE ((DEBUG_INFO, "SessionHandleValid done, Valid: %x\n", Valid));
   return Valid;
 }
 
+/**
+  Get the hash bucket index of an AppId
+
+  @param[in]  UcAppId             The AppId (Upper case).
+
+  @retval                         The index into JHI_I_HANDLE.AppletHashTable.
+**/
+STATIC
+UINTN
+AppletHandleHash (
+  IN CONST APPID_STR UcAppId
+  )
+{
+  UINTN Hash;
+  UINTN i;
+
+  Hash = 0;
+  for (i = 0; i < APPID_STR_LENGTH; i++) {
+    Hash = (Hash * 31) + (UINT8) UcAppId[i];
+  }
+
+  return Hash & (JHI_APPLET_HASH_SIZE - 1);
+}
+
 /**
   Create applet handle
 
@@ -408,6 +436,7 @@ AppletHandleCreate (
   }
 
   InsertTailList (&mAppHandle->AppletHandleListHead, &JhiAppletHandle->Link);
+  InsertTailList (&mAppHandle->AppletHashTable[AppletHandleHash (UcAppId)], &JhiAppletHandle->HashLink);
 
   DEBUG_JHI_DRIVER_VERBOSE ((DEBUG_INFO, "AppletHandleCreate done\n"));
   return JhiAppletHandle;
@@ -447,6 +476,7 @@ AppletHandleDestroy (
   }
 
   RemoveEntryList (&JhiAppletHandle->Link);
+  RemoveEntryList (&JhiAppletHandle->HashLink);
   if (JhiAppletHandle->AppletFilepath) {
     FreePool (JhiAppletHandle->AppletFilepath);
   }
@@ -469,6 +499,7 @@ AppletHandleFind (
   IN APPID_STR UcAppId
   )
 {
+  LIST_ENTRY            *Bucket;
   LIST_ENTRY            *Link;
   JHI_I_APPLET_HANDLE *JhiAppletHandle;
 
@@ -479,14 +510,15 @@ AppletHandleFind (
     return NULL;
   }
 
+  Bucket = &mAppHandle->AppletHashTable[AppletHandleHash (UcAppId)];
   for (
-        Link = GetFirstNode (&mAppHandle->AppletHandleListHead);
-        !IsNull (&mAppHandle->AppletHandleListHead, Link);
-        Link = GetNextNode (&mAppHandle->AppletHandleListHead, Link)) {
+        Link = GetFirstNode (Bucket);
+        !IsNull (Bucket, Link);
+        Link = GetNextNode (Bucket, Link)) {
     JhiAppletHandle = CR (
                         Link,
                         JHI_I_APPLET_HANDLE,
-                        Link,
+                        HashLink,
                         JHI_APPLET_HANDLE_INSTANCE_SIGNATURE
                         );
     DbgRawdataDump (JhiAppletHandle->UcAppId, sizeof (APPID_STR));
@@ -620,6 +652,7 @@ JhidCleanUp ()
     }
 
     RemoveEntryList (&JhiAppletHandle->Link);
+    RemoveEntryList (&JhiAppletHandle->HashLink);
     if (JhiAppletHandle->AppletFilepath) {
       FreePool (JhiAppletHandle->AppletFilepath);
     }
@@ -647,6 +680,7 @@ JhidInitialize (
   )
 {
   JHI_RET         rc;
+  UINTN           Index;
 
   DEBUG_JHI_DRIVER ((DEBUG_INFO, "JhidInitialize\n"));
   DEBUG_JHI_DRIVER_VERBOSE ((DEBUG_INFO, "PS: Context and Flags will be ignored\n"));
@@ -681,6 +715,9 @@ JhidInitialize (
   mAppHandle->State = INITALIZED;
   mAppHandle->ReferenceCount = 1;
   InitializeListHead (&mAppHandle->AppletHandleListHead);
+  for (Index = 0; Index < JHI_APPLET_HASH_SIZE; Index++) {
+    InitializeListHead (&mAppHandle->AppletHashTable[Index]);
+  }
 
   rc = JhisInit (mAppHandle);
   DEBUG_JHI_DRIVER_VERBOSE ((DEBUG_INFO, "JhisInit rc: %x\n", rc));
@@ -52,9 +52,11 @@ typedef enum {
 /// JHI internal handle, this is the instance of JHI_HANDLE.
 ///
 #define JHI_HANDLE_INSTANCE_SIGNATURE   SIGNATURE_32 ('j', 'i', 'h', '-')
+#define JHI_APPLET_HASH_SIZE            16    ///< Number of applet hash buckets, must be power of 2
 typedef struct _JHI_I_HANDLE {
   UINT32                Signature;
   LIST_ENTRY            AppletHandleListHead; ///< The list header for all installed applets
+  LIST_ENTRY            AppletHashTable[JHI_APPLET_HASH_SIZE]; ///< Installed applets hashed by UcAppId
   JHI_STATE             State;
   UINT32                ReferenceCount;
   JHI_VERSION_INFO      VersionInfo;
@@ -67,6 +69,7 @@ typedef struct _JHI_I_HANDLE {
 typedef struct _JHI_I_APPLET_HANDLE {
   UINT32                Signature;
   LIST_ENTRY            Link;
+  LIST_ENTRY            HashLink;           ///< Link in JHI_I_HANDLE.AppletHashTable
   LIST_ENTRY            SessionListHead;    ///< The list header for all opened sessions
   JHI_I_HANDLE          *JhiHandleInstance; ///< link back to JHI handle instance
   APPID_STR             UcAppId;            ///< Upper case AppId string
@@ -55,7 +55,8 @@
 typedef BH_U64            ADDR;
 typedef struct _RR_MAP_INFO {
   UINT32                  Signature;
-  LIST_ENTRY              Link;
+  LIST_ENTRY              Link;       // link in rr_map_list_header, or in the slab free list
+  LIST_ENTRY              HashLink;   // link in rr_map_hash[RR_MAP_HASH (seq)]
   ADDR                    seq;
   bh_response_record      *rr;
 } RR_MAP_INFO;
@@ -79,6 +80,9 @@ void session_kill (int conn_idx, bh_response_record* session, BH_U64 seq, int ca
 static volatile unsigned int init_state = DEINITED;
 static BH_U32 g_seqno = 0;
 static bh_connection_item connections[MAX_CONNECTIONS]; //slot 0 is reserved
+static RR_MAP_INFO rrmap_slab[RR_MAP_SLAB_SIZE];         //preallocated rr map entries
+static LIST_ENTRY rrmap_free_list;                       //free entries of rrmap_slab
+static BOOLEAN rrmap_slab_inited = FALSE;
 static BHP_TRANSPORT bhp_tx_itf = { //transport func list, set during init
   HeciSendWrapper,    // pfnSend
   HeciRecvWrapper,    // pfnRecv
@@ -199,6 +203,66 @@ int HeciCloseWrapper (unsigned int handle)
 }
 
 
+/*
+ * function rrmap_info_alloc():
+ *   take an rr map entry from the slab free list, or from pool when the slab
+ *   is exhausted. Every message sent allocates one entry, so keeping them in a
+ *   slab avoids a pool allocation per message during DAL traffic bursts.
+ */
+static RR_MAP_INFO*
+rrmap_info_alloc (
+  VOID
+  )
+{
+  RR_MAP_INFO           *rrmap_info;
+  UINTN                 Index;
+
+  if (!rrmap_slab_inited) {
+    InitializeListHead (&rrmap_free_list);
+    for (Index = 0; Index < RR_MAP_SLAB_SIZE; Index++) {
+      InsertTailList (&rrmap_free_list, &rrmap_slab[Index].Link);
+    }
+    rrmap_slab_inited = TRUE;
+  }
+
+  if (!IsListEmpty (&rrmap_free_list)) {
+    rrmap_info = BASE_CR (rrmap_free_list.ForwardLink, RR_MAP_INFO, Link);
+    RemoveEntryList (&rrmap_info->Link);
+    ZeroMem (rrmap_info, sizeof (RR_MAP_INFO));
+    return rrmap_info;
+  }
+
+  DEBUG_BEIHAI_LIB_VERBOSE ((DEBUG_INFO, "rrmap_info_alloc: slab exhausted, use pool\n"));
+  return AllocateZeroPool (sizeof (RR_MAP_INFO));
+}
+
+/*
+ * function rrmap_info_free():
+ *   return an rr map entry to the slab free list, or to pool if it did not
+ *   come from the slab. The entry must already be unlinked from its connection.
+ */
+static VOID
+rrmap_info_free (RR_MAP_INFO *rrmap_info)
+{
+  rrmap_info->Signature = 0;
+  if ((rrmap_info >= &rrmap_slab[0]) && (rrmap_info < &rrmap_slab[RR_MAP_SLAB_SIZE])) {
+    InsertTailList (&rrmap_free_list, &rrmap_info->Link);
+  } else {
+    FreePool (rrmap_info);
+  }
+}
+
+static VOID
+rrmap_init (int conn_idx)
+{
+  UINTN                 Index;
+
+  InitializeListHead (&connections[conn_idx].rr_map_list_header);
+  for (Index = 0; Index < RR_MAP_HASH_SIZE; Index++) {
+    InitializeListHead (&connections[conn_idx].rr_map_hash[Index]);
+  }
+}
+
 static VOID
 rrmap_dump (LIST_ENTRY *rr_map_header)
 {
@@ -225,19 +289,22 @@ rrmap_dump (LIST_ENTRY *rr_map_header)
 }
 
 static RR_MAP_INFO*
-rrmap_find_by_addr (LIST_ENTRY *rr_map_header, ADDR seq)
+rrmap_find_by_addr (int conn_idx, ADDR seq)
 {
+  LIST_ENTRY            *Bucket;
   LIST_ENTRY            *Link;
   RR_MAP_INFO           *rrmap_info;
 
+  //seq numbers are handed out sequentially, so the low bits spread them evenly over the buckets
+  Bucket = &connections[conn_idx].rr_map_hash[RR_MAP_HASH (seq)];
   for (
-        Link = GetFirstNode (rr_map_header);
-        !IsNull (rr_map_header, Link);
-        Link = GetNextNode (rr_map_header, Link)) {
+        Link = GetFirstNode (Bucket);
+        !IsNull (Bucket, Link);
+        Link = GetNextNode (Bucket, Link)) {
     rrmap_info = CR (
                    Link,
                    RR_MAP_INFO,
-                   Link,
+                   HashLink,
                    RR_MAP_INFO_SIGNATURE
                    );
     if (rrmap_info->seq == seq) {
@@ -282,18 +349,20 @@ BH_U64 rrmap_add (int conn_idx, bh_response_record* rr)
   RR_MAP_INFO *rrmap_info;
 
   mutex_enter (bhm_rrmap);
-  rrmap_info = AllocateZeroPool (sizeof (RR_MAP_INFO));
+  rrmap_info = rrmap_info_alloc ();
   if (rrmap_info) {
     rrmap_info->Signature = RR_MAP_INFO_SIGNATURE;
     rrmap_info->seq = seq;
     rrmap_info->rr = rr;
     InsertTailList (&connections[conn_idx].rr_map_list_header, &rrmap_info->Link);
+    InsertTailList (&connections[conn_idx].rr_map_hash[RR_MAP_HASH (seq)], &rrmap_info->HashLink);
     mutex_exit (bhm_rrmap);
     DEBUG_BEIHAI_LIB_VERBOSE ((DEBUG_INFO, "rrmap_add (rr: %x) at seq: %x\n", rr, rrmap_info->seq));
     rrmap_dump (&connections[conn_idx].rr_map_list_header);
 
     return rrmap_info->seq;
   }
+  mutex_exit (bhm_rrmap);
   return (BH_U64)(-1);
 }
 
@@ -304,12 +373,13 @@ static bh_response_record* rrmap_remove (int conn_idx, BH_U64 seq)
 
   DEBUG_BEIHAI_LIB_VERBOSE ((DEBUG_INFO, "rrmap_remove (seq: %x)\n", seq));
   mutex_enter (bhm_rrmap);
-  rrmap_info = rrmap_find_by_addr (&connections[conn_idx].rr_map_list_header, seq);
+  rrmap_info = rrmap_find_by_addr (conn_idx, seq);
   if (rrmap_info != NULL) {
     rr = rrmap_info->rr;
     if (!rr->is_session) {
       RemoveEntryList (&rrmap_info->Link);
-      FreePool (rrmap_info);
+      RemoveEntryList (&rrmap_info->HashLink);
+      rrmap_info_free (rrmap_info);
     }
   }
   mutex_exit (bhm_rrmap);
@@ -323,7 +393,7 @@ static bh_response_record* addr2record (int conn_idx, BH_U64 seq)
   bh_response_record* rr = NULL;
   RR_MAP_INFO *rrmap_info;
 
-  rrmap_info = rrmap_find_by_addr (&connections[conn_idx].rr_map_list_header, seq);
+  rrmap_info = rrmap_find_by_addr (conn_idx, seq);
   if (rrmap_info != NULL) {
     rr = rrmap_info->rr;
   }
@@ -348,7 +418,7 @@ bh_response_record* session_enter (int conn_idx, BH_U64 seq, int lock_session)
   RR_MAP_INFO *rrmap_info;
 
   mutex_enter (connections[conn_idx].bhm_rrmap);
-  rrmap_info = rrmap_find_by_addr (&connections[conn_idx].rr_map_list_header, seq);
+  rrmap_info = rrmap_find_by_addr (conn_idx, seq);
   if (rrmap_info) {
     if (rrmap_info->rr->is_session &&
         !rrmap_info->rr->killed) {
@@ -806,7 +876,7 @@ static BH_RET bh_do_connect (int conn_idx)
   DEBUG_BEIHAI_LIB_VERBOSE ((DEBUG_INFO, "bh_do_connect(%x)\n", conn_idx));
   connections[conn_idx].handle = 0;
   connections[conn_idx].conn_count = 0;
-  InitializeListHead (&connections[conn_idx].rr_map_list_header);
+  rrmap_init (conn_idx);
 
   ZeroMem (&connections[conn_idx].sdid, sizeof (BH_SDID));
 
@@ -851,10 +921,11 @@ static BH_RET bh_do_disconnect (int conn_idx)
                    RR_MAP_INFO_SIGNATURE
                    );
     RemoveEntryList (&rrmap_info->Link);
-    FreePool (rrmap_info);
+    RemoveEntryList (&rrmap_info->HashLink);
+    rrmap_info_free (rrmap_info);
   }
 
-  InitializeListHead (&connections[conn_idx].rr_map_list_header);
+  rrmap_init (conn_idx);
   ZeroMem (&connections[conn_idx].sdid,sizeof (BH_SDID));
 
   return ret;
@@ -870,7 +941,7 @@ static BH_RET bh_connections_init (void)
   for (i=CONN_IDX_START;i<MAX_CONNECTIONS;i++) {
     connections[i].conn_count = 0;
     connections[i].handle = 0;
-    InitializeListHead (&connections[i].rr_map_list_header);
+    rrmap_init (i);
   }
 
   for (i=CONN_IDX_START; i<CONN_IDX_SVM; i++) {
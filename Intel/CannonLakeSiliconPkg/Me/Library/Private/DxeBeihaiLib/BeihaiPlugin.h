@@ -57,9 +57,17 @@ typedef struct {
   unsigned int count;   //the count of users who are using this session, valid only for is_session is 1
 } bh_response_record;
 
+//number of sequence number hash buckets per connection, must be power of 2
+#define RR_MAP_HASH_SIZE  32
+#define RR_MAP_HASH(seq)  ((unsigned int)(seq) & (RR_MAP_HASH_SIZE - 1))
+
+//number of response record map entries preallocated for all connections
+#define RR_MAP_SLAB_SIZE  64
+
 typedef struct {
   volatile unsigned int handle;       //physical connection handle
   LIST_ENTRY rr_map_list_header;
+  LIST_ENTRY rr_map_hash[RR_MAP_HASH_SIZE]; //rr map entries hashed by seq
   volatile unsigned int conn_count;   //VM connection counter, only valid for VM
   BH_SDID sdid;                       //the sd id it serves, only valid for VM
 } bh_connection_item;
@@ -43,6 +43,7 @@
 #include <Library/TimerLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MeShowBufferLib.h>
+#include <Library/TraceEventLib.h>
 #include <IndustryStandard/Pci22.h>
 #include "HeciCore.h"
 #include "HeciHpet.h"
@@ -938,6 +939,7 @@ HeciReceive (
   }
 
   *Length = TotalLength;
+  TRACE_EVENT3 (TRACE_EVENT_HECI_RECEIVE, HeciDev, TotalLength, Status);
 
   return Status;
 }
@@ -1077,6 +1079,7 @@ HeciSend (
   if (WaitForMEReady (HeciDev) != EFI_SUCCESS) {
     return EFI_TIMEOUT;
   }
+  TRACE_EVENT3 (TRACE_EVENT_HECI_SEND, HeciDev, MeAddress, Length);
   ///
   /// Set up memory mapped registers
   ///
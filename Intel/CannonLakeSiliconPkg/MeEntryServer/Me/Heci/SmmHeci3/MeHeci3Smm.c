@@ -50,6 +50,7 @@
 /*****************************************************************************
  * Local definitions.
  *****************************************************************************/
+#define HECI_QUEUE_RESET_RESERVE  5  // ms of the batch timeout kept for the final queue reset
 
 
 /*****************************************************************************
@@ -68,6 +69,11 @@ EFI_STATUS EFIAPI SmmHeciRequest(IN OUT SMM_ME_HECI3_PROTOCOL *pThis,
                                  IN     HECI_MSG_HEADER       *pReqMsg,
                                     OUT HECI_MSG_HEADER       *pRspBuf,
                                  IN     UINT32                *pBufLen);
+EFI_STATUS EFIAPI SmmHeciRequestQueue(IN     SMM_ME_HECI3_PROTOCOL    *pThis,
+                                      IN OUT UINT32                   *pTimeout,
+                                      IN OUT SMM_ME_HECI3_QUEUE_ENTRY *pQueue,
+                                      IN     UINT32                   QueueLen,
+                                      IN OUT UINT32                   *pDone);
 UINT64 HeciMbarReadFull (IN OUT ME_HECI_DEVICE *pThis,
                          IN     BOOLEAN        CleanBarTypeBits);
 VOID   SetHeciMbar (IN UINT64        HeciMBarIn,
@@ -207,6 +213,7 @@ SmmHeci3EntryPoint(
   pSmmHeci->HeciRequest = (SMM_ME_HECI3_REQUEST)SmmHeciRequest;
   pSmmHeci->HeciSend = (SMM_ME_HECI3_SEND)HeciMsgSend;
   pSmmHeci->HeciRecv = (SMM_ME_HECI3_RECIEVE)HeciMsgRecv;
+  pSmmHeci->HeciRequestQueue = (SMM_ME_HECI3_REQUEST_QUEUE)SmmHeciRequestQueue;
   Handle = NULL;
   //
   // Install the SMM HECI API
@@ -371,3 +378,112 @@ EFI_STATUS EFIAPI SmmHeciRequest(
   return Status;
 } // SmmHeciRequest()
 
+
+/**
+ * Send a queue of request messages to HECI, collect their responses.
+ *
+ * This function processes the queue starting at entry (*pDone). MBAR is
+ * prepared and verified once for the whole batch and HECI queue is reset
+ * only when a request fails, not after every request. Processing stops
+ * when the timeout is exhausted, so a long batch may be spread across
+ * several SMIs by calling the function again with the same queue.
+ *
+ * @param[in]     pThis     Pointer to protocol data
+ * @param[in,out] pTimeout  On input timeout in ms for the batch, on exit time left
+ * @param[in,out] pQueue    Array of requests
+ * @param[in]     QueueLen  Number of entries in pQueue
+ * @param[in,out] pDone     On input first entry to process, on exit number of processed entries
+ *
+ * HECI_QUEUE_RESET_RESERVE ms of the timeout are kept for the final queue reset.
+ * A request that runs out of time is not counted in (*pDone) and is sent again
+ * by the next call. On exit Status of every entry from (*pDone) onward is
+ * EFI_NOT_READY.
+ *
+ * @retval EFI_SUCCESS      All entries processed, see Status of each entry
+ * @retval EFI_NOT_READY    Timeout exhausted, call again to process the rest of the queue
+ * @retval EFI_UNSUPPORTED  HECI MBAR could not be verified, no entry processed
+ */
+EFI_STATUS EFIAPI SmmHeciRequestQueue(
+  IN     SMM_ME_HECI3_PROTOCOL    *pThis,
+  IN OUT UINT32                   *pTimeout,
+  IN OUT SMM_ME_HECI3_QUEUE_ENTRY *pQueue,
+  IN     UINT32                   QueueLen,
+  IN OUT UINT32                   *pDone)
+{
+  EFI_STATUS                Status = EFI_UNSUPPORTED;
+  UINT64                    CurrentHeciMBar;
+  SMM_ME_HECI3_QUEUE_ENTRY *pEntry;
+  BOOLEAN                   NeedReset = FALSE;
+  UINT32                    Index;
+  UINT32                    Budget;
+  UINT32                    Reserve;
+  UINT32                    RspLen;
+
+  if (pThis == NULL || pTimeout == NULL || pQueue == NULL || pDone == NULL || *pDone > QueueLen)
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Keep part of the budget for the final queue reset, so it never runs with no time left
+  //
+  Reserve = MIN (*pTimeout, HECI_QUEUE_RESET_RESERVE);
+  Budget  = *pTimeout - Reserve;
+
+  CurrentHeciMBar = PrepareHeciMbar (&pThis->HeciDev);
+  if (HeciMBar == HeciMbarReadFull (&pThis->HeciDev, TRUE)) {
+    Status = EFI_SUCCESS;
+    while (*pDone < QueueLen) {
+      //
+      // Leave the rest for the next SMI when the batch time is used up
+      //
+      if (Budget == 0) {
+        Status = EFI_NOT_READY;
+        break;
+      }
+      pEntry = &pQueue[*pDone];
+      RspLen = pEntry->RspLen;
+      pEntry->Status = HeciMsgSend (&pThis->HeciDev, &Budget, pEntry->pReqMsg);
+      if (!EFI_ERROR (pEntry->Status) && pEntry->pRspBuf != NULL) {
+        pEntry->Status = HeciMsgRecv (&pThis->HeciDev, &Budget, pEntry->pRspBuf, &pEntry->RspLen);
+      }
+      if (pEntry->Status == EFI_TIMEOUT) {
+        //
+        // The budget ran out inside this request, retry it from the start in the next call
+        //
+        pEntry->RspLen = RspLen;
+        NeedReset = TRUE;
+        Status = EFI_NOT_READY;
+        break;
+      }
+      if (EFI_ERROR (pEntry->Status)) {
+        //
+        // Resynchronize the queue before the next request
+        //
+        HeciQueReset (&pThis->HeciDev, &Budget);
+        NeedReset = FALSE;
+      } else {
+        NeedReset = TRUE;
+      }
+      (*pDone)++;
+    }
+    //
+    // Leave the queue clean for the OS driver, as SmmHeciRequest() does
+    //
+    Budget += Reserve;
+    Reserve = 0;
+    if (NeedReset) {
+      HeciQueReset (&pThis->HeciDev, &Budget);
+    }
+  }
+  *pTimeout = Budget + Reserve;
+  SetHeciMbar (CurrentHeciMBar, &pThis->HeciDev);
+  //
+  // Entries not processed in this call are reported as pending
+  //
+  for (Index = *pDone; Index < QueueLen; Index++) {
+    pQueue[Index].Status = EFI_NOT_READY;
+  }
+
+  return Status;
+} // SmmHeciRequestQueue()
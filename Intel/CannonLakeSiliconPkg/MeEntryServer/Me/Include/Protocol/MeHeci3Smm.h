@@ -140,6 +140,51 @@ typedef EFI_STATUS (EFIAPI *SMM_ME_HECI3_REQUEST)(
      OUT HECI_MSG_HEADER       *pRspBuf,
   IN     UINT32                *pBufLen);
 
+/**
+ * HECI request queue entry.
+ *
+ * One request of a batch passed to SmmHeciRequestQueue(). Status is
+ * EFI_NOT_READY until the request is processed; SmmHeciRequestQueue() sets it
+ * for every entry it leaves unprocessed.
+ */
+typedef struct
+{
+  HECI_MSG_HEADER *pReqMsg;   // Request message
+  HECI_MSG_HEADER *pRspBuf;   // Buffer for the response, NULL if no response expected
+  UINT32           RspLen;    // On input buffer size, on exit response length, in bytes
+  EFI_STATUS       Status;    // Result of this request
+} SMM_ME_HECI3_QUEUE_ENTRY;
+
+/**
+ * Send a queue of request messages to HECI, collect their responses.
+ *
+ * This function processes the queue starting at entry (*pDone). MBAR is
+ * prepared and verified once for the whole batch and HECI queue is reset
+ * only when a request fails, not after every request. Processing stops
+ * when the timeout is exhausted, so a long batch may be spread across
+ * several SMIs by calling the function again with the same queue.
+ *
+ * @param[in]     pThis     Pointer to protocol data
+ * @param[in,out] pTimeout  On input timeout in ms for the batch, on exit time left
+ * @param[in,out] pQueue    Array of requests
+ * @param[in]     QueueLen  Number of entries in pQueue
+ * @param[in,out] pDone     On input first entry to process, on exit number of processed entries
+ *
+ * Part of the timeout is kept for the final queue reset. A request that runs
+ * out of time is not counted in (*pDone) and is sent again by the next call.
+ * On exit Status of every entry from (*pDone) onward is EFI_NOT_READY.
+ *
+ * @retval EFI_SUCCESS      All entries processed, see Status of each entry
+ * @retval EFI_NOT_READY    Timeout exhausted, call again to process the rest of the queue
+ * @retval EFI_UNSUPPORTED  HECI MBAR could not be verified, no entry processed
+ */
+typedef EFI_STATUS (EFIAPI *SMM_ME_HECI3_REQUEST_QUEUE)(
+  IN     SMM_ME_HECI3_PROTOCOL    *pThis,
+  IN OUT UINT32                   *pTimeout,
+  IN OUT SMM_ME_HECI3_QUEUE_ENTRY *pQueue,
+  IN     UINT32                   QueueLen,
+  IN OUT UINT32                   *pDone);
+
 /**
  * Send HECI message.
  *
@@ -186,6 +231,7 @@ typedef struct _SMM_ME_HECI3_PROTOCOL_
   SMM_ME_HECI3_REQUEST     HeciRequest;
   SMM_ME_HECI3_SEND        HeciSend;
   SMM_ME_HECI3_RECIEVE     HeciRecv;
+  SMM_ME_HECI3_REQUEST_QUEUE HeciRequestQueue;
 } SMM_ME_HECI3_PROTOCOL;
 
 #endif // _PROTOCOL_HECI_SMM_H_
@@ -293,12 +293,54 @@ GetApLoopMode (
   return ApLoopMode;
 }
 
+/**
+  Restore the max-heap property of the processor index heap used by
+  SortApicId() starting from the given node.
+
+  @param[in]      CpuInfoInHob  Pointer to CPU_INFO_IN_HOB array
+  @param[in, out] Order         Processor index heap
+  @param[in]      Root          Heap node to sift down
+  @param[in]      Count         Number of nodes in the heap
+**/
+VOID
+SiftDownApicIdHeap (
+  IN     CPU_INFO_IN_HOB   *CpuInfoInHob,
+  IN OUT UINT32            *Order,
+  IN     UINTN             Root,
+  IN     UINTN             Count
+  )
+{
+  UINTN             Child;
+  UINT32            Temp;
+
+  while (TRUE) {
+    Child = 2 * Root + 1;
+    if (Child >= Count) {
+      break;
+    }
+    if ((Child + 1 < Count) &&
+        (CpuInfoInHob[Order[Child + 1]].ApicId > CpuInfoInHob[Order[Child]].ApicId)) {
+      Child++;
+    }
+    if (CpuInfoInHob[Order[Root]].ApicId >= CpuInfoInHob[Order[Child]].ApicId) {
+      break;
+    }
+    Temp          = Order[Root];
+    Order[Root]   = Order[Child];
+    Order[Child]  = Temp;
+    Root          = Child;
+  }
+}
+
 /**
   Sort the APIC ID of all processors.
 
   This function sorts the APIC ID of all processors so that processor number is
   assigned in the ascending order of APIC ID which eases MP debugging.
 
+  The processor indexes are heap sorted first, then each CPU_INFO_IN_HOB record
+  and its StartupApSignal are moved once by following the permutation cycles.
+
   @param[in] CpuMpData        Pointer to PEI CPU MP Data
 **/
 VOID
@@ -306,62 +348,181 @@ SortApicId (
   IN CPU_MP_DATA   *CpuMpData
   )
 {
-  UINTN             Index1;
-  UINTN             Index2;
-  UINTN             Index3;
+  UINTN             Index;
+  UINTN             Current;
+  UINTN             Next;
   UINT32            ApicId;
   CPU_INFO_IN_HOB   CpuInfo;
-  UINT32            ApCount;
+  UINTN             CpuCount;
+  UINT32            *Order;
+  UINT32            Temp;
   CPU_INFO_IN_HOB   *CpuInfoInHob;
   volatile UINT32   *StartupApSignal;
 
-  ApCount = CpuMpData->CpuCount - 1;
+  CpuCount = CpuMpData->CpuCount;
   CpuInfoInHob = (CPU_INFO_IN_HOB *) (UINTN) CpuMpData->CpuInfoInHob;
-  if (ApCount != 0) {
-    for (Index1 = 0; Index1 < ApCount; Index1++) {
-      Index3 = Index1;
-      //
-      // Sort key is the hardware default APIC ID
-      //
-      ApicId = CpuInfoInHob[Index1].ApicId;
-      for (Index2 = Index1 + 1; Index2 <= ApCount; Index2++) {
-        if (ApicId > CpuInfoInHob[Index2].ApicId) {
-          Index3 = Index2;
-          ApicId = CpuInfoInHob[Index2].ApicId;
-        }
-      }
-      if (Index3 != Index1) {
-        CopyMem (&CpuInfo, &CpuInfoInHob[Index3], sizeof (CPU_INFO_IN_HOB));
-        CopyMem (
-          &CpuInfoInHob[Index3],
-          &CpuInfoInHob[Index1],
-          sizeof (CPU_INFO_IN_HOB)
-          );
-        CopyMem (&CpuInfoInHob[Index1], &CpuInfo, sizeof (CPU_INFO_IN_HOB));
+  if (CpuCount > 1) {
+    Order = AllocatePool (CpuCount * sizeof (UINT32));
+    ASSERT (Order != NULL);
+    if (Order == NULL) {
+      return;
+    }
+    for (Index = 0; Index < CpuCount; Index++) {
+      Order[Index] = (UINT32) Index;
+    }
 
-        //
-        // Also exchange the StartupApSignal.
-        //
-        StartupApSignal = CpuMpData->CpuData[Index3].StartupApSignal;
-        CpuMpData->CpuData[Index3].StartupApSignal =
-          CpuMpData->CpuData[Index1].StartupApSignal;
-        CpuMpData->CpuData[Index1].StartupApSignal = StartupApSignal;
+    //
+    // Sort key is the hardware default APIC ID
+    //
+    for (Index = CpuCount / 2; Index > 0; Index--) {
+      SiftDownApicIdHeap (CpuInfoInHob, Order, Index - 1, CpuCount);
+    }
+    for (Index = CpuCount - 1; Index > 0; Index--) {
+      Temp         = Order[0];
+      Order[0]     = Order[Index];
+      Order[Index] = Temp;
+      SiftDownApicIdHeap (CpuInfoInHob, Order, 0, Index);
+    }
+
+    //
+    // Order[Index] is now the old position of the record that belongs at Index.
+    // Also move the StartupApSignal together with its record.
+    //
+    for (Index = 0; Index < CpuCount; Index++) {
+      if (Order[Index] == Index) {
+        continue;
       }
+      CopyMem (&CpuInfo, &CpuInfoInHob[Index], sizeof (CPU_INFO_IN_HOB));
+      StartupApSignal = CpuMpData->CpuData[Index].StartupApSignal;
+      Current = Index;
+      while (Order[Current] != Index) {
+        Next = Order[Current];
+        CopyMem (&CpuInfoInHob[Current], &CpuInfoInHob[Next], sizeof (CPU_INFO_IN_HOB));
+        CpuMpData->CpuData[Current].StartupApSignal = CpuMpData->CpuData[Next].StartupApSignal;
+        Order[Current] = (UINT32) Current;
+        Current = Next;
+      }
+      CopyMem (&CpuInfoInHob[Current], &CpuInfo, sizeof (CPU_INFO_IN_HOB));
+      CpuMpData->CpuData[Current].StartupApSignal = StartupApSignal;
+      Order[Current] = (UINT32) Current;
     }
+    FreePool (Order);
 
     //
     // Get the processor number for the BSP
     //
     ApicId = GetInitialApicId ();
-    for (Index1 = 0; Index1 < CpuMpData->CpuCount; Index1++) {
-      if (CpuInfoInHob[Index1].ApicId == ApicId) {
-        CpuMpData->BspNumber = (UINT32) Index1;
+    for (Index = 0; Index < CpuCount; Index++) {
+      if (CpuInfoInHob[Index].ApicId == ApicId) {
+        CpuMpData->BspNumber = (UINT32) Index;
         break;
       }
     }
   }
 }
 
+/**
+  Build the APIC ID to processor number lookup table and the processor
+  topology table for all processors.
+
+  Both tables are referenced from CPU MP Data so they are passed from PEI to
+  DXE together with CPU_INFO_IN_HOB. The lookup table is skipped when the
+  largest APIC ID does not fit in CPU_APIC_ID_MAP_MAX_ENTRIES entries.
+
+  @param[in, out] CpuMpData        Pointer to PEI CPU MP Data
+**/
+VOID
+BuildCpuTopologyMap (
+  IN OUT CPU_MP_DATA   *CpuMpData
+  )
+{
+  UINTN                      Index;
+  UINTN                      CpuCount;
+  UINT32                     MaxApicId;
+  UINT32                     ApicIdMapCount;
+  UINTN                      BufferSize;
+  UINT32                     *ApicIdMap;
+  EFI_CPU_PHYSICAL_LOCATION  *Location;
+  CPU_INFO_IN_HOB            *CpuInfoInHob;
+
+  CpuCount = CpuMpData->CpuCount;
+  CpuInfoInHob = (CPU_INFO_IN_HOB *) (UINTN) CpuMpData->CpuInfoInHob;
+
+  MaxApicId = 0;
+  for (Index = 0; Index < CpuCount; Index++) {
+    MaxApicId = MAX (MaxApicId, CpuInfoInHob[Index].ApicId);
+  }
+  ApicIdMapCount = 0;
+  if (MaxApicId < CPU_APIC_ID_MAP_MAX_ENTRIES) {
+    ApicIdMapCount = MaxApicId + 1;
+  }
+
+  BufferSize = CpuCount * sizeof (EFI_CPU_PHYSICAL_LOCATION) + ApicIdMapCount * sizeof (UINT32);
+  Location   = AllocatePages (EFI_SIZE_TO_PAGES (BufferSize));
+  if (Location == NULL) {
+    DEBUG ((DEBUG_WARN, "MpInitLib: No memory for CPU topology map\n"));
+    return;
+  }
+  ApicIdMap = (UINT32 *) (Location + CpuCount);
+  for (Index = 0; Index < ApicIdMapCount; Index++) {
+    ApicIdMap[Index] = CPU_APIC_ID_MAP_INVALID;
+  }
+
+  for (Index = 0; Index < CpuCount; Index++) {
+    GetProcessorLocationByApicId (
+      CpuInfoInHob[Index].ApicId,
+      &Location[Index].Package,
+      &Location[Index].Core,
+      &Location[Index].Thread
+      );
+    if (CpuInfoInHob[Index].ApicId < ApicIdMapCount) {
+      ApicIdMap[CpuInfoInHob[Index].ApicId] = (UINT32) Index;
+    }
+  }
+
+  CpuMpData->CpuTopologyInHob = (UINT64) (UINTN) Location;
+  CpuMpData->ApicIdMap        = (ApicIdMapCount != 0) ? (UINT64) (UINTN) ApicIdMap : 0;
+  CpuMpData->ApicIdMapCount   = ApicIdMapCount;
+  DEBUG ((DEBUG_INFO, "MpInitLib: APIC ID map has %d entries\n", ApicIdMapCount));
+}
+
+/**
+  Refresh the lookup table and topology entries of one processor after its
+  APIC ID has changed.
+
+  @param[in, out] CpuMpData        Pointer to PEI CPU MP Data
+  @param[in]      ProcessorNumber  The handle number of processor
+**/
+VOID
+UpdateCpuTopologyMap (
+  IN OUT CPU_MP_DATA   *CpuMpData,
+  IN     UINTN         ProcessorNumber
+  )
+{
+  UINT32                     ApicId;
+  UINT32                     *ApicIdMap;
+  EFI_CPU_PHYSICAL_LOCATION  *Location;
+  CPU_INFO_IN_HOB            *CpuInfoInHob;
+
+  CpuInfoInHob = (CPU_INFO_IN_HOB *) (UINTN) CpuMpData->CpuInfoInHob;
+  ApicId       = CpuInfoInHob[ProcessorNumber].ApicId;
+
+  ApicIdMap = (UINT32 *) (UINTN) CpuMpData->ApicIdMap;
+  if ((ApicIdMap != NULL) && (ApicId < CpuMpData->ApicIdMapCount)) {
+    ApicIdMap[ApicId] = (UINT32) ProcessorNumber;
+  }
+
+  Location = (EFI_CPU_PHYSICAL_LOCATION *) (UINTN) CpuMpData->CpuTopologyInHob;
+  if (Location != NULL) {
+    GetProcessorLocationByApicId (
+      ApicId,
+      &Location[ProcessorNumber].Package,
+      &Location[ProcessorNumber].Core,
+      &Location[ProcessorNumber].Thread
+      );
+  }
+}
+
 /**
   Enable x2APIC mode on APs.
 
@@ -417,13 +578,28 @@ GetProcessorNumber (
 {
   UINTN                   TotalProcessorNumber;
   UINTN                   Index;
+  UINT32                  ApicId;
+  UINT32                  *ApicIdMap;
   CPU_INFO_IN_HOB         *CpuInfoInHob;
 
   CpuInfoInHob = (CPU_INFO_IN_HOB *) (UINTN) CpuMpData->CpuInfoInHob;
+  ApicId       = GetApicId ();
 
   TotalProcessorNumber = CpuMpData->CpuCount;
+  ApicIdMap = (UINT32 *) (UINTN) CpuMpData->ApicIdMap;
+  if ((ApicIdMap != NULL) && (ApicId < CpuMpData->ApicIdMapCount)) {
+    Index = ApicIdMap[ApicId];
+    //
+    // The entry may be stale if the APIC ID changed after the map was built
+    //
+    if ((Index < TotalProcessorNumber) && (CpuInfoInHob[Index].ApicId == ApicId)) {
+      *ProcessorNumber = Index;
+      return EFI_SUCCESS;
+    }
+  }
+
   for (Index = 0; Index < TotalProcessorNumber; Index ++) {
-    if (CpuInfoInHob[Index].ApicId == GetApicId ()) {
+    if (CpuInfoInHob[Index].ApicId == ApicId) {
       *ProcessorNumber = Index;
       return EFI_SUCCESS;
     }
@@ -494,6 +670,7 @@ CollectProcessorCount (
   // Sort BSP/Aps by CPU APIC ID in ascending order
   //
   SortApicId (CpuMpData);
+  BuildCpuTopologyMap (CpuMpData);
 
   DEBUG ((DEBUG_INFO, "MpInitLib: Find %d processors in system.\n", CpuMpData->CpuCount));
 
@@ -659,6 +836,7 @@ ApWakeupFunction (
                 //
                 CpuInfoInHob[ProcessorNumber].ApicId        = GetApicId ();
                 CpuInfoInHob[ProcessorNumber].InitialApicId = GetInitialApicId ();
+                UpdateCpuTopologyMap (CpuMpData, ProcessorNumber);
               }
             }
           }
@@ -1462,6 +1640,9 @@ MpInitLibInitialize (
     CpuMpData->BspNumber = OldCpuMpData->BspNumber;
     CpuMpData->InitFlag  = ApInitReconfig;
     CpuMpData->CpuInfoInHob = OldCpuMpData->CpuInfoInHob;
+    CpuMpData->ApicIdMap        = OldCpuMpData->ApicIdMap;
+    CpuMpData->ApicIdMapCount   = OldCpuMpData->ApicIdMapCount;
+    CpuMpData->CpuTopologyInHob = OldCpuMpData->CpuTopologyInHob;
     CpuInfoInHob = (CPU_INFO_IN_HOB *) (UINTN) CpuMpData->CpuInfoInHob;
     for (Index = 0; Index < CpuMpData->CpuCount; Index++) {
       InitializeSpinLock(&CpuMpData->CpuData[Index].ApLock);
@@ -1527,12 +1708,14 @@ MpInitLibGetProcessorInfo (
   OUT EFI_HEALTH_FLAGS           *HealthData  OPTIONAL
   )
 {
-  CPU_MP_DATA            *CpuMpData;
-  UINTN                  CallerNumber;
-  CPU_INFO_IN_HOB        *CpuInfoInHob;
+  CPU_MP_DATA               *CpuMpData;
+  UINTN                     CallerNumber;
+  CPU_INFO_IN_HOB           *CpuInfoInHob;
+  EFI_CPU_PHYSICAL_LOCATION *Location;
 
   CpuMpData = GetCpuMpData ();
   CpuInfoInHob = (CPU_INFO_IN_HOB *) (UINTN) CpuMpData->CpuInfoInHob;
+  Location     = (EFI_CPU_PHYSICAL_LOCATION *) (UINTN) CpuMpData->CpuTopologyInHob;
 
   //
   // Check whether caller processor is BSP
@@ -1567,12 +1750,16 @@ MpInitLibGetProcessorInfo (
   //
   // Get processor location information
   //
-  GetProcessorLocationByApicId (
-    CpuInfoInHob[ProcessorNumber].ApicId,
-    &ProcessorInfoBuffer->Location.Package,
-    &ProcessorInfoBuffer->Location.Core,
-    &ProcessorInfoBuffer->Location.Thread
-    );
+  if (Location != NULL) {
+    CopyMem (&ProcessorInfoBuffer->Location, &Location[ProcessorNumber], sizeof (EFI_CPU_PHYSICAL_LOCATION));
+  } else {
+    GetProcessorLocationByApicId (
+      CpuInfoInHob[ProcessorNumber].ApicId,
+      &ProcessorInfoBuffer->Location.Package,
+      &ProcessorInfoBuffer->Location.Core,
+      &ProcessorInfoBuffer->Location.Thread
+      );
+  }
 
   if (HealthData != NULL) {
     HealthData->Uint32 = CpuInfoInHob[ProcessorNumber].Health;
@@ -37,6 +37,13 @@
 
 #define WAKEUP_AP_SIGNAL SIGNATURE_32 ('S', 'T', 'A', 'P')
 
+//
+// Largest APIC ID lookup table built by BuildCpuTopologyMap(). Platforms
+// with sparser APIC IDs fall back to scanning CPU_INFO_IN_HOB.
+//
+#define CPU_APIC_ID_MAP_MAX_ENTRIES  0x1000
+#define CPU_APIC_ID_MAP_INVALID      MAX_UINT32
+
 #define CPU_INIT_MP_LIB_HOB_GUID \
   { \
     0x58eb6a19, 0x3699, 0x4c68, { 0xa8, 0x36, 0xda, 0xcd, 0x8e, 0xdc, 0xad, 0x4a } \
@@ -190,6 +197,13 @@ struct _CPU_MP_DATA {
   UINT32                         CpuCount;
   UINT32                         BspNumber;
   //
+  // APIC ID to processor number lookup table (UINT32 per APIC ID) and
+  // processor topology table (EFI_CPU_PHYSICAL_LOCATION per processor).
+  //
+  UINT64                         ApicIdMap;
+  UINT64                         CpuTopologyInHob;
+  UINT32                         ApicIdMapCount;
+  //
   // The above fields data will be passed from PEI to DXE
   // Please make sure the fields offset same in the different
   // architecture.
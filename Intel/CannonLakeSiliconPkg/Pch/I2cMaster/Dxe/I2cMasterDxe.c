@@ -40,6 +40,7 @@
 #include <Protocol/PciIo.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
+#include <Library/BaseLib.h>
 #include <Library/IoLib.h>
 #include <Library/TimerLib.h>
 #include <Library/UefiLib.h>
@@ -57,6 +58,21 @@
 ///
 #define I2C_PORT_SIGNATURE      0x70433249
 
+///
+/// Number of asynchronous requests that can wait behind the one in progress
+///
+#define I2C_MASTER_QUEUE_DEPTH  8
+
+///
+/// Asynchronous request waiting for the controller
+///
+typedef struct {
+  UINTN                           SlaveAddress;
+  EFI_I2C_REQUEST_PACKET          *RequestPacket;
+  EFI_EVENT                       RequestEvent;
+  EFI_STATUS                      *RequestStatus;
+} I2C_QUEUED_REQUEST;
+
 typedef struct {
   UINTN                           Signature;
   EFI_I2C_MASTER_PROTOCOL         MasterApi;
@@ -64,6 +80,16 @@ typedef struct {
   EFI_STATUS                      *RequestStatus;
   EFI_EVENT                       Timer;
   I2C_MASTER_CONTEXT              Master;
+  //
+  // Bus clock set by I2cPortBusFrequencySet, 0 until the first successful call
+  //
+  UINTN                           BusClockHertz;
+  //
+  // Asynchronous requests started back to back when the current one completes
+  //
+  I2C_QUEUED_REQUEST              Queue[I2C_MASTER_QUEUE_DEPTH];
+  UINTN                           QueueHead;
+  UINTN                           QueueCount;
 } I2C_DRIVER_CONTEXT;
 
 ///
@@ -72,6 +98,7 @@ typedef struct {
 #define I2C_MASTER_CONTEXT_FROM_MASTER_PROTOCOL(a)  CR (a, I2C_DRIVER_CONTEXT, MasterApi, I2C_PORT_SIGNATURE)
 
 #define I2C_MASTER_POLLING_PERIOD 500 //microseconds
+#define I2C_MASTER_MIN_POLLING_PERIOD 10 //microseconds
 
 GLOBAL_REMOVE_IF_UNREFERENCED CONST EFI_UNICODE_STRING_TABLE mControllerNameStringTable[] = {
   { "eng", L"I2C Master X" }, //X - to be substituted with controller number (0-5)
@@ -89,12 +116,80 @@ typedef struct {
 
 
 
+/**
+  Returns how long the transfer can be left alone between two PerformTransfer calls.
+  That is the time the bus needs to shift out half of the transmit FIFO
+  (9 clocks per byte including ACK), so the FIFO is refilled before it runs empty.
+
+  @param[in] Context   driver context
+
+  @retval              Polling period in microseconds
+**/
+UINT32
+I2cPollingPeriod (
+  IN I2C_DRIVER_CONTEXT *Context
+  )
+{
+  UINT64 Period;
+
+  if (Context->BusClockHertz == 0) {
+    return I2C_MASTER_POLLING_PERIOD;
+  }
+  Period = DivU64x64Remainder (
+             MultU64x32 (MAX (Context->Master.TxFifoDepth / 2, 1) * 9, 1000000),
+             Context->BusClockHertz,
+             NULL
+             );
+  if (Period < I2C_MASTER_MIN_POLLING_PERIOD) {
+    return I2C_MASTER_MIN_POLLING_PERIOD;
+  }
+  if (Period > I2C_MASTER_POLLING_PERIOD) {
+    return I2C_MASTER_POLLING_PERIOD;
+  }
+  return (UINT32) Period;
+}
+
+/**
+  Starts the oldest queued asynchronous request.
+  Requests that fail to start are completed with the failure status and the next one is tried.
+  Must be called at TPL_NOTIFY with no transfer in progress.
+
+  @param[in] Context   driver context
+**/
+VOID
+StartQueuedRequest (
+  IN I2C_DRIVER_CONTEXT *Context
+  )
+{
+  I2C_QUEUED_REQUEST *Queued;
+  EFI_STATUS         Status;
+
+  while (Context->QueueCount != 0) {
+    Queued = &Context->Queue[Context->QueueHead];
+    Context->QueueHead = (Context->QueueHead + 1) % I2C_MASTER_QUEUE_DEPTH;
+    Context->QueueCount--;
+
+    Context->RequestStatus = Queued->RequestStatus;
+    Context->RequestEvent  = Queued->RequestEvent;
+    Status = InitializeTransfer (&Context->Master, Queued->SlaveAddress, Queued->RequestPacket);
+    if (!EFI_ERROR (Status)) {
+      PerformTransfer (&Context->Master);
+      gBS->SetTimer (Context->Timer, TimerPeriodic, 10 * I2cPollingPeriod (Context));
+      return;
+    }
+    if (Context->RequestStatus != NULL) {
+      *(Context->RequestStatus) = Status;
+    }
+    gBS->SignalEvent (Context->RequestEvent);
+  }
+}
+
 /**
   PerformTransfer. For synchronous transfer this function is called in a loop
   and for asynchronous transfers, as a timer callback. It writes data and/or
   read requests to hadrware, copies read data to destination buffers. When
   transfer completes, it cleans up Sw context and Hw registers in preparation
-  for new transfer
+  for new transfer, then starts the next queued asynchronous request.
 
   @param[in] Event     obligatory parameter for callback functions, not used here
   @param[in] Context   driver context
@@ -118,6 +213,7 @@ AsyncTransfer (
     }
     if (DriverContext->RequestEvent != NULL) {
       gBS->SignalEvent (DriverContext->RequestEvent);
+      StartQueuedRequest (DriverContext);
     }
   }
 }
@@ -151,10 +247,15 @@ I2cPortBusFrequencySet (
   )
 {
   I2C_DRIVER_CONTEXT *Context;
+  EFI_STATUS         Status;
 
   Context = I2C_MASTER_CONTEXT_FROM_MASTER_PROTOCOL ( This );
 
-  return FrequencySet (Context->Master.MmioAddress, BusClockHertz);
+  Status = FrequencySet (Context->Master.MmioAddress, BusClockHertz);
+  if (!EFI_ERROR (Status)) {
+    Context->BusClockHertz = *BusClockHertz;
+  }
+  return Status;
 }
 
 /**
@@ -268,6 +369,8 @@ I2cPortReset (
   transfer has finished. Otherwise, it's an asynchronous transfer. In that case
   function will start the transfer, set a timer event and return. Timer event will
   wake it up later so that it can continue or finish the transfer.
+  Asynchronous requests submitted while the controller is busy are queued and
+  started back to back as soon as the previous one completes.
 
   @param[in] This               Address of an EFI_I2C_MASTER_PROTOCOL
                                 structure
@@ -281,7 +384,9 @@ I2cPortReset (
 
   @retval EFI_SUCCESS           The requested synchronous operation completed successfully or
                                 requested asynchronous operation was started.
-  @retval EFI_ALREADY_STARTED   The controller is busy with another transfer
+  @retval EFI_ABORTED           The controller lost arbitration to another bus master
+  @retval EFI_ALREADY_STARTED   The controller is busy with another transfer and
+                                the request is synchronous or the queue is full
   @retval EFI_BAD_BUFFER_SIZE   Transfer size too big
   @retval EFI_DEVICE_ERROR      There was an I2C error (NACK) during the operation.
   @retval EFI_INVALID_PARAMETER RequestPacket is NULL, invalid Operation flags
@@ -301,12 +406,31 @@ I2cPortMasterStartRequest (
   )
 {
   I2C_DRIVER_CONTEXT  *Context;
+  I2C_QUEUED_REQUEST  *Queued;
   EFI_STATUS          Status;
+  EFI_TPL             OldTpl;
+  UINT32              PollingPeriod;
 
   Context = I2C_MASTER_CONTEXT_FROM_MASTER_PROTOCOL ( This );
 
+  //
+  // The timer callback runs at TPL_NOTIFY, keep it out while the state is examined
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
   Status = ValidateRequest (&Context->Master, RequestPacket);
+  if ((Status == EFI_ALREADY_STARTED) && (Event != NULL) && (Context->QueueCount < I2C_MASTER_QUEUE_DEPTH)) {
+    Queued = &Context->Queue[(Context->QueueHead + Context->QueueCount) % I2C_MASTER_QUEUE_DEPTH];
+    Queued->SlaveAddress  = SlaveAddress;
+    Queued->RequestPacket = RequestPacket;
+    Queued->RequestEvent  = Event;
+    Queued->RequestStatus = RequestStatus;
+    Context->QueueCount++;
+    gBS->RestoreTPL (OldTpl);
+    return EFI_SUCCESS;
+  }
   if (EFI_ERROR (Status)) {
+    gBS->RestoreTPL (OldTpl);
     DEBUG (( DEBUG_INFO, "I2cPort: ValidateRequest failed, %r\n", Status ));
     return Status;
   }
@@ -316,18 +440,35 @@ I2cPortMasterStartRequest (
 
   Status = InitializeTransfer (&Context->Master, SlaveAddress, RequestPacket);
   if (EFI_ERROR (Status)) {
+    gBS->RestoreTPL (OldTpl);
     return Status;
   }
 
+  PollingPeriod = I2cPollingPeriod (Context);
   AsyncTransfer (Context->Timer, Context);
   if (Event == NULL) {
+    gBS->RestoreTPL (OldTpl);
     while (Context->Master.TransferInProgress) {
-      MicroSecondDelay (I2C_MASTER_POLLING_PERIOD);
+      MicroSecondDelay (PollingPeriod);
+      OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
       AsyncTransfer (Context->Timer, Context);
+      gBS->RestoreTPL (OldTpl);
+    }
+    Status = Context->Master.TransferStatus;
+    //
+    // Asynchronous requests may have been queued behind this one
+    //
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    if (!Context->Master.TransferInProgress) {
+      StartQueuedRequest (Context);
     }
-    return Context->Master.TransferStatus;
+    gBS->RestoreTPL (OldTpl);
+    return Status;
   } else {
-    gBS->SetTimer (Context->Timer, TimerPeriodic, 10*I2C_MASTER_POLLING_PERIOD);
+    if (Context->Master.TransferInProgress) {
+      gBS->SetTimer (Context->Timer, TimerPeriodic, 10 * PollingPeriod);
+    }
+    gBS->RestoreTPL (OldTpl);
     return EFI_SUCCESS;
   }
 
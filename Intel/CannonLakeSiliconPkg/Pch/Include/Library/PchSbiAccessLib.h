@@ -61,14 +61,38 @@ typedef enum {
   SBI_INVALID_RESPONSE
 } PCH_SBI_RESPONSE;
 
+///
+/// One operation of an SBI batch
+///
+typedef struct {
+  PCH_SBI_PID     Pid;          ///< Port ID of the SBI message
+  UINT64          Offset;       ///< Offset of the SBI message
+  PCH_SBI_OPCODE  Opcode;       ///< Opcode
+  BOOLEAN         Posted;       ///< Posted message
+  UINT16          Fbe;          ///< First byte enable
+  UINT16          Bar;          ///< Bar
+  UINT16          Fid;          ///< Function ID
+  UINT32          Data32;       ///< Write data on input, read data on output
+  UINT8           Response;     ///< PCH_SBI_RESPONSE of this operation
+} PCH_SBI_BATCH_ENTRY;
+
+///
+/// SBI batch built over a caller provided entry array
+///
+typedef struct {
+  PCH_SBI_BATCH_ENTRY  *Entry;
+  UINTN                Count;
+  UINTN                MaxCount;
+} PCH_SBI_BATCH;
+
 /**
   Execute PCH SBI message
   Take care of that there is no lock protection when using SBI programming in both POST time and SMI.
   It will clash with POST time SBI programming when SMI happen.
   Programmer MUST do the save and restore opration while using the PchSbiExecution inside SMI
   to prevent from racing condition.
-  This function will reveal P2SB and hide P2SB if it's originally hidden. If more than one SBI access
-  needed, it's better to unhide the P2SB before calling and hide it back after done.
+  The function does not reveal P2SB. P2SB must be visible before calling, otherwise
+  EFI_DEVICE_ERROR is returned. To hide P2SB again, do it after the last SBI access.
 
   When the return value is "EFI_SUCCESS", the "Response" do not need to be checked as it would have been
   SBI_SUCCESS. If the return value is "EFI_DEVICE_ERROR", then this would provide additional information
@@ -82,7 +106,7 @@ typedef enum {
   @param[out] Response                  Response
 
   @retval EFI_SUCCESS                   Successfully completed.
-  @retval EFI_DEVICE_ERROR              Transaction fail
+  @retval EFI_DEVICE_ERROR              Transaction fail or P2SB hidden
   @retval EFI_INVALID_PARAMETER         Invalid parameter
   @retval EFI_TIMEOUT                   Timeout while waiting for response
 **/
@@ -103,8 +127,8 @@ PchSbiExecution (
   It will clash with POST time SBI programming when SMI happen.
   Programmer MUST do the save and restore opration while using the PchSbiExecution inside SMI
   to prevent from racing condition.
-  This function will reveal P2SB and hide P2SB if it's originally hidden. If more than one SBI access
-  needed, it's better to unhide the P2SB before calling and hide it back after done.
+  The function does not reveal P2SB. P2SB must be visible before calling, otherwise
+  EFI_DEVICE_ERROR is returned. To hide P2SB again, do it after the last SBI access.
 
   When the return value is "EFI_SUCCESS", the "Response" do not need to be checked as it would have been
   SBI_SUCCESS. If the return value is "EFI_DEVICE_ERROR", then this would provide additional information
@@ -121,7 +145,7 @@ PchSbiExecution (
   @param[out] Response                  Response
 
   @retval EFI_SUCCESS                   Successfully completed.
-  @retval EFI_DEVICE_ERROR              Transaction fail
+  @retval EFI_DEVICE_ERROR              Transaction fail or P2SB hidden
   @retval EFI_INVALID_PARAMETER         Invalid parameter
   @retval EFI_TIMEOUT                   Timeout while waiting for response
 **/
@@ -139,4 +163,68 @@ PchSbiExecutionEx (
   OUT    UINT8                          *Response
   );
 
+/**
+  Initialize an SBI batch over a caller provided entry array.
+
+  @param[out] Batch                     SBI batch
+  @param[in]  Entry                     Entry array used to queue the operations
+  @param[in]  MaxCount                  Number of entries in the array
+**/
+VOID
+EFIAPI
+PchSbiBatchInit (
+  OUT    PCH_SBI_BATCH                  *Batch,
+  IN     PCH_SBI_BATCH_ENTRY            *Entry,
+  IN     UINTN                          MaxCount
+  );
+
+/**
+  Queue one SBI operation in a batch.
+
+  @param[in, out] Batch                 SBI batch
+  @param[in] Pid                        Port ID of the SBI message
+  @param[in] Offset                     Offset of the SBI message
+  @param[in] Opcode                     Opcode
+  @param[in] Posted                     Posted message
+  @param[in] Data32                     Write data, ignored for read opcodes
+
+  @retval EFI_SUCCESS                   Operation queued
+  @retval EFI_INVALID_PARAMETER         Invalid opcode
+  @retval EFI_BUFFER_TOO_SMALL          The batch is full
+**/
+EFI_STATUS
+EFIAPI
+PchSbiBatchAppend (
+  IN OUT PCH_SBI_BATCH                  *Batch,
+  IN     PCH_SBI_PID                    Pid,
+  IN     UINT64                         Offset,
+  IN     PCH_SBI_OPCODE                 Opcode,
+  IN     BOOLEAN                        Posted,
+  IN     UINT32                         Data32
+  );
+
+/**
+  Execute all operations queued in an SBI batch back to back.
+  P2SB visibility is checked once for the batch, and the completion poll of each message
+  also serves as the idle poll of the next one. Each entry gets its own Response and,
+  for read opcodes, Data32. P2SB must be visible during the whole batch.
+
+  When SaveRestore is TRUE the SBI registers are saved before the batch and restored after it,
+  which is what an SMI handler must do to not corrupt an SBI sequence interrupted in POST.
+
+  @param[in, out] Batch                 SBI batch
+  @param[in] SaveRestore                Save and restore the SBI interface registers
+
+  @retval EFI_SUCCESS                   All entries completed successfully.
+  @retval EFI_DEVICE_ERROR              At least one entry failed, check the Response of each entry
+  @retval EFI_INVALID_PARAMETER         Invalid parameter
+  @retval EFI_TIMEOUT                   Timeout while waiting for response, remaining entries not executed
+**/
+EFI_STATUS
+EFIAPI
+PchSbiBatchExecution (
+  IN OUT PCH_SBI_BATCH                  *Batch,
+  IN     BOOLEAN                        SaveRestore
+  );
+
 #endif // _PCH_SBI_ACCESS_LIB_H_
@@ -133,5 +133,94 @@ PchSerialIoUartPoll (
   IN  UINT8     UartNumber
   );
 
+///
+/// Cached SerialIo UART access handle.
+/// The handle is owned by the caller (stack, module global or HOB, depending on the phase),
+/// so the library itself stays free of writable globals.
+///
+typedef struct {
+  UINTN             Base;          ///< UART MMIO base address, resolved once by PchSerialIoUartOpen()
+  UART_ACCESS_MODE  AccessMode;    ///< 8 or 32 bit register access mode
+  UINT8             UartNumber;    ///< Serial IO UART device (0-2)
+  UINT8             FifoDepth;     ///< Number of bytes that can be written to an empty TX FIFO without a status check
+  UINT8             *TxRing;       ///< Optional transmit ring buffer, NULL for blocking mode
+  UINT32            TxRingSize;    ///< Size of TxRing in bytes
+  UINT32            TxRingHead;    ///< Index of the oldest byte queued in TxRing
+  UINT32            TxRingCount;   ///< Number of bytes queued in TxRing
+  UINT32            TxDropped;     ///< Number of bytes dropped because TxRing was full
+} PCH_SERIAL_IO_UART_HANDLE;
+
+/**
+  Open a cached handle to selected SerialIo UART.
+  The BAR, access mode and TX FIFO depth are resolved here once, so subsequent writes through
+  the handle skip PCI config space accesses. A handle should be re-opened in every boot phase,
+  since PCI enumeration may move the BAR or clear memory space enable.
+
+  @param[in]  UartNumber       Selects Serial IO UART device (0-2)
+  @param[out] Handle           Pointer to the caller owned handle to be filled
+
+  @retval EFI_SUCCESS              Handle is ready for use.
+  @retval EFI_INVALID_PARAMETER    Handle is NULL.
+  @retval EFI_NOT_READY            UART BAR is not programmed or the device does not respond.
+**/
+EFI_STATUS
+EFIAPI
+PchSerialIoUartOpen (
+  IN  UINT8                      UartNumber,
+  OUT PCH_SERIAL_IO_UART_HANDLE  *Handle
+  );
+
+/**
+  Attach a transmit ring buffer to a UART handle, switching PchSerialIoUartWrite() to non-blocking mode.
+  Bytes that do not fit into the TX FIFO are queued in the ring and sent by later
+  PchSerialIoUartWrite() or PchSerialIoUartDrain() calls. When the ring is full, new bytes are dropped
+  and counted in TxDropped. Passing NULL Buffer returns the handle to blocking mode.
+
+  @param[in, out] Handle       UART handle opened by PchSerialIoUartOpen()
+  @param[in]      Buffer       Ring buffer storage, NULL to disable the ring
+  @param[in]      BufferSize   Size of Buffer in bytes
+**/
+VOID
+EFIAPI
+PchSerialIoUartSetTxRing (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     UINT8                      *Buffer,
+  IN     UINT32                     BufferSize
+  );
+
+/**
+  Write data to serial device through a cached handle.
+  In blocking mode the TX FIFO is filled in bursts of FifoDepth bytes per status check.
+  In non-blocking mode data is queued into the ring buffer and sent as far as the TX FIFO allows.
+
+  @param[in, out] Handle         UART handle opened by PchSerialIoUartOpen()
+  @param[in]      Buffer         Point of data buffer which need to be written.
+  @param[in]      NumberOfBytes  Number of output bytes which are cached in Buffer.
+
+  @retval                  Number of bytes sent or queued.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartWrite (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     UINT8                      *Buffer,
+  IN     UINTN                      NumberOfBytes
+  );
+
+/**
+  Move bytes queued in the handle's ring buffer to the TX FIFO.
+
+  @param[in, out] Handle         UART handle opened by PchSerialIoUartOpen()
+  @param[in]      WaitForEmpty   When TRUE, waits until the ring buffer is empty.
+                                 When FALSE, returns as soon as the TX FIFO is full.
+
+  @retval                  Number of bytes still queued in the ring buffer.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartDrain (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     BOOLEAN                    WaitForEmpty
+  );
 
 #endif // _PEI_DXE_SMM_PCH_SERIAL_IO_UART_LIB_H_
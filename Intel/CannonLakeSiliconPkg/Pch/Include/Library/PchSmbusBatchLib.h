@@ -0,0 +1,88 @@
+/** @file
+  Header file for the PCH SMBus transaction batch interface.
+  A batch runs a list of SMBus operations under a single host controller acquisition.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification
+**/
+#ifndef _PCH_SMBUS_BATCH_LIB_H_
+#define _PCH_SMBUS_BATCH_LIB_H_
+
+///
+/// SMBus operations supported in a batch
+///
+typedef enum {
+  SmbusBatchReadByte,   ///< Read data byte, Length 1
+  SmbusBatchWriteByte,  ///< Write data byte, Length 1
+  SmbusBatchReadWord,   ///< Read data word, Length 2, little endian in Buffer
+  SmbusBatchWriteWord,  ///< Write data word, Length 2, little endian in Buffer
+  SmbusBatchReadBlock,  ///< SMBus block read, up to 32 bytes
+  SmbusBatchWriteBlock, ///< SMBus block write, 1 to 32 bytes
+  SmbusBatchI2cRead,    ///< I2C sequential read starting at the command offset, e.g. SPD EEPROM
+  SmbusBatchOperationMax
+} SMBUS_BATCH_OPERATION;
+
+///
+/// One entry of an SMBus transaction batch
+///
+typedef struct {
+  SMBUS_BATCH_OPERATION  Operation;     ///< Operation to execute
+  UINTN                  SmBusAddress;  ///< Slave address, command and PEC encoded with SMBUS_LIB_ADDRESS (); length field must be 0
+  UINT8                  *Buffer;       ///< Data to write or buffer for data read
+  UINTN                  Length;        ///< [in] Bytes to write or size of Buffer for reads, [out] bytes transferred
+  RETURN_STATUS          Status;        ///< [out] Status of this entry
+} SMBUS_BATCH_ENTRY;
+
+/**
+  Executes a list of SMBus operations under a single acquisition of the SMBus host controller.
+
+  Each entry reports its own Status and transferred Length. Bus collisions are retried
+  before an entry is failed. When StopOnError is TRUE, the entries following a failed one
+  are not executed and report RETURN_ABORTED.
+
+  @param[in, out] Entries       Array of operations to execute
+  @param[in]      EntryCount    Number of entries in Entries
+  @param[in]      StopOnError   Stop executing the batch at the first failing entry
+
+  @retval RETURN_SUCCESS            All entries completed successfully.
+  @retval RETURN_INVALID_PARAMETER  Entries is NULL.
+  @retval RETURN_TIMEOUT            The host controller could not be acquired. No entry was executed.
+  @retval Others                    Status of the first failing entry.
+**/
+RETURN_STATUS
+EFIAPI
+SmBusExecuteBatch (
+  IN OUT SMBUS_BATCH_ENTRY  *Entries,
+  IN     UINTN              EntryCount,
+  IN     BOOLEAN            StopOnError
+  );
+
+#endif // _PCH_SMBUS_BATCH_LIB_H_
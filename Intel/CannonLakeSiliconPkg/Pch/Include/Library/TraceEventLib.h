@@ -0,0 +1,155 @@
+/** @file
+  Lightweight firmware event trace library.
+
+  Each event is a timestamped 16-bit event ID with up to four 32-bit arguments.
+  Events go to the PCH Trace Hub FW_BAR STH channel when Trace Hub is powered,
+  otherwise to a memory ring of PcdTraceEventRingSize bytes. PcdTraceEventRingBase
+  of 0 disables the ring.
+
+  PEI and DXE share a ring at PcdTraceEventRingBase. It is reserved once, after
+  permanent memory is installed, by a memory allocation HOB named
+  gTraceEventRingGuid, or by DXE when PEI did not do it; DXE publishes the base
+  as the gTraceEventRingGuid configuration table. The PEI/DXE ring must not
+  overlap any other allocation, otherwise it stays disabled.
+  SMM never writes to the fixed address. The first SMM module allocates its own
+  ring from SMRAM and publishes the base as the gTraceEventSmmRingGuid SMM
+  configuration table, which all SMM modules share.
+
+  STH output per event, on a single master/channel:
+    DnMTS (0x18) : TRACE_EVENT_STH_HEADER (EventId, ArgCount), timestamped by the hub
+    Dn    (0x00) : Arg0 .. ArgN-1, 32 bits each
+    FLAG  (0x30) : end of record
+
+  The memory ring is a TRACE_EVENT_RING_HEADER followed by TRACE_EVENT_RECORD entries.
+  Head counts every record ever written; the slot is Head % Capacity, so a reader
+  recovers the order by starting at Head - MIN (Head, Capacity). The writer always
+  recomputes Capacity from PcdTraceEventRingSize and never trusts the stored header.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+#ifndef _TRACE_EVENT_LIB_H_
+#define _TRACE_EVENT_LIB_H_
+
+#define TRACE_EVENT_MAX_ARGS              4
+
+///
+/// Event ID ranges. The upper byte selects the producing component.
+///
+#define TRACE_EVENT_CLASS_MRC             0x0100
+#define TRACE_EVENT_CLASS_HECI            0x0200
+#define TRACE_EVENT_CLASS_SMI             0x0300
+#define TRACE_EVENT_CLASS_PCIE            0x0400
+
+#define TRACE_EVENT_MRC_POST_CODE         (TRACE_EVENT_CLASS_MRC  | 0x01)   ///< Arg0: MRC post code
+#define TRACE_EVENT_MRC_CALL_IO_READ      (TRACE_EVENT_CLASS_MRC  | 0x10)   ///< Arg0: port, Arg1: value, Arg2: width in bytes
+#define TRACE_EVENT_MRC_CALL_IO_WRITE     (TRACE_EVENT_CLASS_MRC  | 0x11)   ///< Arg0: port, Arg1: value, Arg2: width in bytes
+#define TRACE_EVENT_MRC_CALL_MMIO_READ    (TRACE_EVENT_CLASS_MRC  | 0x12)   ///< Arg0: address, Arg1: value low, Arg2: value high, Arg3: width in bytes
+#define TRACE_EVENT_MRC_CALL_MMIO_WRITE   (TRACE_EVENT_CLASS_MRC  | 0x13)   ///< Arg0: address, Arg1: value low, Arg2: value high, Arg3: width in bytes
+#define TRACE_EVENT_MRC_CALL_SMBUS_READ   (TRACE_EVENT_CLASS_MRC  | 0x14)   ///< Arg0: SMBus address, Arg1: value, Arg2: width in bytes, Arg3: status
+#define TRACE_EVENT_MRC_CALL_SMBUS_WRITE  (TRACE_EVENT_CLASS_MRC  | 0x15)   ///< Arg0: SMBus address, Arg1: value, Arg2: width in bytes, Arg3: status
+#define TRACE_EVENT_MRC_CALL_MBOX_READ    (TRACE_EVENT_CLASS_MRC  | 0x16)   ///< Arg0: type, Arg1: command, Arg2: value, Arg3: mailbox status
+#define TRACE_EVENT_MRC_CALL_MBOX_WRITE   (TRACE_EVENT_CLASS_MRC  | 0x17)   ///< Arg0: type, Arg1: command, Arg2: value, Arg3: mailbox status
+#define TRACE_EVENT_MRC_CALL_MSR_READ     (TRACE_EVENT_CLASS_MRC  | 0x18)   ///< Arg0: MSR index, Arg1: value low, Arg2: value high
+#define TRACE_EVENT_MRC_CALL_MSR_WRITE    (TRACE_EVENT_CLASS_MRC  | 0x19)   ///< Arg0: MSR index, Arg1: value low, Arg2: value high
+#define TRACE_EVENT_HECI_SEND             (TRACE_EVENT_CLASS_HECI | 0x01)   ///< Arg0: HECI device, Arg1: ME address, Arg2: length
+#define TRACE_EVENT_HECI_RECEIVE          (TRACE_EVENT_CLASS_HECI | 0x02)   ///< Arg0: HECI device, Arg1: length, Arg2: status
+#define TRACE_EVENT_SMI_CALLBACK_START    (TRACE_EVENT_CLASS_SMI  | 0x01)   ///< Arg0: protocol type
+#define TRACE_EVENT_SMI_CALLBACK_END      (TRACE_EVENT_CLASS_SMI  | 0x02)   ///< Arg0: protocol type
+#define TRACE_EVENT_PCIE_RP_INIT_START    (TRACE_EVENT_CLASS_PCIE | 0x01)   ///< Arg0: max root port number
+#define TRACE_EVENT_PCIE_RP_INIT_END      (TRACE_EVENT_CLASS_PCIE | 0x02)   ///< Arg0: root port disable mask
+
+#define TRACE_EVENT_STH_MARKER            0xE7
+#define TRACE_EVENT_STH_HEADER(Id, Count) ((UINT32) (Id) | ((UINT32) (Count) << 16) | ((UINT32) TRACE_EVENT_STH_MARKER << 24))
+
+#define TRACE_EVENT_RING_SIGNATURE        SIGNATURE_32 ('T', 'E', 'V', 'R')
+
+extern EFI_GUID gTraceEventRingGuid;
+extern EFI_GUID gTraceEventSmmRingGuid;
+
+#pragma pack (push, 1)
+///
+/// One event in the memory ring. Fixed 32 bytes so a captured buffer can be
+/// decoded without any framing.
+///
+typedef struct {
+  UINT64  Timestamp;                      ///< TSC value when the event was written
+  UINT16  EventId;                        ///< TRACE_EVENT_* identifier
+  UINT8   ArgCount;                       ///< Number of valid entries in Args
+  UINT8   Reserved;
+  UINT32  Args[TRACE_EVENT_MAX_ARGS];
+  UINT32  Reserved2;
+} TRACE_EVENT_RECORD;
+
+///
+/// Header at the start of the memory ring.
+///
+typedef struct {
+  UINT32  Signature;                      ///< TRACE_EVENT_RING_SIGNATURE
+  UINT16  HeaderSize;                     ///< sizeof (TRACE_EVENT_RING_HEADER)
+  UINT16  RecordSize;                     ///< sizeof (TRACE_EVENT_RECORD)
+  UINT32  Capacity;                       ///< Number of records that fit in the ring
+  UINT32  Head;                           ///< Total number of records written
+} TRACE_EVENT_RING_HEADER;
+#pragma pack (pop)
+
+/**
+  Write one trace event.
+
+  The event goes to the Trace Hub STH channel selected by PcdTraceEventMaster and
+  PcdTraceEventChannel when Trace Hub is powered, otherwise to the memory ring.
+  If neither is available the event is dropped.
+
+  @param[in] EventId              TRACE_EVENT_* identifier
+  @param[in] ArgCount             Number of valid arguments, up to TRACE_EVENT_MAX_ARGS
+  @param[in] Arg0                 First argument
+  @param[in] Arg1                 Second argument
+  @param[in] Arg2                 Third argument
+  @param[in] Arg3                 Fourth argument
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT16                       EventId,
+  IN UINTN                        ArgCount,
+  IN UINT32                       Arg0,
+  IN UINT32                       Arg1,
+  IN UINT32                       Arg2,
+  IN UINT32                       Arg3
+  );
+
+#define TRACE_EVENT0(Id)                    TraceEventWrite ((Id), 0, 0, 0, 0, 0)
+#define TRACE_EVENT1(Id, A0)                TraceEventWrite ((Id), 1, (UINT32) (A0), 0, 0, 0)
+#define TRACE_EVENT2(Id, A0, A1)            TraceEventWrite ((Id), 2, (UINT32) (A0), (UINT32) (A1), 0, 0)
+#define TRACE_EVENT3(Id, A0, A1, A2)        TraceEventWrite ((Id), 3, (UINT32) (A0), (UINT32) (A1), (UINT32) (A2), 0)
+#define TRACE_EVENT4(Id, A0, A1, A2, A3)    TraceEventWrite ((Id), 4, (UINT32) (A0), (UINT32) (A1), (UINT32) (A2), (UINT32) (A3))
+
+#endif // _TRACE_EVENT_LIB_H_
@@ -67,6 +67,14 @@ typedef struct {
   UINTN                           ReadOp;
   UINTN                           ReadPos;
   BOOLEAN                         TransferInProgress;
+  //
+  // FIFO depths read from the controller, used to fill and drain FIFOs in bursts.
+  // ReadsPending counts read requests put in Write Fifo whose data was not yet retrieved,
+  // it is kept below RxFifoDepth so the Read Fifo can never overflow.
+  //
+  UINT32                          TxFifoDepth;
+  UINT32                          RxFifoDepth;
+  UINTN                           ReadsPending;
 } I2C_MASTER_CONTEXT;
 
 /**
@@ -135,6 +143,7 @@ UpdateReadPosition (
 
 /**
   ValidateRequest checks if Request is valid and can be started
+  The busy check is done last, EFI_ALREADY_STARTED is only returned for otherwise valid requests.
 
   @param[in] Context            driver context
   @param[in] RequestPacket      content of I2C request package
@@ -197,7 +206,8 @@ InitializeTransfer (
   Driver keeps track of which parts of Request were already committed to hardware using
   pointer consisting of WritePosition and WriteOperation variables. This pointer is updated
   every time data byte/read request is committed to FIFO
-  WriteFifo executes while there's anything more to write and the write fifo isn't full
+  WriteFifo reads the fifo level once and then fills all free entries in one burst.
+  Read requests are only issued while there is room for their data in the read fifo.
 
   @param[in] Context - driver context
 **/
@@ -214,7 +224,7 @@ WriteFifo (
   Driver keeps track where to copy incoming data using pointer consisting of
   ReadPosition and ReadOperation variables. This pointer is updated
   every time data was retrieved from hardware
-  ReadFifo executes while there's data available and receive buffers were not filled
+  ReadFifo reads the fifo level once and then drains that many entries in one burst.
 
   @param[in] Context - driver context
 **/
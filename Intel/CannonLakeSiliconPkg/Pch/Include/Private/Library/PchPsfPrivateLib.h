@@ -47,6 +47,71 @@ typedef struct {
   UINT16       RegBase;
 } PSF_PORT;
 
+//
+// PSF register programming plan.
+// A plan collects PSF register AND-OR updates, merges updates to the same register
+// and programs them ordered by PSF SideBand Port ID in one pass. It is meant for
+// sequences whose writes do not depend on each other's order (e.g. grant counts,
+// function disable or hide bits). Entries are merged as (Reg & AndMask) | OrValue.
+//
+#define PSF_REG_PLAN_MAX_ENTRIES  64
+
+typedef struct {
+  PCH_SBI_PID  PsfPid;
+  UINT8        Readback;   ///< Read back after the last write to this PsfPid
+  UINT16       Offset;
+  UINT32       AndMask;
+  UINT32       OrValue;
+} PSF_REG_PLAN_ENTRY;
+
+typedef struct {
+  UINT32              Count;
+  PSF_REG_PLAN_ENTRY  Entry[PSF_REG_PLAN_MAX_ENTRIES];
+} PSF_REG_PLAN;
+
+/**
+  Initialize an empty PSF register programming plan
+
+  @param[out] Plan     PSF register programming plan
+**/
+VOID
+PsfRegPlanInit (
+  OUT PSF_REG_PLAN  *Plan
+  );
+
+/**
+  Add a register AND-OR update to PSF register programming plan.
+  An update to a register that is already in the plan is merged into the existing entry.
+  If the plan is full it is programmed and emptied before the update is added.
+
+  @param[in, out] Plan      PSF register programming plan
+  @param[in]      PsfPid    PSF SideBand Port ID
+  @param[in]      Offset    Register offset
+  @param[in]      AndMask   AND mask
+  @param[in]      OrValue   OR value
+  @param[in]      Readback  TRUE if PSF register needs to be read back after programming
+**/
+VOID
+PsfRegPlanAdd (
+  IN OUT PSF_REG_PLAN  *Plan,
+  IN     PCH_SBI_PID   PsfPid,
+  IN     UINT16        Offset,
+  IN     UINT32        AndMask,
+  IN     UINT32        OrValue,
+  IN     BOOLEAN       Readback
+  );
+
+/**
+  Program all updates from PSF register programming plan and empty it.
+  Updates are sorted by PSF SideBand Port ID and register offset.
+
+  @param[in, out] Plan      PSF register programming plan
+**/
+VOID
+PsfRegPlanExecute (
+  IN OUT PSF_REG_PLAN  *Plan
+  );
+
 /**
   Disable device at PSF level
   Method not for bridges (e.g. PCIe Root Port)
@@ -161,6 +161,39 @@
 //
 // Resides in 'HD Audio Controller Registers' (0030h)
 //
+#define R_HDA_MEM_CORBLBASE                   0x40
+#define R_HDA_MEM_CORBUBASE                   0x44
+#define R_HDA_MEM_CORBWP                      0x48
+#define B_HDA_MEM_CORBWP_CORBWP               0x00FF
+#define R_HDA_MEM_CORBRP                      0x4A
+#define B_HDA_MEM_CORBRP_CORBRPRST            BIT15
+#define B_HDA_MEM_CORBRP_CORBRP               0x00FF
+#define R_HDA_MEM_CORBCTL                     0x4C
+#define B_HDA_MEM_CORBCTL_CORBRUN             BIT1
+#define B_HDA_MEM_CORBCTL_CMEIE               BIT0
+#define R_HDA_MEM_CORBSTS                     0x4D
+#define B_HDA_MEM_CORBSTS_CMEI                BIT0
+#define R_HDA_MEM_CORBSIZE                    0x4E
+#define B_HDA_MEM_CORBSIZE_CORBSZCAP_256      BIT6
+#define B_HDA_MEM_CORBSIZE_CORBSIZE           (BIT1 | BIT0)
+#define V_HDA_MEM_CORBSIZE_256                0x2
+#define R_HDA_MEM_RIRBLBASE                   0x50
+#define R_HDA_MEM_RIRBUBASE                   0x54
+#define R_HDA_MEM_RIRBWP                      0x58
+#define B_HDA_MEM_RIRBWP_RIRBWPRST            BIT15
+#define B_HDA_MEM_RIRBWP_RIRBWP               0x00FF
+#define R_HDA_MEM_RINTCNT                     0x5A
+#define R_HDA_MEM_RIRBCTL                     0x5C
+#define B_HDA_MEM_RIRBCTL_RIRBOIC             BIT2
+#define B_HDA_MEM_RIRBCTL_RIRBDMAEN           BIT1
+#define B_HDA_MEM_RIRBCTL_RINTCTL             BIT0
+#define R_HDA_MEM_RIRBSTS                     0x5D
+#define B_HDA_MEM_RIRBSTS_RIRBOIS             BIT2
+#define B_HDA_MEM_RIRBSTS_RINTFL              BIT0
+#define R_HDA_MEM_RIRBSIZE                    0x5E
+#define B_HDA_MEM_RIRBSIZE_RIRBSZCAP_256      BIT6
+#define B_HDA_MEM_RIRBSIZE_RIRBSIZE           (BIT1 | BIT0)
+#define V_HDA_MEM_RIRBSIZE_256                0x2
 #define R_HDA_MEM_IC                          0x60
 #define R_HDA_MEM_IR                          0x64
 #define R_HDA_MEM_ICS                         0x68
@@ -184,11 +184,12 @@
 #define    B_IC_STATUS_TFNF                    BIT1   // TX FIFO is not full
 #define    B_IC_STATUS_ACTIVITY                BIT0   // Controller Activity Status.
 
-#define    R_IC_TXFL R                       ( 0x74) // Transmit FIFO Level Register
+#define    R_IC_TXFLR                        ( 0x74) // Transmit FIFO Level Register
 #define    R_IC_RXFLR                        ( 0x78) // Receive FIFO Level Register
 #define    R_IC_SDA_HOLD                     ( 0x7C)
 #define    R_IC_TX_ABRT_SOURCE               ( 0x80) // I2c Transmit Abort Status Register
 #define    B_IC_TX_ABRT_7B_ADDR_NACK          BIT0 // NACK on 7-bit address
+#define    B_IC_TX_ABRT_ARB_LOST              BIT12 // Master lost arbitration
 
 #define    R_IC_SDA_SETUP                    ( 0x94) // I2c SDA Setup Register
 #define    R_IC_ACK_GENERAL_CALL             ( 0x98) // I2c ACK General Call Register
@@ -197,6 +198,10 @@
 
 #define    R_IC_CLK_GATE                     ( 0xC0)
 #define    R_IC_COMP_PARAM                   ( 0xF4) // Component Parameter Register
+#define    B_IC_COMP_PARAM_TX_BUFFER_DEPTH    0x00FF0000 // TX FIFO depth - 1
+#define    N_IC_COMP_PARAM_TX_BUFFER_DEPTH    16
+#define    B_IC_COMP_PARAM_RX_BUFFER_DEPTH    0x0000FF00 // RX FIFO depth - 1
+#define    N_IC_COMP_PARAM_RX_BUFFER_DEPTH    8
 #define    R_IC_COMP_VERSION                 ( 0xF8) // Component Version ID
 #define    R_IC_COMP_TYPE                    ( 0xFC) // Component Type
 
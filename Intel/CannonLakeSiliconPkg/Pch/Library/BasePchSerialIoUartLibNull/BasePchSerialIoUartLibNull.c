@@ -33,6 +33,8 @@
 @par Specification Reference:
 **/
 #include <Base.h>
+#include <Uefi/UefiBaseType.h>
+#include <Library/PchSerialIoUartLib.h>
 
 /**
   Null function of initializing selected SerialIo UART.
@@ -121,3 +123,77 @@ PchSerialIoUartPoll (
 {
   return FALSE;
 }
+
+/**
+  Null function of opening a cached handle to selected SerialIo UART.
+
+  @param  UartNumber       Selects Serial IO UART device (0-2)
+  @param  Handle           Pointer to the caller owned handle to be filled
+
+  @retval EFI_UNSUPPORTED  Always return EFI_UNSUPPORTED.
+**/
+EFI_STATUS
+EFIAPI
+PchSerialIoUartOpen (
+  IN  UINT8                      UartNumber,
+  OUT PCH_SERIAL_IO_UART_HANDLE  *Handle
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Null function of attaching a transmit ring buffer to a UART handle.
+
+  @param  Handle           UART handle
+  @param  Buffer           Ring buffer storage
+  @param  BufferSize       Size of Buffer in bytes
+**/
+VOID
+EFIAPI
+PchSerialIoUartSetTxRing (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     UINT8                      *Buffer,
+  IN     UINT32                     BufferSize
+  )
+{
+  return;
+}
+
+/**
+  Null function of writing data to serial device through a cached handle.
+
+  @param  Handle           UART handle
+  @param  Buffer           Point of data buffer which need to be written.
+  @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
+
+  @retval                  Always return 0.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartWrite (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     UINT8                      *Buffer,
+  IN     UINTN                      NumberOfBytes
+  )
+{
+  return 0;
+}
+
+/**
+  Null function of draining the handle's ring buffer.
+
+  @param  Handle           UART handle
+  @param  WaitForEmpty     Wait until the ring buffer is empty.
+
+  @retval                  Always return 0.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartDrain (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     BOOLEAN                    WaitForEmpty
+  )
+{
+  return 0;
+}
@@ -40,6 +40,8 @@
 #include <Library/PciLib.h>
 #include <Library/DebugLib.h>
 #include <Library/PciSegmentLib.h>
+#include <Library/TimerLib.h>
+#include <Library/PchSmbusBatchLib.h>
 #include <Register/PchRegs.h>
 #include <Register/PchRegsSmbus.h>
 
@@ -49,6 +51,16 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINT16           mSmbusIoBase = 0;
 #define SMBUS_STALL_RETRY  1000000
 // UPServer
 
+//
+// Batch transaction polling: a few back-to-back status reads cover short transactions,
+// then the poll interval doubles up to SMBUS_BATCH_MAX_BACKOFF_US.
+// SMBUS_BATCH_TIMEOUT_US is above the 35ms SMBus clock low timeout.
+//
+#define SMBUS_BATCH_FAST_POLLS        32
+#define SMBUS_BATCH_MAX_BACKOFF_US    64
+#define SMBUS_BATCH_TIMEOUT_US        50000
+#define SMBUS_BATCH_COLLISION_RETRY   3
+
 /**
   Gets Io port base address of Smbus Host Controller.
 
@@ -996,6 +1008,383 @@ SmBusBlockProcessCall (
            );
 }
 
+/**
+  Waits for the SMBUS host controller to report completion of the current transaction step.
+
+  Polls the Host Status Register back to back for SMBUS_BATCH_FAST_POLLS reads, then backs off
+  with a doubling delay. If the step does not complete within SMBUS_BATCH_TIMEOUT_US,
+  the transaction is killed.
+
+  @param[in]  IoPortBaseAddress   The Io port base address of Smbus Host controller.
+  @param[in]  DoneMask            Host Status Register bits that indicate completion.
+  @param[out] HostStatus          Last value read from the Host Status Register.
+
+  @retval     RETURN_SUCCESS      The step completed successfully.
+  @retval     RETURN_TIMEOUT      The step did not complete in time and was killed.
+  @retval     RETURN_CRC_ERROR    The checksum is not correct (PEC is incorrect).
+  @retval     RETURN_DEVICE_ERROR The Host Status Register reported a device error, bus error or failure.
+**/
+STATIC
+RETURN_STATUS
+InternalSmBusBatchWait (
+  IN  UINT16                  IoPortBaseAddress,
+  IN  UINT8                   DoneMask,
+  OUT UINT8                   *HostStatus
+  )
+{
+  UINT32  Polls;
+  UINT32  Delay;
+  UINT32  Elapsed;
+
+  Delay   = 1;
+  Elapsed = 0;
+  for (Polls = 0; ; Polls++) {
+    *HostStatus = IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HSTS);
+    if ((*HostStatus & (DoneMask | B_SMBUS_IO_ERROR)) != 0) {
+      break;
+    }
+    if (Polls < SMBUS_BATCH_FAST_POLLS) {
+      continue;
+    }
+    if (Elapsed >= SMBUS_BATCH_TIMEOUT_US) {
+      //
+      // Kill the hung transaction, this also sets FAIL in Host Status Register.
+      //
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HCTL, B_SMBUS_IO_KILL);
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HCTL, 0);
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HSTS, B_SMBUS_IO_HSTS_ALL & (UINT8) ~B_SMBUS_IO_IUS);
+      return RETURN_TIMEOUT;
+    }
+    MicroSecondDelay (Delay);
+    Elapsed += Delay;
+    if (Delay < SMBUS_BATCH_MAX_BACKOFF_US) {
+      Delay <<= 1;
+    }
+  }
+
+  if ((*HostStatus & B_SMBUS_IO_ERROR) == 0) {
+    return RETURN_SUCCESS;
+  }
+  //
+  // Clear error bits of Host Status Register.
+  //
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HSTS, B_SMBUS_IO_ERROR);
+  if ((IoRead8 (IoPortBaseAddress + R_SMBUS_IO_AUXS) & B_SMBUS_IO_CRCE) != 0) {
+    return RETURN_CRC_ERROR;
+  }
+
+  return RETURN_DEVICE_ERROR;
+}
+
+/**
+  Executes an SMBUS I2C read on a host controller that is already owned by the caller.
+
+  The I2C read uses the byte by byte protocol: each byte is handed over through the
+  Host Block Data Register and acknowledged by clearing BYTE_DONE_STS. LAST_BYTE is set
+  before the second to last byte is acknowledged (or with START for a one byte read), so
+  the controller NACKs the last byte and generates the stop condition.
+
+  @param[in]      IoPortBaseAddress   The Io port base address of Smbus Host controller.
+  @param[in, out] Entry               Batch entry describing the read. Length is updated with the bytes read.
+  @param[in]      Length              Number of bytes to read.
+  @param[out]     HostStatus          Last value read from the Host Status Register.
+
+  @retval The status of the read.
+**/
+STATIC
+RETURN_STATUS
+InternalSmBusBatchI2cRead (
+  IN     UINT16                  IoPortBaseAddress,
+  IN OUT SMBUS_BATCH_ENTRY       *Entry,
+  IN     UINTN                   Length,
+  OUT    UINT8                   *HostStatus
+  )
+{
+  RETURN_STATUS  ReturnStatus;
+  UINTN          Index;
+  UINT8          HostControl;
+
+  Entry->Length = 0;
+  //
+  // The 32-byte buffer must be disabled for byte by byte transfers.
+  //
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_AUXC, 0);
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_TSA, (UINT8) Entry->SmBusAddress | B_SMBUS_IO_READ);
+  //
+  // For I2C read, Host Data 1 Register holds the offset sent before the repeated start.
+  //
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HD1, (UINT8) SMBUS_LIB_COMMAND (Entry->SmBusAddress));
+
+  HostControl = V_SMBUS_IO_SMB_CMD_IIC_READ;
+  if (Length == 1) {
+    HostControl |= B_SMBUS_IO_LAST_BYTE;
+  }
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HCTL, (UINT8) (HostControl | B_SMBUS_IO_START));
+
+  for (Index = 0; Index < Length; Index++) {
+    ReturnStatus = InternalSmBusBatchWait (IoPortBaseAddress, B_SMBUS_IO_BYTE_DONE_STS, HostStatus);
+    if (RETURN_ERROR (ReturnStatus)) {
+      return ReturnStatus;
+    }
+    Entry->Buffer[Index] = IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HBD);
+    Entry->Length = Index + 1;
+    //
+    // The controller starts on the next byte as soon as BYTE_DONE_STS is cleared,
+    // so LAST_BYTE must be set before the second to last byte is acknowledged.
+    //
+    if (Index == (Length - 2)) {
+      HostControl |= B_SMBUS_IO_LAST_BYTE;
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HCTL, HostControl);
+    }
+    //
+    // Hand the Host Block Data Register back to the controller.
+    //
+    IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HSTS, B_SMBUS_IO_BYTE_DONE_STS);
+  }
+
+  return InternalSmBusBatchWait (IoPortBaseAddress, B_SMBUS_IO_INTR, HostStatus);
+}
+
+/**
+  Executes one batch entry on a host controller that is already owned by the caller.
+
+  @param[in]      IoPortBaseAddress   The Io port base address of Smbus Host controller.
+  @param[in, out] Entry               Batch entry to execute. Length is updated with the bytes transferred.
+  @param[out]     HostStatus          Last value read from the Host Status Register.
+
+  @retval The status of the entry.
+**/
+STATIC
+RETURN_STATUS
+InternalSmBusBatchEntry (
+  IN     UINT16                  IoPortBaseAddress,
+  IN OUT SMBUS_BATCH_ENTRY       *Entry,
+  OUT    UINT8                   *HostStatus
+  )
+{
+  RETURN_STATUS  ReturnStatus;
+  UINTN          Index;
+  UINTN          BytesCount;
+  UINTN          Length;
+  UINT8          HostControl;
+  UINT8          AuxiliaryControl;
+  UINT8          Read;
+
+  *HostStatus   = 0;
+  Length        = Entry->Length;
+  Entry->Length = 0;
+
+  if ((Entry->Buffer == NULL) ||
+      (SMBUS_LIB_LENGTH (Entry->SmBusAddress)   != 0) ||
+      (SMBUS_LIB_RESERVED (Entry->SmBusAddress) != 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  switch (Entry->Operation) {
+    case SmbusBatchReadByte:
+    case SmbusBatchWriteByte:
+      HostControl = V_SMBUS_IO_SMB_CMD_BYTE_DATA;
+      BytesCount  = 1;
+      break;
+    case SmbusBatchReadWord:
+    case SmbusBatchWriteWord:
+      HostControl = V_SMBUS_IO_SMB_CMD_WORD_DATA;
+      BytesCount  = 2;
+      break;
+    case SmbusBatchReadBlock:
+    case SmbusBatchWriteBlock:
+      if (Length > 32) {
+        if (Entry->Operation == SmbusBatchWriteBlock) {
+          return RETURN_INVALID_PARAMETER;
+        }
+        Length = 32;
+      }
+      HostControl = V_SMBUS_IO_SMB_CMD_BLOCK;
+      BytesCount  = Length;
+      break;
+    case SmbusBatchI2cRead:
+      HostControl = V_SMBUS_IO_SMB_CMD_IIC_READ;
+      BytesCount  = Length;
+      break;
+    default:
+      return RETURN_INVALID_PARAMETER;
+  }
+  if ((BytesCount == 0) || (Length < BytesCount)) {
+    return RETURN_BUFFER_TOO_SMALL;
+  }
+
+  if (HostControl == V_SMBUS_IO_SMB_CMD_IIC_READ) {
+    return InternalSmBusBatchI2cRead (IoPortBaseAddress, Entry, Length, HostStatus);
+  }
+
+  Read = ((Entry->Operation == SmbusBatchReadByte) ||
+          (Entry->Operation == SmbusBatchReadWord) ||
+          (Entry->Operation == SmbusBatchReadBlock)) ? B_SMBUS_IO_READ : B_SMBUS_IO_WRITE;
+
+  AuxiliaryControl = (HostControl == V_SMBUS_IO_SMB_CMD_BLOCK) ? B_SMBUS_IO_E32B : 0;
+  if (SMBUS_LIB_PEC (Entry->SmBusAddress)) {
+    AuxiliaryControl |= B_SMBUS_IO_AAC;
+  }
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HCMD, (UINT8) SMBUS_LIB_COMMAND (Entry->SmBusAddress));
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_AUXC, AuxiliaryControl);
+
+  if (Read == B_SMBUS_IO_WRITE) {
+    if (HostControl == V_SMBUS_IO_SMB_CMD_BLOCK) {
+      //
+      // Clear byte pointer of 32-byte buffer, then fill it.
+      //
+      IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HCTL);
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HD0, (UINT8) BytesCount);
+      for (Index = 0; Index < BytesCount; Index++) {
+        IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HBD, Entry->Buffer[Index]);
+      }
+    } else {
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HD0, Entry->Buffer[0]);
+      if (BytesCount == 2) {
+        IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HD1, Entry->Buffer[1]);
+      }
+    }
+  }
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_TSA, (UINT8) Entry->SmBusAddress | Read);
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HCTL, (UINT8) (HostControl + B_SMBUS_IO_START));
+
+  ReturnStatus = InternalSmBusBatchWait (IoPortBaseAddress, B_SMBUS_IO_INTR, HostStatus);
+  if (RETURN_ERROR (ReturnStatus)) {
+    return ReturnStatus;
+  }
+
+  if (Read == B_SMBUS_IO_READ) {
+    if (HostControl == V_SMBUS_IO_SMB_CMD_BLOCK) {
+      //
+      // Read the byte count, then drain the 32-byte buffer from its start.
+      //
+      BytesCount = IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HD0);
+      IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HCTL);
+      for (Index = 0; Index < BytesCount; Index++) {
+        if (Index < Length) {
+          Entry->Buffer[Index] = IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HBD);
+        } else {
+          IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HBD);
+        }
+      }
+      if (BytesCount > Length) {
+        Entry->Length = Length;
+        return RETURN_BUFFER_TOO_SMALL;
+      }
+    } else {
+      Entry->Buffer[0] = IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HD0);
+      if (BytesCount == 2) {
+        Entry->Buffer[1] = IoRead8 (IoPortBaseAddress + R_SMBUS_IO_HD1);
+      }
+    }
+  }
+  Entry->Length = BytesCount;
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Executes a list of SMBus operations under a single acquisition of the SMBus host controller.
+
+  Each entry reports its own Status and transferred Length. Bus collisions are retried
+  before an entry is failed. When StopOnError is TRUE, the entries following a failed one
+  are not executed and report RETURN_ABORTED.
+
+  @param[in, out] Entries       Array of operations to execute
+  @param[in]      EntryCount    Number of entries in Entries
+  @param[in]      StopOnError   Stop executing the batch at the first failing entry
+
+  @retval RETURN_SUCCESS            All entries completed successfully.
+  @retval RETURN_INVALID_PARAMETER  Entries is NULL.
+  @retval RETURN_TIMEOUT            The host controller could not be acquired. No entry was executed.
+  @retval Others                    Status of the first failing entry.
+**/
+RETURN_STATUS
+EFIAPI
+SmBusExecuteBatch (
+  IN OUT SMBUS_BATCH_ENTRY  *Entries,
+  IN     UINTN              EntryCount,
+  IN     BOOLEAN            StopOnError
+  )
+{
+  RETURN_STATUS  ReturnStatus;
+  RETURN_STATUS  FirstError;
+  UINT16         IoPortBaseAddress;
+  UINTN          Index;
+  UINTN          Length;
+  UINT32         StallIndex;
+  UINT32         Retry;
+  UINT8          HostStatus;
+
+  ASSERT (Entries != NULL);
+  if (Entries == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  IoPortBaseAddress = InternalGetSmbusIoPortBaseAddress ();
+
+  ReturnStatus = RETURN_NOT_READY;
+  if (IoPortBaseAddress != 0) {
+    for (StallIndex = 0; StallIndex < SMBUS_STALL_RETRY; StallIndex++) {
+      ReturnStatus = InternalSmBusAcquire (IoPortBaseAddress);
+      if (RETURN_SUCCESS == ReturnStatus) {
+        break;
+      }
+    }
+  }
+  if (RETURN_ERROR (ReturnStatus)) {
+    for (Index = 0; Index < EntryCount; Index++) {
+      Entries[Index].Status = ReturnStatus;
+      Entries[Index].Length = 0;
+    }
+    return ReturnStatus;
+  }
+
+  FirstError = RETURN_SUCCESS;
+  for (Index = 0; Index < EntryCount; Index++) {
+    if (StopOnError && RETURN_ERROR (FirstError)) {
+      Entries[Index].Status = RETURN_ABORTED;
+      Entries[Index].Length = 0;
+      continue;
+    }
+
+    Length = Entries[Index].Length;
+    for (Retry = 0; ; Retry++) {
+      Entries[Index].Length = Length;
+      ReturnStatus = InternalSmBusBatchEntry (IoPortBaseAddress, &Entries[Index], &HostStatus);
+      //
+      // Clear the completion status of this entry, keeping In Use so the controller stays owned.
+      //
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HSTS, B_SMBUS_IO_HSTS_ALL & (UINT8) ~B_SMBUS_IO_IUS);
+      IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_AUXS, B_SMBUS_IO_CRCE);
+      //
+      // Bus error means lost arbitration against another master, the transaction can be retried.
+      // Device errors (NACK) are final, the slave is absent or busy.
+      //
+      if ((ReturnStatus != RETURN_DEVICE_ERROR) ||
+          ((HostStatus & B_SMBUS_IO_BERR) == 0) ||
+          (Retry >= SMBUS_BATCH_COLLISION_RETRY)) {
+        break;
+      }
+    }
+
+    Entries[Index].Status = ReturnStatus;
+    if (RETURN_ERROR (ReturnStatus)) {
+      DEBUG ((DEBUG_VERBOSE, "SMBus batch entry %d to 0x%x failed: %r\n", (UINT32) Index, (UINT8) Entries[Index].SmBusAddress, ReturnStatus));
+      if (!RETURN_ERROR (FirstError)) {
+        FirstError = ReturnStatus;
+      }
+    }
+  }
+
+  //
+  // Release the host controller.
+  //
+  IoWrite8 (IoPortBaseAddress + R_SMBUS_IO_HSTS, B_SMBUS_IO_HSTS_ALL);
+
+  return FirstError;
+}
+
 /**
   The library constructuor.
 
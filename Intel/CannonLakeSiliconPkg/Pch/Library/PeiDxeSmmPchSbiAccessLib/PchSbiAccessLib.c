@@ -50,8 +50,8 @@
   It will clash with POST time SBI programming when SMI happen.
   Programmer MUST do the save and restore opration while using the PchSbiExecution inside SMI
   to prevent from racing condition.
-  This function will reveal P2SB and hide P2SB if it's originally hidden. If more than one SBI access
-  needed, it's better to unhide the P2SB before calling and hide it back after done.
+  The function does not reveal P2SB. P2SB must be visible before calling, otherwise
+  EFI_DEVICE_ERROR is returned. To hide P2SB again, do it after the last SBI access.
 
   When the return value is "EFI_SUCCESS", the "Response" do not need to be checked as it would have been
   SBI_SUCCESS. If the return value is "EFI_DEVICE_ERROR", then this would provide additional information
@@ -65,7 +65,7 @@
   @param[out] Response                  Response
 
   @retval EFI_SUCCESS                   Successfully completed.
-  @retval EFI_DEVICE_ERROR              Transaction fail
+  @retval EFI_DEVICE_ERROR              Transaction fail or P2SB hidden
   @retval EFI_INVALID_PARAMETER         Invalid parameter
   @retval EFI_TIMEOUT                   Timeout while waiting for response
 **/
@@ -103,54 +103,19 @@ PchSbiExecution (
 }
 
 /**
-  Full function for executing PCH SBI message
-  Take care of that there is no lock protection when using SBI programming in both POST time and SMI.
-  It will clash with POST time SBI programming when SMI happen.
-  Programmer MUST do the save and restore opration while using the PchSbiExecution inside SMI
-  to prevent from racing condition.
-  This function will reveal P2SB and hide P2SB if it's originally hidden. If more than one SBI access
-  needed, it's better to unhide the P2SB before calling and hide it back after done.
+  Check if the opcode is supported by the SBI interface
 
-  When the return value is "EFI_SUCCESS", the "Response" do not need to be checked as it would have been
-  SBI_SUCCESS. If the return value is "EFI_DEVICE_ERROR", then this would provide additional information
-  when needed.
-
-  @param[in] Pid                        Port ID of the SBI message
-  @param[in] Offset                     Offset of the SBI message
   @param[in] Opcode                     Opcode
-  @param[in] Posted                     Posted message
-  @param[in] Fbe                        First byte enable
-  @param[in] Bar                        Bar
-  @param[in] Fid                        Function ID
-  @param[in, out] Data32                Read/Write data
-  @param[out] Response                  Response
 
-  @retval EFI_SUCCESS                   Successfully completed.
-  @retval EFI_DEVICE_ERROR              Transaction fail
-  @retval EFI_INVALID_PARAMETER         Invalid parameter
-  @retval EFI_TIMEOUT                   Timeout while waiting for response
+  @retval TRUE                          Opcode is supported
+  @retval FALSE                         Opcode is not supported
 **/
-EFI_STATUS
-EFIAPI
-PchSbiExecutionEx (
-  IN     PCH_SBI_PID                    Pid,
-  IN     UINT64                         Offset,
-  IN     PCH_SBI_OPCODE                 Opcode,
-  IN     BOOLEAN                        Posted,
-  IN     UINT16                         Fbe,
-  IN     UINT16                         Bar,
-  IN     UINT16                         Fid,
-  IN OUT UINT32                         *Data32,
-  OUT    UINT8                          *Response
+STATIC
+BOOLEAN
+PchSbiIsOpcodeValid (
+  IN     PCH_SBI_OPCODE                 Opcode
   )
 {
-  UINT64                                P2sbBase;
-  UINTN                                 Timeout;
-  UINT16                                SbiStat;
-
-  //
-  // Check opcode valid
-  //
   switch (Opcode) {
     case MemoryRead:
     case MemoryWrite:
@@ -159,44 +124,96 @@ PchSbiExecutionEx (
     case PrivateControlRead:
     case PrivateControlWrite:
     case GpioLockUnlock:
-      break;
+      return TRUE;
     default:
-      return EFI_INVALID_PARAMETER;
-      break;
+      return FALSE;
   }
+}
+
+/**
+  Get P2SB PCI config base address and check that P2SB is visible
+
+  @param[out] P2sbBase                  P2SB PCI config base address
 
-  P2sbBase = PCI_SEGMENT_LIB_ADDRESS (
-               DEFAULT_PCI_SEGMENT_NUMBER_PCH,
-               DEFAULT_PCI_BUS_NUMBER_PCH,
-               PCI_DEVICE_NUMBER_PCH_P2SB,
-               PCI_FUNCTION_NUMBER_PCH_P2SB,
-               0
-               );
-  if (PciSegmentRead16 (P2sbBase + PCI_VENDOR_ID_OFFSET) == 0xFFFF) {
+  @retval EFI_SUCCESS                   P2SB is visible
+  @retval EFI_DEVICE_ERROR              P2SB is hidden or not present
+**/
+STATIC
+EFI_STATUS
+PchSbiGetP2sbBase (
+  OUT    UINT64                         *P2sbBase
+  )
+{
+  *P2sbBase = PCI_SEGMENT_LIB_ADDRESS (
+                DEFAULT_PCI_SEGMENT_NUMBER_PCH,
+                DEFAULT_PCI_BUS_NUMBER_PCH,
+                PCI_DEVICE_NUMBER_PCH_P2SB,
+                PCI_FUNCTION_NUMBER_PCH_P2SB,
+                0
+                );
+  if (PciSegmentRead16 (*P2sbBase + PCI_VENDOR_ID_OFFSET) == 0xFFFF) {
     ASSERT (FALSE);
     return EFI_DEVICE_ERROR;
   }
-  ///
-  /// BWG Section 2.2.1
-  /// 1. Poll P2SB PCI offset D8h[0] = 0b
-  /// Make sure the previous opeartion is completed.
-  ///
+  return EFI_SUCCESS;
+}
+
+/**
+  Poll P2SB PCI offset D8h[0] = 0b
+
+  @param[in]  P2sbBase                  P2SB PCI config base address
+  @param[out] SbiStat                   SBISTAT value once the interface is idle
+
+  @retval EFI_SUCCESS                   The SBI interface is idle
+  @retval EFI_TIMEOUT                   Timeout while waiting for the SBI interface
+**/
+STATIC
+EFI_STATUS
+PchSbiWaitIdle (
+  IN     UINT64                         P2sbBase,
+  OUT    UINT16                         *SbiStat
+  )
+{
+  UINTN                                 Timeout;
+
   Timeout = 0xFFFFFFF;
   while (Timeout > 0) {
-    SbiStat = PciSegmentRead16 (P2sbBase + R_P2SB_CFG_SBISTAT);
-    if ((SbiStat & B_P2SB_CFG_SBISTAT_INITRDY) == 0) {
-      break;
+    *SbiStat = PciSegmentRead16 (P2sbBase + R_P2SB_CFG_SBISTAT);
+    if ((*SbiStat & B_P2SB_CFG_SBISTAT_INITRDY) == 0) {
+      return EFI_SUCCESS;
     }
     Timeout--;
   }
-  if (Timeout == 0) {
-    return EFI_TIMEOUT;
-  }
-  //
-  // Initial Response status
-  //
-  *Response = SBI_INVALID_RESPONSE;
-  SbiStat   = 0;
+  return EFI_TIMEOUT;
+}
+
+/**
+  Program one SBI message and trigger it. The SBI interface must be idle.
+
+  @param[in] P2sbBase                   P2SB PCI config base address
+  @param[in] Pid                        Port ID of the SBI message
+  @param[in] Offset                     Offset of the SBI message
+  @param[in] Opcode                     Opcode
+  @param[in] Posted                     Posted message
+  @param[in] Fbe                        First byte enable
+  @param[in] Bar                        Bar
+  @param[in] Fid                        Function ID
+  @param[in] Data32                     Write data
+**/
+STATIC
+VOID
+PchSbiStart (
+  IN     UINT64                         P2sbBase,
+  IN     PCH_SBI_PID                    Pid,
+  IN     UINT64                         Offset,
+  IN     PCH_SBI_OPCODE                 Opcode,
+  IN     BOOLEAN                        Posted,
+  IN     UINT16                         Fbe,
+  IN     UINT16                         Bar,
+  IN     UINT16                         Fid,
+  IN     UINT32                         Data32
+  )
+{
   ///
   /// 2. Write P2SB PCI offset D0h[31:0] with Address and Destination Port ID
   ///
@@ -236,7 +253,7 @@ PchSbiExecutionEx (
       ///
       /// 4. Write P2SB PCI offset D4h[31:0] with the intended data accordingly
       ///
-      PciSegmentWrite32 ((P2sbBase + R_P2SB_CFG_SBIDATA), *Data32);
+      PciSegmentWrite32 ((P2sbBase + R_P2SB_CFG_SBIDATA), Data32);
       break;
     default:
       ///
@@ -254,44 +271,309 @@ PchSbiExecutionEx (
   // Set SBISTAT[0] = 1b, trigger the SBI operation
   //
   PciSegmentOr16 (P2sbBase + R_P2SB_CFG_SBISTAT, (UINT16) B_P2SB_CFG_SBISTAT_INITRDY);
+}
+
+/**
+  Collect the result of a completed SBI message.
+
+  @param[in]  P2sbBase                  P2SB PCI config base address
+  @param[in]  Opcode                    Opcode
+  @param[in]  SbiStat                   SBISTAT value read after completion
+  @param[out] Data32                    Read data
+  @param[out] Response                  Response
+
+  @retval EFI_SUCCESS                   Successfully completed.
+  @retval EFI_DEVICE_ERROR              Transaction fail
+**/
+STATIC
+EFI_STATUS
+PchSbiComplete (
+  IN     UINT64                         P2sbBase,
+  IN     PCH_SBI_OPCODE                 Opcode,
+  IN     UINT16                         SbiStat,
+  OUT    UINT32                         *Data32,
+  OUT    UINT8                          *Response
+  )
+{
+  ///
+  /// 8. Check if P2SB PCI offset D8h[2:1] = 00b for successful transaction
+  ///
+  *Response = (UINT8) ((SbiStat & B_P2SB_CFG_SBISTAT_RESPONSE) >> N_P2SB_CFG_SBISTAT_RESPONSE);
+  if (*Response != SBI_SUCCESSFUL) {
+    return EFI_DEVICE_ERROR;
+  }
+  switch (Opcode) {
+    case MemoryRead:
+    case PciConfigRead:
+    case PrivateControlRead:
+      ///
+      /// 9. Read P2SB PCI offset D4h[31:0] for SBI data
+      ///
+      *Data32 = PciSegmentRead32 (P2sbBase + R_P2SB_CFG_SBIDATA);
+      break;
+    default:
+      break;
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Full function for executing PCH SBI message
+  Take care of that there is no lock protection when using SBI programming in both POST time and SMI.
+  It will clash with POST time SBI programming when SMI happen.
+  Programmer MUST do the save and restore opration while using the PchSbiExecution inside SMI
+  to prevent from racing condition.
+  The function does not reveal P2SB. P2SB must be visible before calling, otherwise
+  EFI_DEVICE_ERROR is returned. To hide P2SB again, do it after the last SBI access.
+
+  When the return value is "EFI_SUCCESS", the "Response" do not need to be checked as it would have been
+  SBI_SUCCESS. If the return value is "EFI_DEVICE_ERROR", then this would provide additional information
+  when needed.
+
+  @param[in] Pid                        Port ID of the SBI message
+  @param[in] Offset                     Offset of the SBI message
+  @param[in] Opcode                     Opcode
+  @param[in] Posted                     Posted message
+  @param[in] Fbe                        First byte enable
+  @param[in] Bar                        Bar
+  @param[in] Fid                        Function ID
+  @param[in, out] Data32                Read/Write data
+  @param[out] Response                  Response
+
+  @retval EFI_SUCCESS                   Successfully completed.
+  @retval EFI_DEVICE_ERROR              Transaction fail or P2SB hidden
+  @retval EFI_INVALID_PARAMETER         Invalid parameter
+  @retval EFI_TIMEOUT                   Timeout while waiting for response
+**/
+EFI_STATUS
+EFIAPI
+PchSbiExecutionEx (
+  IN     PCH_SBI_PID                    Pid,
+  IN     UINT64                         Offset,
+  IN     PCH_SBI_OPCODE                 Opcode,
+  IN     BOOLEAN                        Posted,
+  IN     UINT16                         Fbe,
+  IN     UINT16                         Bar,
+  IN     UINT16                         Fid,
+  IN OUT UINT32                         *Data32,
+  OUT    UINT8                          *Response
+  )
+{
+  EFI_STATUS                            Status;
+  UINT64                                P2sbBase;
+  UINT16                                SbiStat;
+
   //
-  // Poll SBISTAT[0] = 0b, Polling for Busy bit
+  // Check opcode valid
   //
-  Timeout = 0xFFFFFFF;
-  while (Timeout > 0) {
-    SbiStat = PciSegmentRead16 (P2sbBase + R_P2SB_CFG_SBISTAT);
-    if ((SbiStat & B_P2SB_CFG_SBISTAT_INITRDY) == 0) {
-      break;
-    }
-    Timeout--;
+  if (!PchSbiIsOpcodeValid (Opcode)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = PchSbiGetP2sbBase (&P2sbBase);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
-  if (Timeout == 0) {
+  ///
+  /// BWG Section 2.2.1
+  /// 1. Poll P2SB PCI offset D8h[0] = 0b
+  /// Make sure the previous opeartion is completed.
+  ///
+  if (EFI_ERROR (PchSbiWaitIdle (P2sbBase, &SbiStat))) {
+    return EFI_TIMEOUT;
+  }
+  //
+  // Initial Response status
+  //
+  *Response = SBI_INVALID_RESPONSE;
+
+  PchSbiStart (P2sbBase, Pid, Offset, Opcode, Posted, Fbe, Bar, Fid, *Data32);
+  //
+  // Poll SBISTAT[0] = 0b, Polling for Busy bit
+  //
+  if (EFI_ERROR (PchSbiWaitIdle (P2sbBase, &SbiStat))) {
     //
     // If timeout, it's fatal error.
     //
     return EFI_TIMEOUT;
-  } else {
-    ///
-    /// 8. Check if P2SB PCI offset D8h[2:1] = 00b for successful transaction
-    ///
-    *Response = (UINT8) ((SbiStat & B_P2SB_CFG_SBISTAT_RESPONSE) >> N_P2SB_CFG_SBISTAT_RESPONSE);
-    if (*Response == SBI_SUCCESSFUL) {
-      switch (Opcode) {
-        case MemoryRead:
-        case PciConfigRead:
-        case PrivateControlRead:
-          ///
-          /// 9. Read P2SB PCI offset D4h[31:0] for SBI data
-          ///
-          *Data32 = PciSegmentRead32 (P2sbBase + R_P2SB_CFG_SBIDATA);
-          break;
-        default:
-          break;
-      }
-      return EFI_SUCCESS;
-    } else {
-      return EFI_DEVICE_ERROR;
-    }
   }
+  return PchSbiComplete (P2sbBase, Opcode, SbiStat, Data32, Response);
 }
 
+/**
+  Initialize an SBI batch over a caller provided entry array.
+
+  @param[out] Batch                     SBI batch
+  @param[in]  Entry                     Entry array used to queue the operations
+  @param[in]  MaxCount                  Number of entries in the array
+**/
+VOID
+EFIAPI
+PchSbiBatchInit (
+  OUT    PCH_SBI_BATCH                  *Batch,
+  IN     PCH_SBI_BATCH_ENTRY            *Entry,
+  IN     UINTN                          MaxCount
+  )
+{
+  Batch->Entry    = Entry;
+  Batch->Count    = 0;
+  Batch->MaxCount = MaxCount;
+}
+
+/**
+  Queue one SBI operation in a batch.
+
+  @param[in, out] Batch                 SBI batch
+  @param[in] Pid                        Port ID of the SBI message
+  @param[in] Offset                     Offset of the SBI message
+  @param[in] Opcode                     Opcode
+  @param[in] Posted                     Posted message
+  @param[in] Data32                     Write data, ignored for read opcodes
+
+  @retval EFI_SUCCESS                   Operation queued
+  @retval EFI_INVALID_PARAMETER         Invalid opcode
+  @retval EFI_BUFFER_TOO_SMALL          The batch is full
+**/
+EFI_STATUS
+EFIAPI
+PchSbiBatchAppend (
+  IN OUT PCH_SBI_BATCH                  *Batch,
+  IN     PCH_SBI_PID                    Pid,
+  IN     UINT64                         Offset,
+  IN     PCH_SBI_OPCODE                 Opcode,
+  IN     BOOLEAN                        Posted,
+  IN     UINT32                         Data32
+  )
+{
+  PCH_SBI_BATCH_ENTRY                   *Entry;
+
+  if (!PchSbiIsOpcodeValid (Opcode)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (Batch->Count >= Batch->MaxCount) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  Entry = &Batch->Entry[Batch->Count++];
+  Entry->Pid      = Pid;
+  Entry->Offset   = Offset;
+  Entry->Opcode   = Opcode;
+  Entry->Posted   = Posted;
+  Entry->Fbe      = 0x000F;
+  Entry->Bar      = 0x0000;
+  Entry->Fid      = 0x0000;
+  Entry->Data32   = Data32;
+  Entry->Response = SBI_INVALID_RESPONSE;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Execute all operations queued in an SBI batch back to back.
+  P2SB visibility is checked once for the batch, and the completion poll of each message
+  also serves as the idle poll of the next one. Each entry gets its own Response and,
+  for read opcodes, Data32. P2SB must be visible during the whole batch.
+
+  When SaveRestore is TRUE the SBI registers are saved before the batch and restored after it,
+  which is what an SMI handler must do to not corrupt an SBI sequence interrupted in POST.
+
+  @param[in, out] Batch                 SBI batch
+  @param[in] SaveRestore                Save and restore the SBI interface registers
+
+  @retval EFI_SUCCESS                   All entries completed successfully.
+  @retval EFI_DEVICE_ERROR              At least one entry failed, check the Response of each entry
+  @retval EFI_INVALID_PARAMETER         Invalid parameter
+  @retval EFI_TIMEOUT                   Timeout while waiting for response, remaining entries not executed
+**/
+EFI_STATUS
+EFIAPI
+PchSbiBatchExecution (
+  IN OUT PCH_SBI_BATCH                  *Batch,
+  IN     BOOLEAN                        SaveRestore
+  )
+{
+  EFI_STATUS                            Status;
+  EFI_STATUS                            EntryStatus;
+  UINT64                                P2sbBase;
+  UINT16                                SbiStat;
+  UINTN                                 Index;
+  PCH_SBI_BATCH_ENTRY                   *Entry;
+  UINT32                                SavedAddr;
+  UINT32                                SavedExtAddr;
+  UINT32                                SavedData;
+  UINT16                                SavedStat;
+  UINT16                                SavedRid;
+
+  if ((Batch == NULL) || ((Batch->Entry == NULL) && (Batch->Count != 0))) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (Batch->Count == 0) {
+    return EFI_SUCCESS;
+  }
+  for (Index = 0; Index < Batch->Count; Index++) {
+    Batch->Entry[Index].Response = SBI_INVALID_RESPONSE;
+    if (!PchSbiIsOpcodeValid (Batch->Entry[Index].Opcode)) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  Status = PchSbiGetP2sbBase (&P2sbBase);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  ///
+  /// 1. Poll P2SB PCI offset D8h[0] = 0b
+  /// Make sure the previous opeartion is completed.
+  ///
+  if (EFI_ERROR (PchSbiWaitIdle (P2sbBase, &SbiStat))) {
+    return EFI_TIMEOUT;
+  }
+
+  SavedAddr    = 0;
+  SavedExtAddr = 0;
+  SavedData    = 0;
+  SavedStat    = 0;
+  SavedRid     = 0;
+  if (SaveRestore) {
+    SavedAddr    = PciSegmentRead32 (P2sbBase + R_P2SB_CFG_SBIADDR);
+    SavedExtAddr = PciSegmentRead32 (P2sbBase + R_P2SB_CFG_SBIEXTADDR);
+    SavedData    = PciSegmentRead32 (P2sbBase + R_P2SB_CFG_SBIDATA);
+    SavedRid     = PciSegmentRead16 (P2sbBase + R_P2SB_CFG_SBIRID);
+    SavedStat    = SbiStat;
+  }
+
+  for (Index = 0; Index < Batch->Count; Index++) {
+    Entry = &Batch->Entry[Index];
+    PchSbiStart (
+      P2sbBase,
+      Entry->Pid,
+      Entry->Offset,
+      Entry->Opcode,
+      Entry->Posted,
+      Entry->Fbe,
+      Entry->Bar,
+      Entry->Fid,
+      Entry->Data32
+      );
+    if (EFI_ERROR (PchSbiWaitIdle (P2sbBase, &SbiStat))) {
+      //
+      // If timeout, it's fatal error. Do not touch the interface anymore.
+      //
+      return EFI_TIMEOUT;
+    }
+    EntryStatus = PchSbiComplete (P2sbBase, Entry->Opcode, SbiStat, &Entry->Data32, &Entry->Response);
+    if (EFI_ERROR (EntryStatus)) {
+      Status = EntryStatus;
+    }
+  }
+
+  if (SaveRestore) {
+    PciSegmentWrite32 (P2sbBase + R_P2SB_CFG_SBIADDR, SavedAddr);
+    PciSegmentWrite32 (P2sbBase + R_P2SB_CFG_SBIEXTADDR, SavedExtAddr);
+    PciSegmentWrite32 (P2sbBase + R_P2SB_CFG_SBIDATA, SavedData);
+    PciSegmentWrite16 (P2sbBase + R_P2SB_CFG_SBIRID, SavedRid);
+    PciSegmentWrite16 (P2sbBase + R_P2SB_CFG_SBISTAT, SavedStat & (UINT16) ~B_P2SB_CFG_SBISTAT_INITRDY);
+  }
+
+  return Status;
+}
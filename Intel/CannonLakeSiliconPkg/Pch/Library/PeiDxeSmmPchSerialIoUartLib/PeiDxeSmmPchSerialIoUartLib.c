@@ -67,6 +67,9 @@
 #define B_PCH_SERIAL_IO_UART_MCR_RTS      BIT1
 #define B_PCH_SERIAL_IO_UART_MCR_AFCE     BIT5
 #define B_PCH_SERIAL_IO_UART_USR_TFNF     BIT1
+#define B_PCH_SERIAL_IO_UART_USR_TFE      BIT2
+
+#define PCH_SERIAL_IO_UART_FIFO_DEPTH     64
 
 /**
   Returns UART's currently active access mode, 8 or 32 bit
@@ -221,61 +224,285 @@ PchSerialIoUartInit (
 }
 
 /**
-  Write data to serial device.
-
-  If the buffer is NULL, then return 0;
-  if NumberOfBytes is zero, then return 0.
+  Open a cached handle to selected SerialIo UART.
+  The BAR, access mode and TX FIFO depth are resolved here once, so subsequent writes through
+  the handle skip PCI config space accesses. A handle should be re-opened in every boot phase,
+  since PCI enumeration may move the BAR or clear memory space enable.
 
-  @param  UartNumber       Selects Serial IO UART device (0-2)
-  @param  Buffer           Point of data buffer which need to be writed.
-  @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
+  @param[in]  UartNumber       Selects Serial IO UART device (0-2)
+  @param[out] Handle           Pointer to the caller owned handle to be filled
 
-  @retval                  Actual number of bytes writed to serial device.
+  @retval EFI_SUCCESS              Handle is ready for use.
+  @retval EFI_INVALID_PARAMETER    Handle is NULL.
+  @retval EFI_NOT_READY            UART BAR is not programmed or the device does not respond.
 **/
-UINTN
+EFI_STATUS
 EFIAPI
-PchSerialIoUartOut (
-  IN UINT8            UartNumber,
-  IN UINT8            *Buffer,
-  IN UINTN            NumberOfBytes
+PchSerialIoUartOpen (
+  IN  UINT8                      UartNumber,
+  OUT PCH_SERIAL_IO_UART_HANDLE  *Handle
   )
 {
-  UINTN            BytesLeft;
   UINTN            Base;
   UART_ACCESS_MODE AccessMode;
 
-  if (NULL == Buffer) {
-    return 0;
+  if (Handle == NULL) {
+    return EFI_INVALID_PARAMETER;
   }
 
+  Handle->UartNumber  = UartNumber;
+  Handle->Base        = 0;
+  Handle->AccessMode  = AccessMode8bit;
+  Handle->FifoDepth   = 1;
+  Handle->TxRing      = NULL;
+  Handle->TxRingSize  = 0;
+  Handle->TxRingHead  = 0;
+  Handle->TxRingCount = 0;
+  Handle->TxDropped   = 0;
+
   Base = FindSerialIoBar (UartNumber + PchSerialIoIndexUart0, 0);
   //
   // Sanity checks to avoid infinite loop when trying to print through uninitialized UART
   //
   if ((Base & 0xFFFFFF00) == 0x0 || (Base & 0xFFFFF000) == 0xFFFFF000) {
-    return 0;
+    return EFI_NOT_READY;
   }
   EnablePciMse (UartNumber);
   AccessMode = DetectAccessMode (Base);
 
   if (ReadRegister (AccessMode, Base, R_PCH_SERIAL_IO_8BIT_UART_USR) == 0xFF) {
-    return 0;
+    return EFI_NOT_READY;
+  }
+
+  //
+  // With FIFOs disabled only the holding register is available
+  //
+  if ((ReadRegister (AccessMode, Base, R_PCH_SERIAL_IO_8BIT_UART_IIR) & (B_PCH_SERIAL_IO_UART_IIR_FIFOSE)) != 0) {
+    Handle->FifoDepth = PCH_SERIAL_IO_UART_FIFO_DEPTH;
   }
+  Handle->Base       = Base;
+  Handle->AccessMode = AccessMode;
 
-  BytesLeft = NumberOfBytes;
+  return EFI_SUCCESS;
+}
+
+/**
+  Fill the TX FIFO from a buffer.
+  When the TX FIFO is empty, up to FifoDepth bytes are written without further status checks,
+  otherwise one byte is written per TX FIFO not full indication.
+
+  @param[in]  Handle           UART handle opened by PchSerialIoUartOpen()
+  @param[in]  Buffer           Data to be sent
+  @param[in]  NumberOfBytes    Number of bytes in Buffer
+  @param[in]  Wait             When TRUE, waits until all bytes are written.
+                               When FALSE, returns as soon as the TX FIFO is full.
+
+  @retval                      Number of bytes written to the TX FIFO.
+**/
+STATIC
+UINTN
+UartTxFifoFill (
+  IN CONST PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN CONST UINT8                      *Buffer,
+  IN       UINTN                      NumberOfBytes,
+  IN       BOOLEAN                    Wait
+  )
+{
+  UINTN  Written;
+  UINTN  Burst;
+  UINT8  Usr;
 
-  while (BytesLeft != 0) {
+  Written = 0;
+  while (Written < NumberOfBytes) {
     //
-    // Write data while there's room in TXFIFO. If HW Flow Control was enabled, it happens automatically on hardware level.
+    // If HW Flow Control was enabled, it is handled on the hardware level while bytes sit in TX FIFO.
     //
-    if (ReadRegister (AccessMode, Base, R_PCH_SERIAL_IO_8BIT_UART_USR) & B_PCH_SERIAL_IO_UART_USR_TFNF) {
-      WriteRegister (AccessMode, Base, R_PCH_SERIAL_IO_8BIT_UART_TXBUF, *Buffer);
-      Buffer++;
-      BytesLeft--;
+    Usr = ReadRegister (Handle->AccessMode, Handle->Base, R_PCH_SERIAL_IO_8BIT_UART_USR);
+    if ((Usr & B_PCH_SERIAL_IO_UART_USR_TFE) != 0) {
+      Burst = MIN (Handle->FifoDepth, NumberOfBytes - Written);
+    } else if ((Usr & B_PCH_SERIAL_IO_UART_USR_TFNF) != 0) {
+      Burst = 1;
+    } else if (Wait) {
+      continue;
+    } else {
+      break;
+    }
+    for (; Burst != 0; Burst--) {
+      WriteRegister (Handle->AccessMode, Handle->Base, R_PCH_SERIAL_IO_8BIT_UART_TXBUF, Buffer[Written]);
+      Written++;
     }
   }
 
-  return NumberOfBytes;
+  return Written;
+}
+
+/**
+  Attach a transmit ring buffer to a UART handle, switching PchSerialIoUartWrite() to non-blocking mode.
+  Bytes that do not fit into the TX FIFO are queued in the ring and sent by later
+  PchSerialIoUartWrite() or PchSerialIoUartDrain() calls. When the ring is full, new bytes are dropped
+  and counted in TxDropped. Passing NULL Buffer returns the handle to blocking mode.
+
+  @param[in, out] Handle       UART handle opened by PchSerialIoUartOpen()
+  @param[in]      Buffer       Ring buffer storage, NULL to disable the ring
+  @param[in]      BufferSize   Size of Buffer in bytes
+**/
+VOID
+EFIAPI
+PchSerialIoUartSetTxRing (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     UINT8                      *Buffer,
+  IN     UINT32                     BufferSize
+  )
+{
+  if (Handle == NULL) {
+    return;
+  }
+  //
+  // Do not lose what is still queued in the ring being replaced
+  //
+  if (Handle->Base != 0) {
+    PchSerialIoUartDrain (Handle, TRUE);
+  }
+  if ((Buffer == NULL) || (BufferSize == 0)) {
+    Buffer     = NULL;
+    BufferSize = 0;
+  }
+  Handle->TxRing      = Buffer;
+  Handle->TxRingSize  = BufferSize;
+  Handle->TxRingHead  = 0;
+  Handle->TxRingCount = 0;
+}
+
+/**
+  Move bytes queued in the handle's ring buffer to the TX FIFO.
+
+  @param[in, out] Handle         UART handle opened by PchSerialIoUartOpen()
+  @param[in]      WaitForEmpty   When TRUE, waits until the ring buffer is empty.
+                                 When FALSE, returns as soon as the TX FIFO is full.
+
+  @retval                  Number of bytes still queued in the ring buffer.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartDrain (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     BOOLEAN                    WaitForEmpty
+  )
+{
+  UINT32  Contiguous;
+  UINT32  Sent;
+
+  if ((Handle == NULL) || (Handle->Base == 0) || (Handle->TxRing == NULL)) {
+    return 0;
+  }
+
+  while (Handle->TxRingCount != 0) {
+    Contiguous = MIN (Handle->TxRingCount, Handle->TxRingSize - Handle->TxRingHead);
+    Sent = (UINT32) UartTxFifoFill (Handle, &Handle->TxRing[Handle->TxRingHead], Contiguous, WaitForEmpty);
+    Handle->TxRingHead  += Sent;
+    Handle->TxRingCount -= Sent;
+    if (Handle->TxRingHead == Handle->TxRingSize) {
+      Handle->TxRingHead = 0;
+    }
+    if (Sent < Contiguous) {
+      break;
+    }
+  }
+
+  return Handle->TxRingCount;
+}
+
+/**
+  Write data to serial device through a cached handle.
+  In blocking mode the TX FIFO is filled in bursts of FifoDepth bytes per status check.
+  In non-blocking mode data is queued into the ring buffer and sent as far as the TX FIFO allows.
+
+  @param[in, out] Handle         UART handle opened by PchSerialIoUartOpen()
+  @param[in]      Buffer         Point of data buffer which need to be written.
+  @param[in]      NumberOfBytes  Number of output bytes which are cached in Buffer.
+
+  @retval                  Number of bytes sent or queued.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartWrite (
+  IN OUT PCH_SERIAL_IO_UART_HANDLE  *Handle,
+  IN     UINT8                      *Buffer,
+  IN     UINTN                      NumberOfBytes
+  )
+{
+  UINTN   Sent;
+  UINTN   Queued;
+  UINTN   Index;
+  UINT32  Tail;
+
+  if ((Handle == NULL) || (Buffer == NULL) || (Handle->Base == 0)) {
+    return 0;
+  }
+
+  if (Handle->TxRing == NULL) {
+    return UartTxFifoFill (Handle, Buffer, NumberOfBytes, TRUE);
+  }
+
+  //
+  // Non-blocking mode. Older queued bytes go out first to keep the output in order.
+  //
+  Sent = 0;
+  if (PchSerialIoUartDrain (Handle, FALSE) == 0) {
+    Sent = UartTxFifoFill (Handle, Buffer, NumberOfBytes, FALSE);
+  }
+
+  Queued = MIN (NumberOfBytes - Sent, (UINTN) (Handle->TxRingSize - Handle->TxRingCount));
+  Handle->TxDropped += (UINT32) (NumberOfBytes - Sent - Queued);
+
+  Tail = (Handle->TxRingHead + Handle->TxRingCount) % Handle->TxRingSize;
+  Handle->TxRingCount += (UINT32) Queued;
+  for (Index = 0; Index < Queued; Index++) {
+    Handle->TxRing[Tail] = Buffer[Sent + Index];
+    Tail++;
+    if (Tail == Handle->TxRingSize) {
+      Tail = 0;
+    }
+  }
+
+  return Sent + Queued;
+}
+
+/**
+  Write data to serial device.
+
+  If the buffer is NULL, then return 0;
+  if NumberOfBytes is zero, then return 0.
+
+  @param  UartNumber       Selects Serial IO UART device (0-2)
+  @param  Buffer           Point of data buffer which need to be writed.
+  @param  NumberOfBytes    Number of output bytes which are cached in Buffer.
+
+  @retval                  Actual number of bytes writed to serial device.
+**/
+UINTN
+EFIAPI
+PchSerialIoUartOut (
+  IN UINT8            UartNumber,
+  IN UINT8            *Buffer,
+  IN UINTN            NumberOfBytes
+  )
+{
+  PCH_SERIAL_IO_UART_HANDLE  Handle;
+
+  if (NULL == Buffer) {
+    return 0;
+  }
+
+  //
+  // The library keeps no state between calls, so resolve the UART every time.
+  // Callers printing often should keep a handle from PchSerialIoUartOpen() instead.
+  //
+  if (EFI_ERROR (PchSerialIoUartOpen (UartNumber, &Handle))) {
+    return 0;
+  }
+
+  return PchSerialIoUartWrite (&Handle, Buffer, NumberOfBytes);
 }
 
 /*
@@ -0,0 +1,125 @@
+/** @file
+  DXE phase hook of the Trace Event Lib.
+  The memory ring is only written when it was reserved by PEI or could be
+  allocated at PcdTraceEventRingBase by this phase.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+#include <PiDxe.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/HobLib.h>
+#include <Library/PcdLib.h>
+#include <Library/TraceEventLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include "TraceEventLibInternal.h"
+
+STATIC UINTN                      mTraceEventRingBase = 0;
+
+/**
+  Return the base of the memory ring that may be written in the current phase.
+
+  @param[in]  RingSize            Size of the ring in bytes, from PcdTraceEventRingSize
+  @param[out] RingBase            Base address of the ring
+
+  @retval TRUE                    The ring at RingBase is reserved for trace events
+  @retval FALSE                   Events must not go to a memory ring
+**/
+BOOLEAN
+TraceEventRingLocate (
+  IN  UINTN                       RingSize,
+  OUT UINTN                       *RingBase
+  )
+{
+  *RingBase = mTraceEventRingBase;
+  return (BOOLEAN) (mTraceEventRingBase != 0);
+}
+
+/**
+  The constructor function finds or reserves the memory ring.
+
+  The ring reserved by PEI through the gTraceEventRingGuid memory allocation HOB is used
+  as is. Otherwise the first DXE module allocates the pages at PcdTraceEventRingBase and
+  publishes them as the gTraceEventRingGuid configuration table for the other modules.
+
+  @param[in]  ImageHandle         The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable         A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS             The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+DxeTraceEventLibConstructor (
+  IN EFI_HANDLE                   ImageHandle,
+  IN EFI_SYSTEM_TABLE             *SystemTable
+  )
+{
+  EFI_STATUS                      Status;
+  EFI_PEI_HOB_POINTERS            Hob;
+  EFI_PHYSICAL_ADDRESS            Base;
+  UINTN                           RingSize;
+  VOID                            *Table;
+
+  mTraceEventRingBase = 0;
+  Base     = PcdGet32 (PcdTraceEventRingBase);
+  RingSize = PcdGet32 (PcdTraceEventRingSize);
+  if ((Base == 0) || ((Base & EFI_PAGE_MASK) != 0) || (RingSize == 0) || ((RingSize & EFI_PAGE_MASK) != 0)) {
+    return EFI_SUCCESS;
+  }
+
+  Hob.Raw = GetHobList ();
+  while ((Hob.Raw = GetNextHob (EFI_HOB_TYPE_MEMORY_ALLOCATION, Hob.Raw)) != NULL) {
+    if (CompareGuid (&Hob.MemoryAllocation->AllocDescriptor.Name, &gTraceEventRingGuid)) {
+      mTraceEventRingBase = (UINTN) Hob.MemoryAllocation->AllocDescriptor.MemoryBaseAddress;
+      return EFI_SUCCESS;
+    }
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  Status = EfiGetSystemConfigurationTable (&gTraceEventRingGuid, &Table);
+  if (!EFI_ERROR (Status)) {
+    mTraceEventRingBase = (UINTN) Table;
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->AllocatePages (AllocateAddress, EfiReservedMemoryType, EFI_SIZE_TO_PAGES (RingSize), &Base);
+  if (EFI_ERROR (Status)) {
+    return EFI_SUCCESS;
+  }
+  Status = gBS->InstallConfigurationTable (&gTraceEventRingGuid, (VOID *) (UINTN) Base);
+  if (EFI_ERROR (Status)) {
+    gBS->FreePages (Base, EFI_SIZE_TO_PAGES (RingSize));
+    return EFI_SUCCESS;
+  }
+  mTraceEventRingBase = (UINTN) Base;
+  return EFI_SUCCESS;
+}
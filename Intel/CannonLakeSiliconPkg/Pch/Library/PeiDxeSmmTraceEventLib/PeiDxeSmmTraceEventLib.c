@@ -0,0 +1,196 @@
+/** @file
+  Pei/Dxe/Smm Trace Event Lib.
+  Writes timestamped firmware events to the PCH Trace Hub or to a memory ring.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+#include <Uefi/UefiBaseType.h>
+#include <Library/BaseLib.h>
+#include <Library/IoLib.h>
+#include <Library/PcdLib.h>
+#include <Library/TraceEventLib.h>
+#include <PchReservedResources.h>
+#include <Register/PchRegsTraceHub.h>
+#include "TraceEventLibInternal.h"
+
+//
+// STH channel register offsets inside one 0x40 byte FW_BAR channel window
+//
+#define R_TRACE_HUB_STH_CHANNEL_D32       0x00
+#define R_TRACE_HUB_STH_CHANNEL_D32_MTS   0x18
+#define R_TRACE_HUB_STH_CHANNEL_FLAG      0x30
+#define TRACE_HUB_STH_CHANNEL_SIZE        0x40
+
+/**
+  Return the FW_BAR address of the trace event STH channel.
+  Follows the same Master/Channel mapping as TraceHubMmioTraceAddress().
+
+  @retval 0                       Trace Hub is power gated or not decoded
+  @retval Other                   Address of the channel
+**/
+STATIC
+UINTN
+TraceEventSthAddress (
+  VOID
+  )
+{
+  if (MmioRead32 (PCH_TRACE_HUB_FW_BASE_ADDRESS) == 0xFFFFFFFF) {
+    return 0;
+  }
+  return PCH_TRACE_HUB_FW_BASE_ADDRESS +
+         TRACE_HUB_STH_CHANNEL_SIZE * (V_TRACE_HUB_MEM_MTB_CHLCNT * (PcdGet16 (PcdTraceEventMaster) - V_TRACE_HUB_MEM_MTB_FTHMSTR) + PcdGet16 (PcdTraceEventChannel));
+}
+
+/**
+  Return the memory ring record slot for the next event and advance Head.
+
+  The ring base comes from the phase specific TraceEventRingLocate(). Capacity and
+  the record offset are always derived from PcdTraceEventRingSize, never read back
+  from the ring. The header is rewritten whenever it does not match.
+
+  @retval NULL                    No ring configured, ring too small, or ring not usable in this phase
+  @retval Other                   Pointer to the record slot
+**/
+STATIC
+TRACE_EVENT_RECORD *
+TraceEventNextRecord (
+  VOID
+  )
+{
+  TRACE_EVENT_RING_HEADER         *Ring;
+  UINTN                           RingBase;
+  UINTN                           RingSize;
+  UINT32                          Capacity;
+  UINT32                          Head;
+  UINTN                           RecordAddress;
+
+  RingSize = (UINTN) PcdGet32 (PcdTraceEventRingSize);
+  if ((PcdGet32 (PcdTraceEventRingBase) == 0) ||
+      (RingSize < sizeof (TRACE_EVENT_RING_HEADER) + sizeof (TRACE_EVENT_RECORD))) {
+    return NULL;
+  }
+  if (!TraceEventRingLocate (RingSize, &RingBase) ||
+      (RingBase == 0) ||
+      (RingSize - 1 > MAX_UINTN - RingBase)) {
+    return NULL;
+  }
+
+  Ring     = (TRACE_EVENT_RING_HEADER *) RingBase;
+  Capacity = (UINT32) ((RingSize - sizeof (TRACE_EVENT_RING_HEADER)) / sizeof (TRACE_EVENT_RECORD));
+  if ((Ring->Signature != TRACE_EVENT_RING_SIGNATURE) ||
+      (Ring->HeaderSize != sizeof (TRACE_EVENT_RING_HEADER)) ||
+      (Ring->RecordSize != sizeof (TRACE_EVENT_RECORD)) ||
+      (Ring->Capacity != Capacity)) {
+    Ring->HeaderSize = sizeof (TRACE_EVENT_RING_HEADER);
+    Ring->RecordSize = sizeof (TRACE_EVENT_RECORD);
+    Ring->Capacity   = Capacity;
+    Ring->Head       = 0;
+    Ring->Signature  = TRACE_EVENT_RING_SIGNATURE;
+  }
+
+  //
+  // Read Head once so a concurrent writer of the header cannot move the slot after the check.
+  //
+  Head          = Ring->Head;
+  RecordAddress = RingBase + sizeof (TRACE_EVENT_RING_HEADER) + (UINTN) (Head % Capacity) * sizeof (TRACE_EVENT_RECORD);
+  if ((RecordAddress < RingBase) || (RecordAddress - RingBase > RingSize - sizeof (TRACE_EVENT_RECORD))) {
+    return NULL;
+  }
+  Ring->Head = Head + 1;
+  return (TRACE_EVENT_RECORD *) RecordAddress;
+}
+
+/**
+  Write one trace event.
+
+  The event goes to the Trace Hub STH channel selected by PcdTraceEventMaster and
+  PcdTraceEventChannel when Trace Hub is powered, otherwise to the memory ring when
+  the current phase allows it. If neither is available the event is dropped.
+
+  @param[in] EventId              TRACE_EVENT_* identifier
+  @param[in] ArgCount             Number of valid arguments, up to TRACE_EVENT_MAX_ARGS
+  @param[in] Arg0                 First argument
+  @param[in] Arg1                 Second argument
+  @param[in] Arg2                 Third argument
+  @param[in] Arg3                 Fourth argument
+**/
+VOID
+EFIAPI
+TraceEventWrite (
+  IN UINT16                       EventId,
+  IN UINTN                        ArgCount,
+  IN UINT32                       Arg0,
+  IN UINT32                       Arg1,
+  IN UINT32                       Arg2,
+  IN UINT32                       Arg3
+  )
+{
+  UINT32                          Args[TRACE_EVENT_MAX_ARGS];
+  UINTN                           SthAddress;
+  UINTN                           Index;
+  TRACE_EVENT_RECORD              *Record;
+
+  if (ArgCount > TRACE_EVENT_MAX_ARGS) {
+    ArgCount = TRACE_EVENT_MAX_ARGS;
+  }
+  Args[0] = Arg0;
+  Args[1] = Arg1;
+  Args[2] = Arg2;
+  Args[3] = Arg3;
+
+  SthAddress = TraceEventSthAddress ();
+  if (SthAddress != 0) {
+    //
+    // The hub timestamps the header write, so no TSC read is needed on this path.
+    //
+    MmioWrite32 (SthAddress + R_TRACE_HUB_STH_CHANNEL_D32_MTS, TRACE_EVENT_STH_HEADER (EventId, ArgCount));
+    for (Index = 0; Index < ArgCount; Index++) {
+      MmioWrite32 (SthAddress + R_TRACE_HUB_STH_CHANNEL_D32, Args[Index]);
+    }
+    MmioWrite32 (SthAddress + R_TRACE_HUB_STH_CHANNEL_FLAG, 0);
+    return;
+  }
+
+  Record = TraceEventNextRecord ();
+  if (Record == NULL) {
+    return;
+  }
+
+  Record->Timestamp = AsmReadTsc ();
+  Record->EventId   = EventId;
+  Record->ArgCount  = (UINT8) ArgCount;
+  Record->Reserved  = 0;
+  for (Index = 0; Index < TRACE_EVENT_MAX_ARGS; Index++) {
+    Record->Args[Index] = (Index < ArgCount) ? Args[Index] : 0;
+  }
+  Record->Reserved2 = 0;
+}
@@ -0,0 +1,123 @@
+/** @file
+  PEI phase hook of the Trace Event Lib.
+  The memory ring is only written once permanent memory is installed and the
+  ring has been reserved with a memory allocation HOB named gTraceEventRingGuid.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+#include <PiPei.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/HobLib.h>
+#include <Library/PcdLib.h>
+#include <Library/PeiServicesLib.h>
+#include <Library/TraceEventLib.h>
+#include <Ppi/MemoryDiscovered.h>
+#include "TraceEventLibInternal.h"
+
+/**
+  Return the base of the memory ring that may be written in the current phase.
+
+  The ring at PcdTraceEventRingBase is reserved on first use with a memory allocation
+  HOB named gTraceEventRingGuid, so DXE keeps it out of the memory map. It is not
+  used when it is not page aligned, overlaps another memory allocation HOB or the
+  PEI memory handed out by the PEI core, or before permanent memory is installed.
+
+  @param[in]  RingSize            Size of the ring in bytes, from PcdTraceEventRingSize
+  @param[out] RingBase            Base address of the ring
+
+  @retval TRUE                    The ring at RingBase is reserved for trace events
+  @retval FALSE                   Events must not go to a memory ring
+**/
+BOOLEAN
+TraceEventRingLocate (
+  IN  UINTN                       RingSize,
+  OUT UINTN                       *RingBase
+  )
+{
+  EFI_STATUS                      Status;
+  VOID                            *MemoryDiscoveredPpi;
+  EFI_PEI_HOB_POINTERS            Hob;
+  EFI_HOB_MEMORY_ALLOCATION       *AllocationHob;
+  EFI_PHYSICAL_ADDRESS            Base;
+  EFI_PHYSICAL_ADDRESS            Limit;
+
+  Status = PeiServicesLocatePpi (
+             &gEfiPeiMemoryDiscoveredPpiGuid,
+             0,
+             NULL,
+             &MemoryDiscoveredPpi
+             );
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Base  = PcdGet32 (PcdTraceEventRingBase);
+  Limit = Base + RingSize;
+  if (((Base & EFI_PAGE_MASK) != 0) || ((RingSize & EFI_PAGE_MASK) != 0)) {
+    return FALSE;
+  }
+
+  //
+  // Use the ring reserved earlier, refuse it when anything else owns part of it
+  //
+  Hob.Raw = GetHobList ();
+  while ((Hob.Raw = GetNextHob (EFI_HOB_TYPE_MEMORY_ALLOCATION, Hob.Raw)) != NULL) {
+    if (CompareGuid (&Hob.MemoryAllocation->AllocDescriptor.Name, &gTraceEventRingGuid)) {
+      *RingBase = (UINTN) Hob.MemoryAllocation->AllocDescriptor.MemoryBaseAddress;
+      return TRUE;
+    }
+    if ((Base < Hob.MemoryAllocation->AllocDescriptor.MemoryBaseAddress + Hob.MemoryAllocation->AllocDescriptor.MemoryLength) &&
+        (Hob.MemoryAllocation->AllocDescriptor.MemoryBaseAddress < Limit)) {
+      return FALSE;
+    }
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  Hob.Raw = GetHobList ();
+  if ((Base < Hob.HandoffInformationTable->EfiMemoryTop) &&
+      (Hob.HandoffInformationTable->EfiMemoryBottom < Limit)) {
+    return FALSE;
+  }
+
+  Status = PeiServicesCreateHob (EFI_HOB_TYPE_MEMORY_ALLOCATION, sizeof (EFI_HOB_MEMORY_ALLOCATION), (VOID **) &AllocationHob);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+  CopyGuid (&AllocationHob->AllocDescriptor.Name, &gTraceEventRingGuid);
+  AllocationHob->AllocDescriptor.MemoryBaseAddress = Base;
+  AllocationHob->AllocDescriptor.MemoryLength      = RingSize;
+  AllocationHob->AllocDescriptor.MemoryType        = EfiReservedMemoryType;
+  ZeroMem (AllocationHob->AllocDescriptor.Reserved, sizeof (AllocationHob->AllocDescriptor.Reserved));
+
+  *RingBase = (UINTN) Base;
+  return TRUE;
+}
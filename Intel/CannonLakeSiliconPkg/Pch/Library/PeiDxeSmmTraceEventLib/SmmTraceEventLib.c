@@ -0,0 +1,111 @@
+/** @file
+  SMM phase hook of the Trace Event Lib.
+  SMM never writes to the fixed PcdTraceEventRingBase address. The first SMM module
+  allocates a ring from SMRAM and publishes it as the gTraceEventSmmRingGuid SMM
+  configuration table, every other SMM module uses that ring.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+#include <PiSmm.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/PcdLib.h>
+#include <Library/SmmServicesTableLib.h>
+#include <Library/TraceEventLib.h>
+#include "TraceEventLibInternal.h"
+
+STATIC UINTN                      mTraceEventRingBase = 0;
+
+/**
+  Return the base of the memory ring that may be written in the current phase.
+
+  @param[in]  RingSize            Size of the ring in bytes, from PcdTraceEventRingSize
+  @param[out] RingBase            Base address of the ring
+
+  @retval TRUE                    The SMRAM ring is available
+  @retval FALSE                   No SMRAM ring could be allocated
+**/
+BOOLEAN
+TraceEventRingLocate (
+  IN  UINTN                       RingSize,
+  OUT UINTN                       *RingBase
+  )
+{
+  *RingBase = mTraceEventRingBase;
+  return (BOOLEAN) (mTraceEventRingBase != 0);
+}
+
+/**
+  The constructor function finds or allocates the SMRAM ring.
+
+  @param[in]  ImageHandle         The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable         A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS             The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+SmmTraceEventLibConstructor (
+  IN EFI_HANDLE                   ImageHandle,
+  IN EFI_SYSTEM_TABLE             *SystemTable
+  )
+{
+  EFI_STATUS                      Status;
+  EFI_PHYSICAL_ADDRESS            Base;
+  UINTN                           RingSize;
+  UINTN                           Index;
+
+  mTraceEventRingBase = 0;
+  RingSize = PcdGet32 (PcdTraceEventRingSize);
+  if ((PcdGet32 (PcdTraceEventRingBase) == 0) || (RingSize == 0)) {
+    return EFI_SUCCESS;
+  }
+
+  for (Index = 0; Index < gSmst->NumberOfTableEntries; Index++) {
+    if (CompareGuid (&gSmst->SmmConfigurationTable[Index].VendorGuid, &gTraceEventSmmRingGuid)) {
+      mTraceEventRingBase = (UINTN) gSmst->SmmConfigurationTable[Index].VendorTable;
+      return EFI_SUCCESS;
+    }
+  }
+
+  Status = gSmst->SmmAllocatePages (AllocateAnyPages, EfiRuntimeServicesData, EFI_SIZE_TO_PAGES (RingSize), &Base);
+  if (EFI_ERROR (Status)) {
+    return EFI_SUCCESS;
+  }
+  ZeroMem ((VOID *) (UINTN) Base, RingSize);
+  Status = gSmst->SmmInstallConfigurationTable (gSmst, &gTraceEventSmmRingGuid, (VOID *) (UINTN) Base, RingSize);
+  if (EFI_ERROR (Status)) {
+    gSmst->SmmFreePages (Base, EFI_SIZE_TO_PAGES (RingSize));
+    return EFI_SUCCESS;
+  }
+  mTraceEventRingBase = (UINTN) Base;
+  return EFI_SUCCESS;
+}
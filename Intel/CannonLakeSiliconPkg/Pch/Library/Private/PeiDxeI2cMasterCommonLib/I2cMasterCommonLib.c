@@ -176,9 +176,6 @@ ValidateRequest (
   UINTN Operation;
   UINTN OperationSize;
 
-  if (Context->TransferInProgress) {
-    return EFI_ALREADY_STARTED;
-  }
   if (RequestPacket == NULL) {
     return EFI_INVALID_PARAMETER;
   }
@@ -217,6 +214,10 @@ ValidateRequest (
   if (TotalSize > Context->Capabilities.MaximumTotalBytes) {
     return EFI_BAD_BUFFER_SIZE;
   }
+  // checked last, so EFI_ALREADY_STARTED also means the request itself is valid
+  if (Context->TransferInProgress) {
+    return EFI_ALREADY_STARTED;
+  }
 
   return EFI_SUCCESS;
 }
@@ -277,6 +278,7 @@ InitializeTransfer (
 {
   UINT32 Attempts = 10000;
   UINT32 Address;
+  UINT32 CompParam;
 
   Context->Request = (EFI_I2C_REQUEST_PACKET*) RequestPacket;
   Context->TransferStatus = EFI_SUCCESS;
@@ -285,6 +287,19 @@ InitializeTransfer (
   Context->ReadOp = 0;
   FindReadOp (Context);
   Context->ReadPos = 0;
+  Context->ReadsPending = 0;
+
+  CompParam = MmioRead32 (Context->MmioAddress + R_IC_COMP_PARAM);
+  if ((CompParam == 0) || (CompParam == 0xFFFFFFFF)) {
+    //
+    // Parameter register not implemented, fall back to one entry at a time
+    //
+    Context->TxFifoDepth = 1;
+    Context->RxFifoDepth = 1;
+  } else {
+    Context->TxFifoDepth = ((CompParam & B_IC_COMP_PARAM_TX_BUFFER_DEPTH) >> N_IC_COMP_PARAM_TX_BUFFER_DEPTH) + 1;
+    Context->RxFifoDepth = ((CompParam & B_IC_COMP_PARAM_RX_BUFFER_DEPTH) >> N_IC_COMP_PARAM_RX_BUFFER_DEPTH) + 1;
+  }
 
   if (MmioRead32 (Context->MmioAddress + R_IC_ENABLE) != 0) {
     DEBUG (( DEBUG_ERROR, "Address change was attempted while a transfer was underway!\n"));
@@ -323,7 +338,8 @@ InitializeTransfer (
   Driver keeps track of which parts of Request were already committed to hardware using
   pointer consisting of WritePosition and WriteOperation variables. This pointer is updated
   every time data byte/read request is committed to FIFO
-  WriteFifo executes while there's anything more to write and the write fifo isn't full
+  WriteFifo reads the fifo level once and then fills all free entries in one burst.
+  Read requests are only issued while there is room for their data in the read fifo.
 
   @param[in] Context - driver context
 **/
@@ -333,12 +349,21 @@ WriteFifo (
   )
 {
   UINT32 Data;
-  while ( MmioRead32 (Context->MmioAddress + R_IC_STATUS ) & B_IC_STATUS_TFNF) {
+  UINT32 Level;
+  UINT32 Room;
+
+  Level = MmioRead32 (Context->MmioAddress + R_IC_TXFLR);
+  Room  = (Level < Context->TxFifoDepth) ? (Context->TxFifoDepth - Level) : 0;
+  for (; Room != 0; Room--) {
     if (Context->WriteOp >= Context->Request->OperationCount ) {
       return; // request complete, nothing more to write
     }
 
     if (Context->Request->Operation[Context->WriteOp].Flags & I2C_FLAG_READ) {
+      if (Context->ReadsPending >= Context->RxFifoDepth) {
+        return; // read fifo could overflow, wait until it is drained
+      }
+      Context->ReadsPending++;
       Data = B_IC_CMD_READ;
     } else {
       Data = Context->Request->Operation[Context->WriteOp].Buffer[Context->WritePos];
@@ -362,7 +387,7 @@ WriteFifo (
   Driver keeps track where to copy incoming data using pointer consisting of
   ReadPosition and ReadOperation variables. This pointer is updated
   every time data was retrieved from hardware
-  ReadFifo executes while there's data available and receive buffers were not filled
+  ReadFifo reads the fifo level once and then drains that many entries in one burst.
 
   @param[in] Context - driver context
 **/
@@ -371,11 +396,14 @@ ReadFifo (
   I2C_MASTER_CONTEXT *Context
   )
 {
-  while ( MmioRead32 ( Context->MmioAddress + R_IC_STATUS ) & B_IC_STATUS_RFNE) {
+  UINT32 Level;
+
+  for (Level = MmioRead32 (Context->MmioAddress + R_IC_RXFLR); Level != 0; Level--) {
     if ( Context->ReadOp >= Context->Request->OperationCount ) {
       return;
     }
     Context->Request->Operation[Context->ReadOp].Buffer[Context->ReadPos] = (0xFF & MmioRead32 (Context->MmioAddress + R_IC_DATA_CMD));
+    Context->ReadsPending--;
     UpdateReadPosition (Context);
   }
 }
@@ -390,15 +418,23 @@ CheckErrors (
   I2C_MASTER_CONTEXT *Context
   )
 {
+  UINT32 AbortSource;
+
   if (!(MmioRead32 (Context->MmioAddress + R_IC_INTR_STAT) & B_IC_INTR_TX_ABRT)) {
     return;
   }
-  if (MmioRead32 (Context->MmioAddress + R_IC_TX_ABRT_SOURCE) & B_IC_TX_ABRT_7B_ADDR_NACK) {
+  AbortSource = MmioRead32 (Context->MmioAddress + R_IC_TX_ABRT_SOURCE);
+  if (AbortSource & B_IC_TX_ABRT_ARB_LOST) {
+    //
+    // Another master won the bus, the transfer itself was not rejected and can be retried.
+    //
+    Context->TransferStatus = EFI_ABORTED;
+  } else if (AbortSource & B_IC_TX_ABRT_7B_ADDR_NACK) {
     Context->TransferStatus = EFI_NO_RESPONSE;
   } else {
     Context->TransferStatus = EFI_DEVICE_ERROR;
   }
-  DEBUG (( DEBUG_INFO, "I2c CheckErrors: %08x\n", MmioRead32 (Context->MmioAddress + R_IC_TX_ABRT_SOURCE)));
+  DEBUG (( DEBUG_INFO, "I2c CheckErrors: %08x\n", AbortSource));
 }
 
 /**
@@ -810,6 +810,132 @@ PsfIsPcieRootPortEnabled (
   return PsfIsBridgeEnabled (PsfRootPciePort (RpIndex));
 }
 
+/**
+  Initialize an empty PSF register programming plan
+
+  @param[out] Plan     PSF register programming plan
+**/
+VOID
+PsfRegPlanInit (
+  OUT PSF_REG_PLAN  *Plan
+  )
+{
+  Plan->Count = 0;
+}
+
+/**
+  Add a register AND-OR update to PSF register programming plan.
+  An update to a register that is already in the plan is merged into the existing entry.
+  If the plan is full it is programmed and emptied before the update is added.
+
+  @param[in, out] Plan      PSF register programming plan
+  @param[in]      PsfPid    PSF SideBand Port ID
+  @param[in]      Offset    Register offset
+  @param[in]      AndMask   AND mask
+  @param[in]      OrValue   OR value
+  @param[in]      Readback  TRUE if PSF register needs to be read back after programming
+**/
+VOID
+PsfRegPlanAdd (
+  IN OUT PSF_REG_PLAN  *Plan,
+  IN     PCH_SBI_PID   PsfPid,
+  IN     UINT16        Offset,
+  IN     UINT32        AndMask,
+  IN     UINT32        OrValue,
+  IN     BOOLEAN       Readback
+  )
+{
+  UINT32              Index;
+  PSF_REG_PLAN_ENTRY  *Entry;
+
+  for (Index = 0; Index < Plan->Count; Index++) {
+    Entry = &Plan->Entry[Index];
+    if ((Entry->PsfPid == PsfPid) && (Entry->Offset == Offset)) {
+      //
+      // ((Reg & A1) | O1) & A2 | O2 == (Reg & (A1 & A2)) | ((O1 & A2) | O2)
+      //
+      Entry->OrValue   = (Entry->OrValue & AndMask) | OrValue;
+      Entry->AndMask  &= AndMask;
+      Entry->Readback |= (UINT8) Readback;
+      return;
+    }
+  }
+
+  if (Plan->Count == PSF_REG_PLAN_MAX_ENTRIES) {
+    DEBUG ((DEBUG_WARN, "PSF register plan full, programming %d entries early\n", Plan->Count));
+    PsfRegPlanExecute (Plan);
+  }
+
+  Entry = &Plan->Entry[Plan->Count++];
+  Entry->PsfPid   = PsfPid;
+  Entry->Offset   = Offset;
+  Entry->AndMask  = AndMask;
+  Entry->OrValue  = OrValue;
+  Entry->Readback = (UINT8) Readback;
+}
+
+/**
+  Program all updates from PSF register programming plan and empty it.
+  Updates are sorted by PSF SideBand Port ID and register offset.
+
+  @param[in, out] Plan      PSF register programming plan
+**/
+VOID
+PsfRegPlanExecute (
+  IN OUT PSF_REG_PLAN  *Plan
+  )
+{
+  UINT32              Index;
+  UINT32              Sorted;
+  UINT32              GroupEnd;
+  BOOLEAN             GroupReadback;
+  PSF_REG_PLAN_ENTRY  Key;
+  PSF_REG_PLAN_ENTRY  *Entry;
+
+  //
+  // Plans are small, insertion sort by (PsfPid, Offset)
+  //
+  for (Sorted = 1; Sorted < Plan->Count; Sorted++) {
+    Key = Plan->Entry[Sorted];
+    Index = Sorted;
+    while ((Index > 0) &&
+           ((Plan->Entry[Index - 1].PsfPid > Key.PsfPid) ||
+            ((Plan->Entry[Index - 1].PsfPid == Key.PsfPid) && (Plan->Entry[Index - 1].Offset > Key.Offset)))) {
+      Plan->Entry[Index] = Plan->Entry[Index - 1];
+      Index--;
+    }
+    Plan->Entry[Index] = Key;
+  }
+
+  GroupEnd = 0;
+  GroupReadback = FALSE;
+  for (Index = 0; Index < Plan->Count; Index++) {
+    Entry = &Plan->Entry[Index];
+    if (Index == GroupEnd) {
+      //
+      // First entry for this PsfPid, find the last one and whether read back is needed
+      //
+      GroupReadback = FALSE;
+      while ((GroupEnd < Plan->Count) && (Plan->Entry[GroupEnd].PsfPid == Entry->PsfPid)) {
+        GroupReadback |= (BOOLEAN) (Plan->Entry[GroupEnd].Readback != 0);
+        GroupEnd++;
+      }
+    }
+
+    if (GroupReadback && (Index == GroupEnd - 1)) {
+      //
+      // Read back is needed to enforce the sideband and primary ordering.
+      // Sideband writes to one port are ordered, so only the last write is read back.
+      //
+      PchPcrAndThenOr32WithReadback (Entry->PsfPid, Entry->Offset, Entry->AndMask, Entry->OrValue);
+    } else {
+      PchPcrAndThenOr32 (Entry->PsfPid, Entry->Offset, Entry->AndMask, Entry->OrValue);
+    }
+  }
+
+  Plan->Count = 0;
+}
+
 /**
   PSF PCIe channel grant counts
 
@@ -860,6 +986,7 @@ PsfPcieChannelGrantCounts (
   @param[in] PsfTopology              PSF Topology for PCIe controller for which grant counts are to be programmed
   @param[in] PsfPcieCtrlConfigTable   Table with PCIe controllers configuration
   @param[in] NumberOfPcieControllers  Number of PCIe controllers. This is also the size of PsfPcieCtrlConfig table
+  @param[in, out] Plan                PSF register programming plan the grant counts are added to
 
   @retval GrantCount  GrantCount value that was programmed for given PSF Port (PsfPort)
 **/
@@ -868,7 +995,8 @@ UINT32
 PsfSetPcieControllerGrantCount (
   IN CONST PSF_TOPOLOGY    *PsfTopology,
   IN PSF_PCIE_CTRL_CONFIG  *PsfPcieCtrlConfigTable,
-  IN UINT32                NumberOfPcieControllers
+  IN UINT32                NumberOfPcieControllers,
+  IN OUT PSF_REG_PLAN      *Plan
   )
 {
   UINT8                DgcrNo;
@@ -904,19 +1032,23 @@ PsfSetPcieControllerGrantCount (
     PsfPcieGrantCountNumber (Controller, Channel, &DgcrNo, &PgTgtNo);
 
     DEBUG ((DEBUG_INFO, "SP%c[%d] - DGCR%d = %d\n", 'A' + Controller, Channel, DgcrNo, ChannelGrant[Channel]));
-    PchPcrAndThenOr32 (
+    PsfRegPlanAdd (
+      Plan,
       GrantCountReg.PsfPid,
       (UINT16) (GrantCountReg.DevGntCnt0Base + (DgcrNo * S_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR)),
       (UINT32) ~B_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR_GNT_CNT_RELOAD,
-      ChannelGrant[Channel]
+      ChannelGrant[Channel],
+      FALSE
       );
 
     DEBUG ((DEBUG_INFO, "SP%c[%d] - PG1_TGT%d = %d\n", 'A' + Controller, Channel, PgTgtNo, ChannelGrant[Channel]));
-    PchPcrAndThenOr32 (
+    PsfRegPlanAdd (
+      Plan,
       GrantCountReg.PsfPid,
       (UINT16) (GrantCountReg.TargetGntCntPg1Tgt0Base + (PgTgtNo * S_PCH_PSFX_PCR_TARGET_GNTCNT_RELOAD)),
       (UINT32) ~B_PCH_PSFX_PCR_TARGET_GNTCNT_RELOAD_GNT_CNT_RELOAD,
-      ChannelGrant[Channel]
+      ChannelGrant[Channel],
+      FALSE
       );
 
     if (PsfIsPcieRootPortEnabled (Channel + Controller * PCH_PCIE_CONTROLLER_PORTS)) {
@@ -932,6 +1064,7 @@ PsfSetPcieControllerGrantCount (
   @param[in] PsfTopology           PSF Topology for PSF-to-PSF port for which Grant Counts are to be programmed
 
   @param[in] GrantCount            GrantCount value that is to be programmed for given PSF Port
+  @param[in, out] Plan             PSF register programming plan the grant counts are added to
 
   @retval GrantCount  GrantCount value that was programmed for given PSF Port (PsfPort)
 **/
@@ -939,7 +1072,8 @@ STATIC
 UINT32
 PsfSetSegmentGrantCounts (
   IN CONST PSF_TOPOLOGY   *PsfTopology,
-  IN UINT32               GrantCount
+  IN UINT32               GrantCount,
+  IN OUT PSF_REG_PLAN     *Plan
   )
 {
   UINT32               GrantCountMax;
@@ -953,19 +1087,23 @@ PsfSetSegmentGrantCounts (
   PsfSegmentGrantCountNumber (PsfTopology->PsfPort, &DgcrNo, &PgTgtNo);
 
   DEBUG ((DEBUG_INFO, "PSF%d - DGCR%d = %d\n", PsfTopology->PsfPort.PortId, DgcrNo, GrantCountMax));
-  PchPcrAndThenOr32 (
+  PsfRegPlanAdd (
+    Plan,
     GrantCountReg.PsfPid,
     (UINT16) (GrantCountReg.DevGntCnt0Base + (DgcrNo * S_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR)),
     (UINT32) ~B_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR_GNT_CNT_RELOAD,
-    GrantCountMax
+    GrantCountMax,
+    FALSE
     );
 
   DEBUG ((DEBUG_INFO, "PSF%d - PG1_TGT%d = %d\n", PsfTopology->PsfPort.PortId, PgTgtNo, GrantCountMax));
-  PchPcrAndThenOr32 (
+  PsfRegPlanAdd (
+    Plan,
     GrantCountReg.PsfPid,
     (UINT16) (GrantCountReg.TargetGntCntPg1Tgt0Base + (PgTgtNo * S_PCH_PSFX_PCR_TARGET_GNTCNT_RELOAD)),
     (UINT32) ~B_PCH_PSFX_PCR_TARGET_GNTCNT_RELOAD_GNT_CNT_RELOAD,
-    GrantCountMax
+    GrantCountMax,
+    FALSE
     );
 
   return GrantCountMax;
@@ -979,6 +1117,7 @@ PsfSetSegmentGrantCounts (
   @param[in] PsfTopology              PSF Topology for which grant counts are to be programmed
   @param[in] PsfPcieCtrlConfigTable   Table with PCIe controllers configuration
   @param[in] NumberOfPcieControllers  Number of PCIe controllers. This is also the size of PsfPcieCtrlConfig table
+  @param[in, out] Plan                PSF register programming plan the grant counts are added to
 
   @retval GrantCount  GrantCount value that was programmed for given PSF Port (PsfPort)
 **/
@@ -987,7 +1126,8 @@ UINT32
 PsfTopologyConfigurePcieGrantCounts (
   IN CONST PSF_TOPOLOGY    *PsfTopology,
   IN PSF_PCIE_CTRL_CONFIG  *PsfPcieCtrlConfigTable,
-  IN UINT32                NumberOfPcieControllers
+  IN UINT32                NumberOfPcieControllers,
+  IN OUT PSF_REG_PLAN      *Plan
   )
 {
   UINT32               GrantCount;
@@ -1004,7 +1144,8 @@ PsfTopologyConfigurePcieGrantCounts (
     GrantCount = PsfSetPcieControllerGrantCount (
                    PsfTopology,
                    PsfPcieCtrlConfigTable,
-                   NumberOfPcieControllers
+                   NumberOfPcieControllers,
+                   Plan
                    );
   } else if (PsfTopology->PortType == PsfToPsfPort) {
 
@@ -1014,7 +1155,8 @@ PsfTopologyConfigurePcieGrantCounts (
       GrantCount += PsfTopologyConfigurePcieGrantCounts (
                       ChildSegment,
                       PsfPcieCtrlConfigTable,
-                      NumberOfPcieControllers
+                      NumberOfPcieControllers,
+                      Plan
                       );
 
       ChildSegment++;
@@ -1023,7 +1165,8 @@ PsfTopologyConfigurePcieGrantCounts (
     if (!PSF_IS_TOPO_PORT_NULL (PsfTopology->PsfPort) && GrantCount > 0) {
       GrantCount = PsfSetSegmentGrantCounts (
                      PsfTopology,
-                     GrantCount
+                     GrantCount,
+                     Plan
                      );
     }
   }
@@ -1043,13 +1186,18 @@ PsfConfigurePcieGrantCounts (
   IN UINT32                NumberOfPcieControllers
   )
 {
+  PSF_REG_PLAN  Plan;
+
   DEBUG ((DEBUG_INFO, "PsfConfigurePcieGrantCounts() Start\n"));
 
+  PsfRegPlanInit (&Plan);
   PsfTopologyConfigurePcieGrantCounts (
     PsfGetRootPciePsfTopology (),
     PsfPcieCtrlConfigTable,
-    NumberOfPcieControllers
+    NumberOfPcieControllers,
+    &Plan
     );
+  PsfRegPlanExecute (&Plan);
 
   DEBUG ((DEBUG_INFO, "PsfConfigurePcieGrantCounts() End\n"));
 }
@@ -465,10 +465,11 @@ PsfConfigureSataGrantCounts (
   //     VR    -> PSF_4_DEV_GNTCNT_RELOAD_DGCR2
   //     VS0-7 -> PSF_4_DEV_GNTCNT_RELOAD_DGCR3-10
   //
-  UINT16  Dgcr0Addr;
-  UINT8   DgcrMinIndex;
-  UINT8   DgcrMaxIndex;
-  UINT8   DgcrIndex;
+  UINT16        Dgcr0Addr;
+  UINT8         DgcrMinIndex;
+  UINT8         DgcrMaxIndex;
+  UINT8         DgcrIndex;
+  PSF_REG_PLAN  Plan;
 
   if (IsPchLp ()) {
     Dgcr0Addr = R_CNL_PCH_LP_PSF4_PCR_DEV_GNTCNT_RELOAD_DGCR0;
@@ -480,14 +481,18 @@ PsfConfigureSataGrantCounts (
     DgcrMaxIndex = 10;
   }
 
+  PsfRegPlanInit (&Plan);
   for (DgcrIndex = DgcrMinIndex; DgcrIndex <= DgcrMaxIndex; DgcrIndex++) {
-    PchPcrAndThenOr32 (
+    PsfRegPlanAdd (
+      &Plan,
       PID_PSF4,
-      Dgcr0Addr  + (DgcrIndex * S_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR),
+      (UINT16) (Dgcr0Addr + (DgcrIndex * S_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR)),
       (UINT32) ~B_PCH_PSFX_PCR_DEV_GNTCNT_RELOAD_DGCR_GNT_CNT_RELOAD,
-      0x1
+      0x1,
+      FALSE
       );
   }
+  PsfRegPlanExecute (&Plan);
 }
 
 /**
@@ -35,6 +35,7 @@
 #include <Library/IoLib.h>
 #include <Library/DebugLib.h>
 #include <Library/TimerLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/PeiServicesLib.h>
 #include <IndustryStandard/Pci30.h>
 #include <Library/PchCycleDecodingLib.h>
@@ -68,6 +69,41 @@
 #define HDA_SDI_1_HDALINK            1
 #define HDA_SDI_2_IDISPLINK          2
 
+///
+/// CORB/RIRB command ring layout: a 256 entry CORB (1KB) followed by a 256 entry RIRB (2KB),
+/// both within a single page so the 128-byte base alignment required by the controller is met.
+///
+#define HDA_CMD_RING_ENTRIES         256
+#define HDA_CMD_RING_PTR_MASK        (HDA_CMD_RING_ENTRIES - 1)
+#define HDA_CMD_RING_MAX_OUTSTANDING (HDA_CMD_RING_ENTRIES - 1)
+#define HDA_CMD_RING_CORB_OFFSET     0x000
+#define HDA_CMD_RING_RIRB_OFFSET     0x400
+#define HDA_CMD_RING_PAGES           1
+
+///
+/// Response Input Ring Buffer entry
+///
+typedef struct {
+  UINT32  Response;
+  UINT32  ResponseEx;                 ///< [3:0] Codec address, [4] Unsolicited response
+} HDA_RIRB_ENTRY;
+
+#define B_HDA_RIRB_RESPONSE_EX_CAD   0x0F
+#define B_HDA_RIRB_RESPONSE_EX_UNSOL BIT4
+
+///
+/// CORB/RIRB command ring state
+///
+typedef struct {
+  UINT64          HdaPciBase;
+  UINT32          HdaBar;
+  UINT32          *Corb;
+  HDA_RIRB_ENTRY  *Rirb;
+  UINT16          CorbWp;
+  UINT16          RirbRp;
+  UINT16          PciCommand;
+} HDA_CMD_RING;
+
 /**
   Polling the Status bit.
   Maximum polling time (us) equals HDA_MAX_LOOP_TIME * HDA_WAIT_PERIOD.
@@ -231,6 +267,220 @@ SendCodecCommand (
   return EFI_SUCCESS;
 }
 
+/**
+  Stops the CORB and RIRB DMA engines and restores the PCI command register.
+
+  @param[in] Ring                       CORB/RIRB command ring state
+
+  @retval EFI_SUCCESS                   Both DMA engines are stopped
+  @retval EFI_TIMEOUT                   DMA engine did not report stopped state in time
+**/
+EFI_STATUS
+HdaCmdRingStop (
+  IN      HDA_CMD_RING    *Ring
+  )
+{
+  EFI_STATUS  Status;
+  EFI_STATUS  RirbStatus;
+
+  MmioAnd8 ((UINTN) (Ring->HdaBar + R_HDA_MEM_CORBCTL), (UINT8) ~(B_HDA_MEM_CORBCTL_CORBRUN | B_HDA_MEM_CORBCTL_CMEIE));
+  MmioAnd8 ((UINTN) (Ring->HdaBar + R_HDA_MEM_RIRBCTL), (UINT8) ~(B_HDA_MEM_RIRBCTL_RIRBDMAEN | B_HDA_MEM_RIRBCTL_RINTCTL | B_HDA_MEM_RIRBCTL_RIRBOIC));
+
+  Status     = StatusPolling (Ring->HdaBar + R_HDA_MEM_CORBCTL, B_HDA_MEM_CORBCTL_CORBRUN, 0, HDA_WAIT_PERIOD);
+  RirbStatus = StatusPolling (Ring->HdaBar + R_HDA_MEM_RIRBCTL, B_HDA_MEM_RIRBCTL_RIRBDMAEN, 0, HDA_WAIT_PERIOD);
+
+  MmioWrite8 ((UINTN) (Ring->HdaBar + R_HDA_MEM_CORBSTS), (UINT8) B_HDA_MEM_CORBSTS_CMEI);
+  MmioWrite8 ((UINTN) (Ring->HdaBar + R_HDA_MEM_RIRBSTS), (UINT8) (B_HDA_MEM_RIRBSTS_RIRBOIS | B_HDA_MEM_RIRBSTS_RINTFL));
+
+  PciSegmentWrite16 (Ring->HdaPciBase + PCI_COMMAND_OFFSET, Ring->PciCommand);
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  return RirbStatus;
+}
+
+/**
+  Programs the CORB/RIRB ring buffers and starts both DMA engines.
+  While the ring is running the Immediate Command interface must not be used.
+
+  @param[out] Ring                      CORB/RIRB command ring state
+  @param[in]  HdaPciBase                PCI Configuration Space Base Address
+  @param[in]  HdaBar                    Base address of Intel HD Audio memory mapped configuration registers
+  @param[in]  RingBuffer                Page aligned buffer of HDA_CMD_RING_PAGES pages
+
+  @retval EFI_SUCCESS                   The ring is running
+  @retval EFI_UNSUPPORTED               Controller does not support 256 entry rings
+  @retval EFI_TIMEOUT                   Controller did not respond to the ring programming
+**/
+EFI_STATUS
+HdaCmdRingStart (
+  OUT     HDA_CMD_RING    *Ring,
+  IN      UINT64          HdaPciBase,
+  IN      UINT32          HdaBar,
+  IN      VOID            *RingBuffer
+  )
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  CorbBase;
+  EFI_PHYSICAL_ADDRESS  RirbBase;
+
+  if (((MmioRead8 (HdaBar + R_HDA_MEM_CORBSIZE) & B_HDA_MEM_CORBSIZE_CORBSZCAP_256) == 0) ||
+      ((MmioRead8 (HdaBar + R_HDA_MEM_RIRBSIZE) & B_HDA_MEM_RIRBSIZE_RIRBSZCAP_256) == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  CorbBase = (EFI_PHYSICAL_ADDRESS) (UINTN) RingBuffer + HDA_CMD_RING_CORB_OFFSET;
+  RirbBase = (EFI_PHYSICAL_ADDRESS) (UINTN) RingBuffer + HDA_CMD_RING_RIRB_OFFSET;
+
+  Ring->HdaPciBase = HdaPciBase;
+  Ring->HdaBar     = HdaBar;
+  Ring->Corb       = (UINT32 *) (UINTN) CorbBase;
+  Ring->Rirb       = (HDA_RIRB_ENTRY *) (UINTN) RirbBase;
+  Ring->CorbWp     = 0;
+  Ring->RirbRp     = 0;
+  Ring->PciCommand = PciSegmentRead16 (HdaPciBase + PCI_COMMAND_OFFSET);
+
+  ///
+  /// Both engines must be stopped before the base, size and pointer registers are changed.
+  /// PciCommand is captured first so HdaCmdRingStop() restores it on the error paths below.
+  ///
+  Status = HdaCmdRingStop (Ring);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ///
+  /// Rings are fetched and written by the controller, enable bus mastering for the ring lifetime.
+  ///
+  PciSegmentOr16 (HdaPciBase + PCI_COMMAND_OFFSET, (UINT16) EFI_PCI_COMMAND_BUS_MASTER);
+
+  MmioWrite32 (HdaBar + R_HDA_MEM_CORBLBASE, (UINT32) CorbBase);
+  MmioWrite32 (HdaBar + R_HDA_MEM_CORBUBASE, (UINT32) RShiftU64 (CorbBase, 32));
+  MmioAndThenOr8 ((UINTN) (HdaBar + R_HDA_MEM_CORBSIZE), (UINT8) ~B_HDA_MEM_CORBSIZE_CORBSIZE, V_HDA_MEM_CORBSIZE_256);
+  MmioWrite32 (HdaBar + R_HDA_MEM_RIRBLBASE, (UINT32) RirbBase);
+  MmioWrite32 (HdaBar + R_HDA_MEM_RIRBUBASE, (UINT32) RShiftU64 (RirbBase, 32));
+  MmioAndThenOr8 ((UINTN) (HdaBar + R_HDA_MEM_RIRBSIZE), (UINT8) ~B_HDA_MEM_RIRBSIZE_RIRBSIZE, V_HDA_MEM_RIRBSIZE_256);
+
+  ///
+  /// Reset CORB Read Pointer: set CORBRPRST, wait until it reads back as 1, then clear it and
+  /// wait until it reads back as 0. CORBRP sits in the upper word of the DWORD at CORBWP.
+  ///
+  MmioWrite16 (HdaBar + R_HDA_MEM_CORBRP, (UINT16) B_HDA_MEM_CORBRP_CORBRPRST);
+  Status = StatusPolling (HdaBar + R_HDA_MEM_CORBWP, (UINT32) B_HDA_MEM_CORBRP_CORBRPRST << 16, (UINT32) B_HDA_MEM_CORBRP_CORBRPRST << 16, HDA_WAIT_PERIOD);
+  if (!EFI_ERROR (Status)) {
+    MmioWrite16 (HdaBar + R_HDA_MEM_CORBRP, 0);
+    Status = StatusPolling (HdaBar + R_HDA_MEM_CORBWP, (UINT32) B_HDA_MEM_CORBRP_CORBRPRST << 16, 0, HDA_WAIT_PERIOD);
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "HDA: CORB read pointer reset failed!\n"));
+    HdaCmdRingStop (Ring);
+    return Status;
+  }
+  MmioWrite16 (HdaBar + R_HDA_MEM_CORBWP, 0);
+
+  ///
+  /// Reset RIRB Write Pointer (RIRBWPRST is write-only and self clearing)
+  ///
+  MmioWrite16 (HdaBar + R_HDA_MEM_RIRBWP, (UINT16) B_HDA_MEM_RIRBWP_RIRBWPRST);
+
+  MmioOr8 ((UINTN) (HdaBar + R_HDA_MEM_RIRBCTL), (UINT8) B_HDA_MEM_RIRBCTL_RIRBDMAEN);
+  MmioOr8 ((UINTN) (HdaBar + R_HDA_MEM_CORBCTL), (UINT8) B_HDA_MEM_CORBCTL_CORBRUN);
+
+  Status = StatusPolling (HdaBar + R_HDA_MEM_RIRBCTL, B_HDA_MEM_RIRBCTL_RIRBDMAEN, B_HDA_MEM_RIRBCTL_RIRBDMAEN, HDA_WAIT_PERIOD);
+  if (!EFI_ERROR (Status)) {
+    Status = StatusPolling (HdaBar + R_HDA_MEM_CORBCTL, B_HDA_MEM_CORBCTL_CORBRUN, B_HDA_MEM_CORBCTL_CORBRUN, HDA_WAIT_PERIOD);
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "HDA: CORB/RIRB DMA engine start failed!\n"));
+    HdaCmdRingStop (Ring);
+    return Status;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Streams a list of verbs to the codec through the CORB and collects their responses from the RIRB.
+  Up to HDA_CMD_RING_MAX_OUTSTANDING verbs are queued at once, so the RIRB can never overflow.
+  Responses are not returned, only counted - verb tables carry no read back.
+
+  @param[in]  Ring                      Running CORB/RIRB command ring
+  @param[in]  Verbs                     Verbs to be sent, without the CAd field
+  @param[in]  VerbCount                 Number of verbs
+  @param[in]  CodecSdiNum               SDI number to which codec is connected
+  @param[in]  WaitPeriod                The minimum period between response polls
+  @param[out] Completed                 Number of leading verbs the codec has responded to
+
+  @retval EFI_SUCCESS                   All verbs have been sent and responded to
+  @retval EFI_TIMEOUT                   Codec did not respond to all verbs in time
+**/
+EFI_STATUS
+HdaCmdRingSendVerbs (
+  IN      HDA_CMD_RING    *Ring,
+  IN      CONST UINT32    *Verbs,
+  IN      UINT32          VerbCount,
+  IN      UINT8           CodecSdiNum,
+  IN      UINT32          WaitPeriod,
+  OUT     UINT32          *Completed
+  )
+{
+  UINT32          Sent;
+  UINT32          Chunk;
+  UINT32          Index;
+  UINT32          Received;
+  UINT32          LoopTime;
+  UINT16          RirbWp;
+  HDA_RIRB_ENTRY  *Entry;
+
+  Sent = 0;
+  while (Sent < VerbCount) {
+    Chunk = MIN (VerbCount - Sent, HDA_CMD_RING_MAX_OUTSTANDING);
+
+    ///
+    /// Controller fetches entries following CORBRP up to and including CORBWP
+    ///
+    for (Index = 0; Index < Chunk; Index++) {
+      ASSERT ((Verbs[Sent + Index] >> 28) == 0);
+      Ring->CorbWp = (Ring->CorbWp + 1) & HDA_CMD_RING_PTR_MASK;
+      Ring->Corb[Ring->CorbWp] = Verbs[Sent + Index] | ((UINT32) CodecSdiNum << 28);
+    }
+    MemoryFence ();
+    MmioWrite16 (Ring->HdaBar + R_HDA_MEM_CORBWP, Ring->CorbWp);
+
+    Received = 0;
+    for (LoopTime = 0; (Received < Chunk) && (LoopTime < Chunk * HDA_MAX_LOOP_TIME); ) {
+      RirbWp = MmioRead16 (Ring->HdaBar + R_HDA_MEM_RIRBWP) & B_HDA_MEM_RIRBWP_RIRBWP;
+      if (RirbWp == Ring->RirbRp) {
+        MicroSecondDelay (WaitPeriod);
+        LoopTime++;
+        continue;
+      }
+      while (Ring->RirbRp != RirbWp) {
+        Ring->RirbRp = (Ring->RirbRp + 1) & HDA_CMD_RING_PTR_MASK;
+        Entry = &Ring->Rirb[Ring->RirbRp];
+        if ((Entry->ResponseEx & B_HDA_RIRB_RESPONSE_EX_UNSOL) != 0) {
+          continue;
+        }
+        ASSERT ((Entry->ResponseEx & B_HDA_RIRB_RESPONSE_EX_CAD) == CodecSdiNum);
+        Received++;
+      }
+    }
+
+    ///
+    /// Responses come back in order, so the received count identifies the verbs that completed
+    ///
+    Sent += Received;
+    if (Received < Chunk) {
+      *Completed = Sent;
+      return EFI_TIMEOUT;
+    }
+  }
+
+  *Completed = Sent;
+  return EFI_SUCCESS;
+}
+
 /**
   Checks if connected codec supports statically switchable BCLK clock frequency.
 
@@ -744,13 +994,17 @@ GetCodecId (
 
 /**
   For each codec, a predefined codec verb table should be programmed.
+  The table is streamed through the CORB/RIRB rings when a ring buffer is provided,
+  the Immediate Command interface is used for the verbs that were not completed by the rings.
 
   @param[in]  HdaBar               Memory Space Base Address
+  @param[in]  HdaPciBase           PCI Configuration Space Base Address
   @param[in]  HdaConfig            HD-A Configuration
   @param[in]  AzaliaSdiNum         Azalia SDI Line Number
   @param[in]  WaitPeriod           The minimum period between sending next data
   @param[in]  CodecVendorId        Codec Vendor Id
   @param[in]  CodecRevisionId      Codec Revision Id
+  @param[in]  RingBuffer           CORB/RIRB ring buffer, NULL to use the Immediate Command interface only
 
   @retval EFI_SUCCESS              The function completed successfully
   @retval EFI_UNSUPPORTED          Verb table for codec does not exist
@@ -758,15 +1012,18 @@ GetCodecId (
 EFI_STATUS
 MatchAndSendCodecVerbTable (
   IN  UINT32                 HdaBar,
+  IN  UINT64                 HdaPciBase,
   IN  PCH_HDAUDIO_CONFIG     *HdaConfig,
   IN  UINT8                  AzaliaSdiNum,
   IN  UINT32                 WaitPeriod,
   OUT UINT32                 CodecVendorId,
-  OUT UINT32                 CodecRevisionId
+  OUT UINT32                 CodecRevisionId,
+  IN  VOID                   *RingBuffer
   )
 {
   EFI_STATUS                 Status;
   HDAUDIO_VERB_TABLE         *VerbTable;
+  HDA_CMD_RING               Ring;
   UINT32                     CodecCmdData;
   UINT32                     Index;
 
@@ -789,11 +1046,27 @@ MatchAndSendCodecVerbTable (
           VerbTable->Header.SdiNum,
           VerbTable->Header.DataDwords));
 
+  Index = 0;
+
+  ///
+  /// Stream the verb table through the CORB/RIRB rings
+  ///
+  if (RingBuffer != NULL) {
+    Status = HdaCmdRingStart (&Ring, HdaPciBase, HdaBar, RingBuffer);
+    if (!EFI_ERROR (Status)) {
+      Status = HdaCmdRingSendVerbs (&Ring, VerbTable->Data, VerbTable->Header.DataDwords, AzaliaSdiNum, WaitPeriod, &Index);
+      HdaCmdRingStop (&Ring);
+    }
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "HDA: CORB/RIRB verb streaming failed (%r) after %d verbs, using Immediate Command interface\n", Status, Index));
+    }
+  }
+
   ///
-  /// Send the entire list of verbs in the matching verb table one by one to the codec
+  /// Send the remaining verbs in the matching verb table one by one to the codec
   ///
   DEBUG ((DEBUG_VERBOSE, "HDA: Sending verbs to codec:\n"));
-  for (Index = 0; Index < VerbTable->Header.DataDwords; ++Index) {
+  for (; Index < VerbTable->Header.DataDwords; ++Index) {
     CodecCmdData  = VerbTable->Data[Index];
     ASSERT ((CodecCmdData >> 28) == 0);
     ///
@@ -842,6 +1115,9 @@ DetectAndInitializeCodec (
   UINT32                                      CodecVendorId;
   UINT32                                      CodecRevisionId;
   UINT32                                      WaitPeriod;
+  EFI_PHYSICAL_ADDRESS                        RingBufferAddress;
+  VOID                                        *RingBuffer;
+  UINT64                                      CodecInitStart;
 
   PostCode (0xB0F);
   WaitPeriod = HDA_HDA_CODEC_WAIT_PERIOD;
@@ -872,6 +1148,9 @@ DetectAndInitializeCodec (
     PciSegmentOr32 (HdaPciBase + R_HDA_CFG_PCS, (UINT32) B_HDA_CFG_PCS_PMEE);
   }
 
+  RingBuffer        = NULL;
+  RingBufferAddress = 0;
+
   for (AzaliaSdiNum = 0; AzaliaSdiNum < HDA_MAX_SDI_NUMBER; AzaliaSdiNum++) {
     switch (AzaliaSdiNum) {
       case HDA_SDI_0_HDALINK:
@@ -900,6 +1179,7 @@ DetectAndInitializeCodec (
       /// SDIx has HD-Audio device
       ///
       DEBUG ((DEBUG_ERROR, "SDI#%d has HD-Audio device.\n", AzaliaSdiNum));
+      CodecInitStart = GetPerformanceCounter ();
 
       ///
       /// PME Enable for each existing codec, these bits are in the resume well
@@ -914,6 +1194,20 @@ DetectAndInitializeCodec (
       }
       DEBUG ((DEBUG_INFO, "SDI#%d: Detected HD-Audio Codec 0x%08X rev 0x%02X\n", AzaliaSdiNum, CodecVendorId, CodecRevisionId));
 
+      ///
+      /// Allocate CORB/RIRB ring buffer used to stream verb tables once the first codec answers,
+      /// when not available verb tables are sent through the Immediate Command interface.
+      ///
+      if (RingBuffer == NULL) {
+        Status = PeiServicesAllocatePages (EfiBootServicesData, HDA_CMD_RING_PAGES, &RingBufferAddress);
+        if (!EFI_ERROR (Status)) {
+          RingBuffer = (VOID *) (UINTN) RingBufferAddress;
+          ZeroMem (RingBuffer, EFI_PAGES_TO_SIZE (HDA_CMD_RING_PAGES));
+        } else {
+          DEBUG ((DEBUG_WARN, "HDA: CORB/RIRB ring buffer allocation failed, Status = %r\n", Status));
+        }
+      }
+
       ///
       /// Link static frequency switching
       ///
@@ -923,7 +1217,16 @@ DetectAndInitializeCodec (
       ///
       /// Send Verb Table if required table exist based on Codec Vendor ID and Codec Revision ID
       ///
-      Status = MatchAndSendCodecVerbTable(HdaBar, HdaConfig, AzaliaSdiNum, WaitPeriod, CodecVendorId, CodecRevisionId);
+      Status = MatchAndSendCodecVerbTable(HdaBar, HdaPciBase, HdaConfig, AzaliaSdiNum, WaitPeriod, CodecVendorId, CodecRevisionId, RingBuffer);
+
+      DEBUG_CODE_BEGIN ();
+      DEBUG ((
+        DEBUG_INFO,
+        "SDI#%d: Codec initialization time %ld us\n",
+        AzaliaSdiNum,
+        DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - CodecInitStart), 1000)
+        ));
+      DEBUG_CODE_END ();
       if (EFI_ERROR(Status)) {
         continue;
       }
@@ -935,6 +1238,13 @@ DetectAndInitializeCodec (
     }
   }
 
+  ///
+  /// The rings are stopped after each verb table, so the buffer is not needed anymore
+  ///
+  if (RingBuffer != NULL) {
+    PeiServicesFreePages (RingBufferAddress, HDA_CMD_RING_PAGES);
+  }
+
   Status = EFI_SUCCESS;
 
 ExitInitCodec:
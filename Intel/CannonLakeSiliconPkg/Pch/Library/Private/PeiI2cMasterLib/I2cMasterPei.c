@@ -182,6 +182,7 @@ I2cPortReset (
 
   @retval EFI_SUCCESS           The requested synchronous operation completed successfully or
                                 requested asynchronous operation was started.
+  @retval EFI_ABORTED           The controller lost arbitration to another bus master
   @retval EFI_ALREADY_STARTED   The controller is busy with another transfer
   @retval EFI_BAD_BUFFER_SIZE   Transfer size too big
   @retval EFI_DEVICE_ERROR      There was an I2C error (NACK during data transfer)
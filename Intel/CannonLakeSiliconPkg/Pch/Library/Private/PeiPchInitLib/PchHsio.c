@@ -107,8 +107,77 @@ PchHsioCalculateCrc16 (
   return Crc;
 }
 
+///
+/// ChipsetInit table descriptor. Every table carries the CRC16 of its base
+/// settings in its first two bytes, generated together with the table data,
+/// so the sync decision only needs that header and never the table body.
+///
+typedef struct {
+  BOOLEAN       PchLp;
+  PCH_STEPPING  Stepping;
+  BOOLEAN       Usb2Dbc;
+  UINT8         *Table;
+  UINT32        Length;
+  CHAR8         *Name;
+} PCH_HSIO_CHIPSETINIT_TBL_DESC;
+
+#define PCH_HSIO_CHIPSETINIT_TBL(PchLp, Stepping, Usb2Dbc, Table) \
+  { PchLp, Stepping, Usb2Dbc, Table, sizeof (Table), #Table }
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST PCH_HSIO_CHIPSETINIT_TBL_DESC mPchHsioChipsetInitTbl[] = {
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_B0, TRUE,  CnlPchLpChipsetInitTable_eDBC_B0),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_B0, FALSE, CnlPchLpChipsetInitTable_B0),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_B1, TRUE,  CnlPchLpChipsetInitTable_eDBC_Bx),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_B1, FALSE, CnlPchLpChipsetInitTable_Bx),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_D0, TRUE,  CnlPchLpChipsetInitTable_eDBC_Dx),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_D0, FALSE, CnlPchLpChipsetInitTable_Dx),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_D1, TRUE,  CnlPchLpChipsetInitTable_eDBC_Dx),
+  PCH_HSIO_CHIPSETINIT_TBL (TRUE,  PCH_D1, FALSE, CnlPchLpChipsetInitTable_Dx),
+  PCH_HSIO_CHIPSETINIT_TBL (FALSE, PCH_A0, TRUE,  CnlPchHChipsetInitTable_eDBC_A0),
+  PCH_HSIO_CHIPSETINIT_TBL (FALSE, PCH_A0, FALSE, CnlPchHChipsetInitTable_A0),
+  PCH_HSIO_CHIPSETINIT_TBL (FALSE, PCH_A1, TRUE,  CnlPchHChipsetInitTable_eDBC_Ax),
+  PCH_HSIO_CHIPSETINIT_TBL (FALSE, PCH_A1, FALSE, CnlPchHChipsetInitTable_Ax),
+  PCH_HSIO_CHIPSETINIT_TBL (FALSE, PCH_B0, TRUE,  CnlPchHChipsetInitTable_eDBC_Bx),
+  PCH_HSIO_CHIPSETINIT_TBL (FALSE, PCH_B0, FALSE, CnlPchHChipsetInitTable_Bx)
+};
+
+/**
+  Find the BIOS ChipsetInit table for the running PCH.
+
+  @param[in]  PchStep             The PCH stepping.
+  @param[in]  Usb2DbcEnabled      TRUE if the USB2 DbC table variant is required.
+
+  @retval     Pointer to the table descriptor, or NULL if the stepping is not supported.
+**/
+STATIC
+CONST PCH_HSIO_CHIPSETINIT_TBL_DESC *
+PchHsioFindChipsetInitTable (
+  IN  PCH_STEPPING  PchStep,
+  IN  BOOLEAN       Usb2DbcEnabled
+  )
+{
+  BOOLEAN  PchLp;
+  UINTN    Index;
+
+  PchLp = IsPchLp ();
+  if (!PchLp && !IsPchH ()) {
+    return NULL;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mPchHsioChipsetInitTbl); Index++) {
+    if ((mPchHsioChipsetInitTbl[Index].PchLp == PchLp) &&
+        (mPchHsioChipsetInitTbl[Index].Stepping == PchStep) &&
+        (mPchHsioChipsetInitTbl[Index].Usb2Dbc == Usb2DbcEnabled)) {
+      return &mPchHsioChipsetInitTbl[Index];
+    }
+  }
+  return NULL;
+}
+
 /**
   The function is used to detemine if a ChipsetInitSync with ME is required and syncs with ME if required.
+  The ChipsetInit base CRC reported by CSME in MBP is compared first, the ChipsetInit table
+  is only read back over HECI when MBP does not carry a valid CRC.
   @todo: This function is deprecated nd should be removed on TBD date.
 
   @retval EFI_SUCCESS             BIOS and ME ChipsetInit settings are in sync
@@ -120,26 +189,27 @@ PchHsioDeprecatedChipsetInitProg (
   VOID
   )
 {
-  EFI_STATUS                  Status;
-  UINT16                      BiosChipInitCrc;
-  UINT16                      ComputedCrc;
-  UINT8                       MeChipInitVersion;
-  UINT8                       BiosChipInitVersion;
-  EFI_BOOT_MODE               BootMode;
-  UINT8                       *PchChipsetInitTable;
-  UINT32                      PchChipsetInitTableLength;
-  PCH_STEPPING                PchStep;
-  UINT16                      MeChipInitCrc;
-  BOOLEAN                     Usb2DbcEnabled;
-  UINT8                       *ChipsetInitTblPtr;
-  UINT8                       *MeChipsetInitTblPtr;
-  UINT32                      MeChipsetInitTblLen;
-  SI_PREMEM_POLICY_PPI        *SiPreMemPolicyPpi;
-  PCH_DCI_PREMEM_CONFIG       *DciPreMemConfig;
-  PCH_HSIO_VER_INFO           *CsmeChipsetInitVerInfoPtr;
-  ME_BIOS_PAYLOAD_HOB         *MbpHob;
-  CHIPSET_INIT_INFO           ChipsetInitHobStruct;
-  CHIPSET_INIT_INFO           *ChipsetInitHob;
+  EFI_STATUS                     Status;
+  UINT16                         BiosChipInitCrc;
+  UINT16                         ComputedCrc;
+  UINT8                          MeChipInitVersion;
+  UINT8                          BiosChipInitVersion;
+  EFI_BOOT_MODE                  BootMode;
+  CONST PCH_HSIO_CHIPSETINIT_TBL_DESC  *ChipsetInitTblDesc;
+  UINT8                          *PchChipsetInitTable;
+  UINT32                         PchChipsetInitTableLength;
+  PCH_STEPPING                   PchStep;
+  UINT16                         MeChipInitCrc;
+  BOOLEAN                        Usb2DbcEnabled;
+  BOOLEAN                        SyncRequired;
+  UINT8                          *MeChipsetInitTblPtr;
+  UINT32                         MeChipsetInitTblLen;
+  SI_PREMEM_POLICY_PPI           *SiPreMemPolicyPpi;
+  PCH_DCI_PREMEM_CONFIG          *DciPreMemConfig;
+  PCH_HSIO_VER_INFO              *CsmeChipsetInitVerInfoPtr;
+  ME_BIOS_PAYLOAD_HOB            *MbpHob;
+  CHIPSET_INIT_INFO              ChipsetInitHobStruct;
+  CHIPSET_INIT_INFO              *ChipsetInitHob;
 
   MeChipInitVersion = 0;
   DciPreMemConfig = NULL;
@@ -168,112 +238,21 @@ PchHsioDeprecatedChipsetInitProg (
   /// Assign appropriate ChipsetInit table
   ///
   PchStep                   = PchStepping ();
-  PchChipsetInitTable       = NULL;
-  PchChipsetInitTableLength = 0;
   MeChipInitCrc             = 0;
   Usb2DbcEnabled            = (DciPreMemConfig->PlatformDebugConsent == ProbeTypeDciOobDbc) || (DciPreMemConfig->PlatformDebugConsent == ProbeTypeUsb2Dbc) || (IsDbcConnected ());
 
-  ///
-  /// Allocate memory for maximum ChipsetInit Table size and HECI Message Header
-  ///
-  ChipsetInitTblPtr =  AllocateZeroPool (PCH_HSIO_CHIPSETINIT_TBL_MAX_SIZE);
-  if (ChipsetInitTblPtr == NULL) {
-      DEBUG ((DEBUG_ERROR, "(PCHHSIO) PchHsioDeprecatedChipsetInitProg: Could not allocate Memory\n"));
-      return EFI_OUT_OF_RESOURCES;
-  }
-
-  if (IsPchLp ()) {
-    switch (PchStep) {
-      case PCH_B0:
-        if (Usb2DbcEnabled) {
-          PchChipsetInitTable = CnlPchLpChipsetInitTable_eDBC_B0;
-          PchChipsetInitTableLength = sizeof (CnlPchLpChipsetInitTable_eDBC_B0);
-          DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchLpChipsetInitTable_eDBC_B0 table \n"));
-        } else {
-          PchChipsetInitTable = CnlPchLpChipsetInitTable_B0;
-          PchChipsetInitTableLength = sizeof (CnlPchLpChipsetInitTable_B0);
-          DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchLpChipsetInitTable_B0 table \n"));
-        }
-        break;
-      case PCH_B1:
-        if (Usb2DbcEnabled) {
-          PchChipsetInitTable = CnlPchLpChipsetInitTable_eDBC_Bx;
-          PchChipsetInitTableLength = sizeof (CnlPchLpChipsetInitTable_eDBC_Bx);
-          DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchLpChipsetInitTable_eDBC_Bx table \n"));
-        } else {
-          PchChipsetInitTable = CnlPchLpChipsetInitTable_Bx;
-          PchChipsetInitTableLength = sizeof (CnlPchLpChipsetInitTable_Bx);
-          DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchLpChipsetInitTable_Bx table \n"));
-        }
-        break;
-      case PCH_D0:
-      case PCH_D1:
-        if (Usb2DbcEnabled) {
-          PchChipsetInitTable = CnlPchLpChipsetInitTable_eDBC_Dx;
-          PchChipsetInitTableLength = sizeof (CnlPchLpChipsetInitTable_eDBC_Dx);
-          DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchLpChipsetInitTable_eDBC_Dx table \n"));
-        } else {
-          PchChipsetInitTable = CnlPchLpChipsetInitTable_Dx;
-          PchChipsetInitTableLength = sizeof (CnlPchLpChipsetInitTable_Dx);
-          DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchLpChipsetInitTable_Dx table \n"));
-        }
-        break;
-      default:
-        PchChipsetInitTable = NULL;
-        PchChipsetInitTableLength   = 0;
-        DEBUG ((DEBUG_ERROR, "PchHsioChipsetInitDeprecatedProg: Unsupported PCH Stepping\n"));
-        break;
-    }
-  } else if (IsPchH ()) {
-    switch (PchStep) {
-    case PCH_A0:
-      if (Usb2DbcEnabled) {
-        PchChipsetInitTable = CnlPchHChipsetInitTable_eDBC_A0;
-        PchChipsetInitTableLength = sizeof (CnlPchHChipsetInitTable_eDBC_A0);
-        DEBUG((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchHChipsetInitTable_eDBC_A0 table \n"));
-      } else {
-        PchChipsetInitTable = CnlPchHChipsetInitTable_A0;
-        PchChipsetInitTableLength = sizeof (CnlPchHChipsetInitTable_A0);
-        DEBUG((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchHChipsetInitTable_A0 table \n"));
-      }
-      break;
-    case PCH_A1:
-      if (Usb2DbcEnabled) {
-        PchChipsetInitTable = CnlPchHChipsetInitTable_eDBC_Ax;
-        PchChipsetInitTableLength = sizeof (CnlPchHChipsetInitTable_eDBC_Ax);
-        DEBUG((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchHChipsetInitTable_eDBC_Ax table \n"));
-      } else {
-        PchChipsetInitTable = CnlPchHChipsetInitTable_Ax;
-        PchChipsetInitTableLength = sizeof (CnlPchHChipsetInitTable_Ax);
-        DEBUG((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchHChipsetInitTable_Ax table \n"));
-      }
-      break;
-    case PCH_B0:
-      if (Usb2DbcEnabled) {
-        PchChipsetInitTable = CnlPchHChipsetInitTable_eDBC_Bx;
-        PchChipsetInitTableLength = sizeof (CnlPchHChipsetInitTable_eDBC_Bx);
-        DEBUG((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchHChipsetInitTable_eDBC_Bx table \n"));
-      } else {
-        PchChipsetInitTable = CnlPchHChipsetInitTable_Bx;
-        PchChipsetInitTableLength = sizeof (CnlPchHChipsetInitTable_Bx);
-        DEBUG((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using CnlPchHChipsetInitTable_Bx table \n"));
-      }
-      break;
-    default:
-      PchChipsetInitTable = NULL;
-      PchChipsetInitTableLength   = 0;
-      DEBUG ((DEBUG_ERROR, "PchHsioChipsetInitDeprecatedProg: Unsupported PCH Stepping\n"));
-      break;
-    }
-  }
-  if (PchChipsetInitTable == NULL) {
+  ChipsetInitTblDesc = PchHsioFindChipsetInitTable (PchStep, Usb2DbcEnabled);
+  if (ChipsetInitTblDesc == NULL) {
+    DEBUG ((DEBUG_ERROR, "PchHsioChipsetInitDeprecatedProg: Unsupported PCH Stepping\n"));
     return EFI_UNSUPPORTED;
   }
-  CopyMem (ChipsetInitTblPtr, (VOID *) PchChipsetInitTable, PchChipsetInitTableLength);
+  PchChipsetInitTable       = ChipsetInitTblDesc->Table;
+  PchChipsetInitTableLength = ChipsetInitTblDesc->Length;
+  DEBUG ((DEBUG_INFO, "PchHsioChipsetInitDeprecatedProg: Using %a table \n", ChipsetInitTblDesc->Name));
 
   ///
   /// Step 3
-  /// Send the HECI HSIO Message
+  /// Compare the BIOS ChipsetInit CRC with the one CSME reports and send the HECI HSIO Message if needed
   ///
   Status         = EFI_SUCCESS;
   //
@@ -281,28 +260,47 @@ PchHsioDeprecatedChipsetInitProg (
   //
   BiosChipInitCrc     = *((UINT16*) PchChipsetInitTable);
   BiosChipInitVersion = *((UINT8*) PchChipsetInitTable + 2);
+  DEBUG_CODE_BEGIN ();
   ComputedCrc = PchHsioCalculateCrc16 ((PchChipsetInitTable + 36), (PchChipsetInitTableLength - 36));
   DEBUG ((DEBUG_INFO, "(Hsio) BIOS ChipsetInit Base Table CRC = 0x%04X, Computed = 0x%04X\n", BiosChipInitCrc, ComputedCrc));
+  DEBUG_CODE_END ();
 
   ///
-  /// Allocate memory for maximum ChipsetInit Table size and HECI Message Header
+  /// Get CSME ChipsetInit Version Data from MBP
   ///
-  MeChipsetInitTblLen = PCH_HSIO_CHIPSETINIT_TBL_MAX_SIZE;
-  MeChipsetInitTblPtr =  AllocateZeroPool (MeChipsetInitTblLen);
-  if (MeChipsetInitTblPtr == NULL) {
-    DEBUG ((DEBUG_ERROR, "PchHsioChipsetInitDeprecatedProg: Could not allocate Memory\n"));
-    return EFI_OUT_OF_RESOURCES;
+  MbpHob = GetFirstGuidHob (&gMeBiosPayloadHobGuid);
+  CsmeChipsetInitVerInfoPtr = NULL;
+  if (MbpHob != NULL) {
+    CsmeChipsetInitVerInfoPtr = (PCH_HSIO_VER_INFO *) MbpHob->MeBiosPayload.ChipsetInitVerData;
   }
-  Status = PeiHeciReadChipsetInitMsg (MeChipsetInitTblPtr, &MeChipsetInitTblLen);
-  MeChipInitCrc     = *((UINT16*) MeChipsetInitTblPtr);
-  MeChipInitVersion = *((UINT8*) MeChipsetInitTblPtr + 2);
 
-  if (Status == EFI_SUCCESS) {
+  if ((CsmeChipsetInitVerInfoPtr != NULL) && (CsmeChipsetInitVerInfoPtr->BaseCrcValid != 0)) {
+    MeChipInitCrc     = CsmeChipsetInitVerInfoPtr->BaseCrc;
+    MeChipInitVersion = CsmeChipsetInitVerInfoPtr->Version;
+    DEBUG ((DEBUG_INFO, "(Hsio) MBP Reported CRC = 0x%04X\n", MeChipInitCrc));
+  } else {
+    ///
+    /// MBP has no valid base CRC, read the ChipsetInit table back from ME.
+    ///
+    MeChipsetInitTblLen = PCH_HSIO_CHIPSETINIT_TBL_MAX_SIZE;
+    MeChipsetInitTblPtr =  AllocateZeroPool (MeChipsetInitTblLen);
+    if (MeChipsetInitTblPtr == NULL) {
+      DEBUG ((DEBUG_ERROR, "PchHsioChipsetInitDeprecatedProg: Could not allocate Memory\n"));
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Status = PeiHeciReadChipsetInitMsg (MeChipsetInitTblPtr, &MeChipsetInitTblLen);
+    MeChipInitCrc     = *((UINT16*) MeChipsetInitTblPtr);
+    MeChipInitVersion = *((UINT8*) MeChipsetInitTblPtr + 2);
+    FreePool (MeChipsetInitTblPtr);
     DEBUG ((DEBUG_INFO, "(Hsio) ME Reported CRC = 0x%04X\n", MeChipInitCrc));
+  }
+
+  if (Status == EFI_SUCCESS) {
     DEBUG ((DEBUG_INFO, "(Hsio) BIOS ChipsetInit Version = 0x%x, ME ChipsetInit Version = 0x%x\n", BiosChipInitVersion, MeChipInitVersion));
-    if (MeChipInitCrc != BiosChipInitCrc) {
+    SyncRequired = (BOOLEAN) (MeChipInitCrc != BiosChipInitCrc);
+    if (SyncRequired) {
       DEBUG((DEBUG_INFO, "(Hsio) Heci ChipsetInit Sync Message\n"));
-      Status = PeiHeciWriteChipsetInitMsg (ChipsetInitTblPtr, PchChipsetInitTableLength);
+      Status = PeiHeciWriteChipsetInitMsg (PchChipsetInitTable, PchChipsetInitTableLength);
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "ChipsetInit Sync Error: %r\n", Status));
         if ((Status == EFI_UNSUPPORTED) || (Status == EFI_DEVICE_ERROR)) {
@@ -320,19 +318,14 @@ PchHsioDeprecatedChipsetInitProg (
     DEBUG ((DEBUG_INFO, "(Hsio) Syncing ChipsetInit with ME failed! Error: %r\n", Status));
   }
 
-  ///
-  /// Get CSME ChipsetInit Version Data from MBP
-  ///
-  MbpHob = NULL;
-  MbpHob = GetFirstGuidHob (&gMeBiosPayloadHobGuid);
-  CsmeChipsetInitVerInfoPtr = (PCH_HSIO_VER_INFO *) MbpHob->MeBiosPayload.ChipsetInitVerData;
-
   //
   // Initialize ChipsetInitHob
   //
   ZeroMem (&ChipsetInitHobStruct, sizeof (CHIPSET_INIT_INFO));
   ChipsetInitHobStruct.BaseVersion = BiosChipInitVersion;
-  ChipsetInitHobStruct.OemVersion  = CsmeChipsetInitVerInfoPtr->OemVersion;
+  if (CsmeChipsetInitVerInfoPtr != NULL) {
+    ChipsetInitHobStruct.OemVersion = CsmeChipsetInitVerInfoPtr->OemVersion;
+  }
 
   ChipsetInitHob = BuildGuidDataHob (
                      &gChipsetInitHobGuid,
@@ -44,6 +44,7 @@
 #include <PchResetPlatformSpecific.h>
 #include <Private/Ppi/TetonGlacierPpi.h>
 #include <Private/Library/PeiHybridStorageLib.h>
+#include <Library/TraceEventLib.h>
 
 #define LTSSM_POLL_INTERVAL       10u // in microseconds, period for polling port state during SW EQ
 #define RECOVERY_TIME_THRESHOLD   40  // in percent, how much time can SW EQ spend in recovery during a single step
@@ -1778,6 +1779,8 @@ PchInitRootPorts (
   RpDisableMask    = 0;
   RpClkreqMask     = 0;
 
+  TRACE_EVENT1 (TRACE_EVENT_PCIE_RP_INIT_START, MaxPciePortNum);
+
   Status = PeiServicesLocatePpi (
              &gSiPreMemPolicyPpiGuid,
              0,
@@ -2003,6 +2006,7 @@ PchInitRootPorts (
   Status = PchPcieRpSpeedChange (SiPolicy, Gen3DeviceFound);
   ASSERT_EFI_ERROR (Status);
 
+  TRACE_EVENT1 (TRACE_EVENT_PCIE_RP_INIT_END, RpDisableMask);
   DEBUG ((DEBUG_INFO, "PchInitRootPorts() End\n"));
 }
 
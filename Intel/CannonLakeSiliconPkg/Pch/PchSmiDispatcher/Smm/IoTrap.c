@@ -142,6 +142,7 @@ ClearPendingIoTrapStatus (
   IN UINT8   TrapHandlerNum
   )
 {
+  PchSmmStsSnapshotInvalidate (PCR_ADDR_TYPE, PCH_PCR_ADDRESS (PID_PSTH, R_PSTH_PCR_TRPST));
   PchPcrWrite32 (PID_PSTH, R_PSTH_PCR_TRPST, (UINT32)(1 << TrapHandlerNum));
 }
 
@@ -263,6 +264,251 @@ IsIoTrapExContentMatched (
 }
 
 
+/**
+  Find the position of the first record whose address is above the given address
+  in the sorted record table of an IoTrap register.
+
+  @param[in] TrapHandlerNum       trap number (0-3)
+  @param[in] Address              IO address
+
+  @retval                         Index of the first record with Context.Address > Address
+**/
+STATIC
+UINTN
+IoTrapUpperBound (
+  IN UINTN   TrapHandlerNum,
+  IN UINT16  Address
+  )
+{
+  IO_TRAP_ENTRY_ATTRIBUTES  *Entry;
+  UINTN                     Low;
+  UINTN                     High;
+  UINTN                     Middle;
+
+  Entry = &mIoTrapData.Entry[TrapHandlerNum];
+  Low   = 0;
+  High  = Entry->SortedRecordCount;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    if (Entry->SortedRecord[Middle]->Context.Address <= Address) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+  return Low;
+}
+
+/**
+  Insert a record into the sorted record table of its IoTrap register.
+
+  @param[in] TrapHandlerNum       trap number (0-3)
+  @param[in] Record               IOTRAP registration record structure
+
+  @retval    EFI_SUCCESS          Record inserted
+             EFI_OUT_OF_RESOURCES Run out of SMM memory pool
+**/
+STATIC
+EFI_STATUS
+IoTrapSortedRecordInsert (
+  IN UINT8           TrapHandlerNum,
+  IN IO_TRAP_RECORD  *Record
+  )
+{
+  EFI_STATUS                Status;
+  IO_TRAP_ENTRY_ATTRIBUTES  *Entry;
+  IO_TRAP_RECORD            **NewTable;
+  UINTN                     NewCapacity;
+  UINTN                     Index;
+
+  Entry = &mIoTrapData.Entry[TrapHandlerNum];
+
+  if (Entry->SortedRecordCount == Entry->SortedRecordCapacity) {
+    NewCapacity = (Entry->SortedRecordCapacity == 0) ? 8 : Entry->SortedRecordCapacity * 2;
+    Status = gSmst->SmmAllocatePool (
+                      EfiRuntimeServicesData,
+                      NewCapacity * sizeof (IO_TRAP_RECORD *),
+                      (VOID **) &NewTable
+                      );
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    if (Entry->SortedRecord != NULL) {
+      CopyMem (NewTable, Entry->SortedRecord, Entry->SortedRecordCount * sizeof (IO_TRAP_RECORD *));
+      gSmst->SmmFreePool (Entry->SortedRecord);
+    }
+    Entry->SortedRecord         = NewTable;
+    Entry->SortedRecordCapacity = NewCapacity;
+  }
+
+  Index = IoTrapUpperBound (TrapHandlerNum, Record->Context.Address);
+  CopyMem (
+    &Entry->SortedRecord[Index + 1],
+    &Entry->SortedRecord[Index],
+    (Entry->SortedRecordCount - Index) * sizeof (IO_TRAP_RECORD *)
+    );
+  Entry->SortedRecord[Index] = Record;
+  Entry->SortedRecordCount++;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Remove a record from the sorted record table of its IoTrap register.
+
+  @param[in] TrapHandlerNum       trap number (0-3)
+  @param[in] Record               IOTRAP registration record structure
+**/
+STATIC
+VOID
+IoTrapSortedRecordRemove (
+  IN UINT8           TrapHandlerNum,
+  IN IO_TRAP_RECORD  *Record
+  )
+{
+  IO_TRAP_ENTRY_ATTRIBUTES  *Entry;
+  UINTN                     Index;
+
+  Entry = &mIoTrapData.Entry[TrapHandlerNum];
+  for (Index = 0; Index < Entry->SortedRecordCount; Index++) {
+    if (Entry->SortedRecord[Index] == Record) {
+      Entry->SortedRecordCount--;
+      CopyMem (
+        &Entry->SortedRecord[Index],
+        &Entry->SortedRecord[Index + 1],
+        (Entry->SortedRecordCount - Index) * sizeof (IO_TRAP_RECORD *)
+        );
+      return;
+    }
+  }
+  ASSERT (FALSE);
+}
+
+/**
+  Find the child whose range covers a trapped IO cycle.
+
+  @param[in] TrapHandlerNum       trap number (0-3)
+  @param[in] StartAddress         lowest byte address of the trapped cycle
+  @param[in] EndAddress           highest byte address of the trapped cycle
+
+  @retval                         The matching record, NULL if no child claims the cycle
+**/
+STATIC
+IO_TRAP_RECORD *
+IoTrapLookupRecord (
+  IN UINTN   TrapHandlerNum,
+  IN UINT16  StartAddress,
+  IN UINT16  EndAddress
+  )
+{
+  IO_TRAP_RECORD  *Record;
+  UINTN           Index;
+
+  Index = IoTrapUpperBound (TrapHandlerNum, StartAddress);
+  if (Index == 0) {
+    return NULL;
+  }
+  Record = mIoTrapData.Entry[TrapHandlerNum].SortedRecord[Index - 1];
+  if ((UINT32) Record->Context.Address + Record->Context.Length > EndAddress) {
+    return Record;
+  }
+  return NULL;
+}
+
+/**
+  Allocate a sub-range of a common pool IoTrap register.
+  The sub-range is naturally aligned to its length so a DWORD access never spans two children,
+  and holes left by unregistered children are reused.
+
+  @param[in]  TrapHandlerNum      trap number (0-3)
+  @param[in]  BaseAddress         base address of the common pool
+  @param[in]  Length              length of the requested range
+  @param[out] Address             allocated IO address
+
+  @retval     TRUE                Range allocated
+              FALSE               The pool has no suitable hole
+**/
+STATIC
+BOOLEAN
+IoTrapAllocateFromPool (
+  IN  UINT8   TrapHandlerNum,
+  IN  UINT16  BaseAddress,
+  IN  UINT16  Length,
+  OUT UINT16  *Address
+  )
+{
+  IO_TRAP_ENTRY_ATTRIBUTES  *Entry;
+  IO_TRAP_RECORD            *Record;
+  UINT32                    Alignment;
+  UINT32                    Candidate;
+  UINTN                     Index;
+
+  Entry     = &mIoTrapData.Entry[TrapHandlerNum];
+  Alignment = (Length == 3) ? 4 : Length;
+  Candidate = BaseAddress;
+
+  for (Index = 0; Index < Entry->SortedRecordCount; Index++) {
+    Record = Entry->SortedRecord[Index];
+    if (Candidate + Length <= Record->Context.Address) {
+      break;
+    }
+    Candidate = ALIGN_VALUE ((UINT32) Record->Context.Address + Record->Context.Length, Alignment);
+  }
+
+  if (Candidate + Length > (UINT32) BaseAddress + GENERIC_IOTRAP_SIZE) {
+    return FALSE;
+  }
+  *Address = (UINT16) Candidate;
+  return TRUE;
+}
+
+/**
+  Trim the trap range of a common pool IoTrap register to the smallest power of 2 that covers
+  all of its children, so cycles to the unused tail of the pool no longer raise an SMI.
+
+  @param[in] TrapHandlerNum       trap number (0-3)
+**/
+STATIC
+VOID
+IoTrapUpdatePoolLength (
+  IN UINT8   TrapHandlerNum
+  )
+{
+  IO_TRAP_ENTRY_ATTRIBUTES  *Entry;
+  IO_TRAP_RECORD            *Record;
+  UINT32                    IoTrapRegLowDword;
+  UINT32                    NewLowDword;
+  UINT16                    BaseAddress;
+  UINT32                    UsedLength;
+  UINT8                     LengthIndex;
+
+  Entry = &mIoTrapData.Entry[TrapHandlerNum];
+  if (Entry->SortedRecordCount == 0) {
+    return;
+  }
+
+  IoTrapRegLowDword = PchPcrRead32 (PID_PSTH, R_PSTH_PCR_TRPREG0 + TrapHandlerNum * 8);
+  BaseAddress       = AddressFromLowDword (IoTrapRegLowDword);
+
+  Record     = Entry->SortedRecord[Entry->SortedRecordCount - 1];
+  UsedLength = (UINT32) Record->Context.Address + Record->Context.Length - BaseAddress;
+  Entry->TrapUsedLength = UsedLength;
+
+  for (LengthIndex = 0; LengthIndex < sizeof (mLengthTable) / sizeof (UINT16); LengthIndex++) {
+    if ((mLengthTable[LengthIndex] >= 4) && (mLengthTable[LengthIndex] >= UsedLength)) {
+      UsedLength = mLengthTable[LengthIndex];
+      break;
+    }
+  }
+
+  NewLowDword = (UINT32) (((UsedLength - 1) & ~(BIT1 + BIT0)) << 16) |
+                BaseAddress |
+                (IoTrapRegLowDword & B_PSTH_PCR_TRPREG_TSE);
+  if (NewLowDword != IoTrapRegLowDword) {
+    SetIoTrapLowDword (TrapHandlerNum, NewLowDword, TRUE);
+  }
+}
+
 /**
   The helper function for IoTrap callback dispacther
 
@@ -286,8 +532,8 @@ IoTrapDispatcherHelper (
   UINT32                                    WriteData;
 
   if (!IsListEmpty (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase))) {
-    Data32 = PchPcrRead32 (PID_PSTH, R_PSTH_PCR_TRPC);
-    WriteData = PchPcrRead32 (PID_PSTH, R_PSTH_PCR_TRPD);
+    Data32 = PchSmmStsSnapshotPcrRead32 (PID_PSTH, R_PSTH_PCR_TRPC);
+    WriteData = PchSmmStsSnapshotPcrRead32 (PID_PSTH, R_PSTH_PCR_TRPD);
 
     BaseAddress           = (UINT16) (Data32 & B_PSTH_PCR_TRPC_IOA);
     ActiveHighByteEnable  = (UINT8)((Data32 & B_PSTH_PCR_TRPC_AHBE) >> 16);
@@ -301,53 +547,57 @@ IoTrapDispatcherHelper (
     CurrentIoTrapRegisterData.Type = (EFI_SMM_IO_TRAP_DISPATCH_TYPE)ReadCycle;
     CurrentIoTrapContextData.WriteData = WriteData;
 
-    LinkInDb = GetFirstNode (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase));
-
-    while (!IsNull (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase), LinkInDb)) {
+    //
+    // If MergeDisable is TRUE, no need to check the address range, dispatch the callback function directly.
+    // Expect only one callback available.
+    //
+    if (mIoTrapData.Entry[TrapHandlerNum].MergeDisable) {
+      LinkInDb   = GetFirstNode (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase));
       RecordInDb = IO_TRAP_RECORD_FROM_LINK (LinkInDb);
+      if (RecordInDb->IoTrapCallback != NULL) {
+        RecordInDb->IoTrapCallback (&RecordInDb->Link, &CurrentIoTrapContextData, NULL, NULL);
+      }
+      if (RecordInDb->IoTrapExCallback != NULL) {
+        RecordInDb->IoTrapExCallback (BaseAddress, ActiveHighByteEnable, !ReadCycle, WriteData);
+      }
+      mIoTrapData.Entry[TrapHandlerNum].DispatchedCount++;
+      return;
+    }
 
+    //
+    // If MergeDisable is FALSE, look up the child that owns the address range and check the trap type.
+    //
+    RecordInDb = IoTrapLookupRecord (TrapHandlerNum, StartAddress, EndAddress);
+    if (RecordInDb == NULL) {
       //
-      // If MergeDisable is TRUE, no need to check the address range, dispatch the callback function directly.
+      // An IO access was trapped that does not have a handler registered.
+      // This indicates an error condition.
       //
-      if (mIoTrapData.Entry[TrapHandlerNum].MergeDisable) {
-        if (RecordInDb->IoTrapCallback != NULL) {
-          RecordInDb->IoTrapCallback (&RecordInDb->Link, &CurrentIoTrapContextData, NULL, NULL);
-        }
-        if (RecordInDb->IoTrapExCallback != NULL) {
-          RecordInDb->IoTrapExCallback (BaseAddress, ActiveHighByteEnable, !ReadCycle, WriteData);
-        }
-        //
-        // Expect only one callback available. So break immediately.
-        //
-        break;
+      mIoTrapData.Entry[TrapHandlerNum].SpuriousCount++;
+      DEBUG ((
+        DEBUG_ERROR,
+        "IoTrap%d: no handler for IO %x, spurious %d dispatched %d\n",
+        (UINT32) TrapHandlerNum,
+        BaseAddress,
+        mIoTrapData.Entry[TrapHandlerNum].SpuriousCount,
+        mIoTrapData.Entry[TrapHandlerNum].DispatchedCount
+        ));
+      ASSERT (FALSE);
+      return;
+    }
+
+    if ((RecordInDb->Context.Type == IoTrapExTypeReadWrite) || (RecordInDb->Context.Type == (IO_TRAP_EX_DISPATCH_TYPE) CurrentIoTrapRegisterData.Type)) {
       //
-      // If MergeDisable is FALSE, check the address range and trap type.
+      // Pass the IO trap context information
       //
-      } else {
-        if ((RecordInDb->Context.Address <= StartAddress) &&
-            (RecordInDb->Context.Address + RecordInDb->Context.Length > EndAddress)) {
-          if ((RecordInDb->Context.Type == IoTrapExTypeReadWrite) || (RecordInDb->Context.Type == (IO_TRAP_EX_DISPATCH_TYPE) CurrentIoTrapRegisterData.Type)) {
-            //
-            // Pass the IO trap context information
-            //
-            RecordInDb->IoTrapCallback (&RecordInDb->Link, &CurrentIoTrapContextData, NULL, NULL);
-          }
-          //
-          // Break if the address is match
-          //
-          break;
-        } else {
-          LinkInDb = GetNextNode (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase), &RecordInDb->Link);
-          if (IsNull (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase), LinkInDb)) {
-            //
-            // An IO access was trapped that does not have a handler registered.
-            // This indicates an error condition.
-            //
-            ASSERT (FALSE);
-          }
-        }
-      } // end of if else block
-    } // end of while loop
+      RecordInDb->IoTrapCallback (&RecordInDb->Link, &CurrentIoTrapContextData, NULL, NULL);
+      mIoTrapData.Entry[TrapHandlerNum].DispatchedCount++;
+    } else {
+      //
+      // The register traps both cycle types once children of different types are merged
+      //
+      mIoTrapData.Entry[TrapHandlerNum].SpuriousCount++;
+    }
   } // end of if else block
 }
 
@@ -607,29 +857,18 @@ IoTrapRegisterHelper (
       //  Assign an addfress from common pool if the caller's address is 0
       //
       if (*Address == 0) {
-        //
-        //  Check next handler if it's fully used
-        //
-        if (mIoTrapData.Entry[TrapHandlerNum].TrapUsedLength >= GENERIC_IOTRAP_SIZE) {
-          continue;
-        }
         //
         // Check next handler if it's not for a common pool
         //
-        if (UsedLength < GENERIC_IOTRAP_SIZE) {
+        if (!mIoTrapData.Entry[TrapHandlerNum].ReservedAcpiIoResource) {
           continue;
         }
         //
-        // Check next handler if the size is too big
+        // Check next handler if the pool has no aligned hole big enough for the request
         //
-        if (Length >= (UINT16) GENERIC_IOTRAP_SIZE - mIoTrapData.Entry[TrapHandlerNum].TrapUsedLength) {
+        if (!IoTrapAllocateFromPool (TrapHandlerNum, (UINT16) BaseAddress, Length, Address)) {
           continue;
         }
-        //
-        // For common pool, we don't need to change the BaseAddress and UsedLength
-        //
-        *Address = (UINT16) (BaseAddress + mIoTrapData.Entry[TrapHandlerNum].TrapUsedLength);
-        mIoTrapData.Entry[TrapHandlerNum].TrapUsedLength += Length;
       }
       //
       // Only set RWM bit when we need both read and write cycles.
@@ -675,8 +914,21 @@ IoTrapRegisterHelper (
   mIoTrapRecord->IoTrapExCallback        = IoTrapExDispatchFunction;
   mIoTrapRecord->IoTrapNumber            = TrapHandlerNum;
 
+  Status = IoTrapSortedRecordInsert (TrapHandlerNum, mIoTrapRecord);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate memory for the sorted IoTrap table! \n"));
+    gSmst->SmmFreePool (mIoTrapRecord);
+    return EFI_OUT_OF_RESOURCES;
+  }
   InsertTailList (&(mIoTrapData.Entry[TrapHandlerNum].CallbackDataBase), &mIoTrapRecord->Link);
 
+  //
+  // Cover only the allocated part of a common pool
+  //
+  if (!mIoTrapData.Entry[TrapHandlerNum].MergeDisable) {
+    IoTrapUpdatePoolLength (TrapHandlerNum);
+  }
+
   //
   // Child's handle will be the address linked list link in the record
   //
@@ -704,11 +956,7 @@ IoTrapUnRegisterHelper (
 {
   EFI_STATUS            Status;
   IO_TRAP_RECORD        *RecordToDelete;
-  UINT32                IoTrapRegLowDword;
-  EFI_PHYSICAL_ADDRESS  BaseAddress;
-  UINT32                UsedLength;
   UINT8                 TrapHandlerNum;
-  UINT8                 LengthIndex;
   BOOLEAN               RequireToDisableIoTrapHandler;
 
   if (DispatchHandle == 0) {
@@ -742,55 +990,21 @@ IoTrapUnRegisterHelper (
     // Disable the IO Trap handler if it's the only child of the Trap handler
     //
     RequireToDisableIoTrapHandler = TRUE;
-  } else {
-    //
-    // Get information from Io Trap handler register
-    //
-    IoTrapRegLowDword = PchPcrRead32 (PID_PSTH, R_PSTH_PCR_TRPREG0 + TrapHandlerNum * 8);
-
-    //
-    // Check next Io Trap handler if the IO Trap handler is not used
-    //
-    if (AddressFromLowDword (IoTrapRegLowDword) != 0) {
+  }
 
-      UsedLength  = LengthFromLowDword (IoTrapRegLowDword);
-      BaseAddress = AddressFromLowDword (IoTrapRegLowDword);
+  IoTrapSortedRecordRemove (TrapHandlerNum, RecordToDelete);
 
+  if (!RequireToDisableIoTrapHandler) {
+    if (mIoTrapData.Entry[TrapHandlerNum].SortedRecordCount == 0) {
       //
-      // Check if it's the maximum address of the Io Trap handler
+      // Disable the IO Trap handler if it was the only child of the Trap handler
       //
-      if ((UINTN)(BaseAddress + UsedLength) == (UINTN)(RecordToDelete->Context.Address + RecordToDelete->Context.Length)) {
-
-        if (BaseAddress == RecordToDelete->Context.Address) {
-          //
-          // Disable the IO Trap handler if it's the only child of the Trap handler
-          //
-          RequireToDisableIoTrapHandler = TRUE;
-        } else {
-          //
-          // Calculate the new IO Trap handler Length
-          //
-          UsedLength = UsedLength - RecordToDelete->Context.Length;
-          //
-          // Check the alignment is dword * power of 2 or not
-          //
-          for (LengthIndex = 0; LengthIndex < sizeof (mLengthTable) / sizeof (UINT16); LengthIndex++) {
-            if (UsedLength == mLengthTable[LengthIndex]) {
-              break;
-            }
-          }
-          //
-          // Do not decrease the length if the alignment is not dword * power of 2
-          //
-          if (LengthIndex < sizeof (mLengthTable) / sizeof (UINT16)) {
-            //
-            // Decrease the length to prevent the IO trap SMI
-            //
-            IoTrapRegLowDword = (UINT32) ((((UsedLength - 1) &~(BIT1 + BIT0)) << 16) | BaseAddress | B_PSTH_PCR_TRPREG_TSE);
-          }
-          SetIoTrapLowDword (TrapHandlerNum, IoTrapRegLowDword, TRUE);
-        }
-      }
+      RequireToDisableIoTrapHandler = TRUE;
+    } else {
+      //
+      // Shrink the trap range to the children left in the common pool
+      //
+      IoTrapUpdatePoolLength (TrapHandlerNum);
     }
   }
 
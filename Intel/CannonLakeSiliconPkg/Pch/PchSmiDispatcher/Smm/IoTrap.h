@@ -76,6 +76,19 @@ typedef struct {
     Dispatcher for each IoTrap register.
   **/
   PCH_SMI_DISPATCH_CALLBACK             CallbackDispatcher;
+  /**
+    The callbacks of this IoTrap register sorted by address.
+    The ranges never overlap, so the dispatcher finds the child of a trapped cycle with a binary search.
+    The table only changes during registration, which is closed after SmmReadyToLock.
+  **/
+  struct _IO_TRAP_RECORD                **SortedRecord;
+  UINTN                                 SortedRecordCount;
+  UINTN                                 SortedRecordCapacity;
+  /**
+    Number of trapped cycles dispatched to a child, and of cycles that no child claimed.
+  **/
+  UINT32                                DispatchedCount;
+  UINT32                                SpuriousCount;
 } IO_TRAP_ENTRY_ATTRIBUTES;
 
 typedef struct {
@@ -37,6 +37,7 @@
 #include "PchSmmHelpers.h"
 #include "PchSmmEspi.h"
 #include <Library/SmiHandlerProfileLib.h>
+#include <Library/TraceEventLib.h>
 #include <Register/PchRegsGpio.h>
 #include <Register/PchRegsPmc.h>
 #include <Register/PchRegsLpc.h>
@@ -755,6 +756,11 @@ PchSmmCoreDispatcher (
       SciEn       = PchSmmGetSciEn ();
       SmiEnValue  = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN));
       SmiStsValue = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS));
+      //
+      // GPIO and PCR status registers are read at most once per pass and shared
+      // by every source (GPI, IoTrap, eSPI) that lives in the same register.
+      //
+      PchSmmStsSnapshotStart ();
 
       while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
         RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
@@ -859,7 +865,9 @@ PchSmmCoreDispatcher (
                     }
 
                     PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
+                    TRACE_EVENT1 (TRACE_EVENT_SMI_CALLBACK_START, RecordToExhaust->ProtocolType);
                     RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
+                    TRACE_EVENT1 (TRACE_EVENT_SMI_CALLBACK_END, RecordToExhaust->ProtocolType);
                     PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
                     if (RecordToExhaust->ProtocolType == SxType) {
                       SxChildWasDispatched = TRUE;
@@ -899,6 +907,7 @@ PchSmmCoreDispatcher (
       }
     }
   }
+  PchSmmStsSnapshotStop ();
   //
   // If you arrive here, there are two possible reasons:
   // (1) you've got problems with clearing the SMI status bits in the
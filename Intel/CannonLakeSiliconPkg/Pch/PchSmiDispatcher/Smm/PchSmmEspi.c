@@ -452,14 +452,18 @@ EspiSmiDisableSource (
 }
 
 /**
-  Clear a status for the SMI event
+  Clear status bits in the register of an eSPI SMI type
 
-  @param[in]  EspiSmiType  Type based on ESPI_SMI_TYPE
+  @param[in]  EspiSmiType  Type based on ESPI_SMI_TYPE, selects the register
+  @param[in]  AndMask      Mask AND'ed with the register, drops other write-1-to-clear bits
+  @param[in]  OrMask       Status bits to write 1 to
 **/
 STATIC
 VOID
-EspiSmiClearStatus (
-  IN CONST  ESPI_SMI_TYPE EspiSmiType
+EspiSmiWriteStatus (
+  IN CONST  ESPI_SMI_TYPE EspiSmiType,
+  IN        UINT32        AndMask,
+  IN        UINT32        OrMask
   )
 {
   UINT32                  PciBus;
@@ -478,14 +482,15 @@ EspiSmiClearStatus (
       PciFun  = Desc->Address.Data.pcie.Fields.Fnc;
       PciReg  = Desc->Address.Data.pcie.Fields.Reg;
       PciBaseAddress = PCI_SEGMENT_LIB_ADDRESS (DEFAULT_PCI_SEGMENT_NUMBER_PCH, PciBus, PciDev, PciFun, 0);
-      PciSegmentAndThenOr32 (PciBaseAddress + PciReg, Desc->ClearStatusAndMask, Desc->ClearStatusOrMask);
+      PciSegmentAndThenOr32 (PciBaseAddress + PciReg, AndMask, OrMask);
       break;
     case PCR_ADDR_TYPE:
+      PchSmmStsSnapshotInvalidate (PCR_ADDR_TYPE, Desc->Address.Data.Pcr.Raw);
       PchPcrAndThenOr32 (
         Desc->Address.Data.Pcr.Fields.Pid,
         Desc->Address.Data.Pcr.Fields.Offset,
-        Desc->ClearStatusAndMask,
-        Desc->ClearStatusOrMask
+        AndMask,
+        OrMask
         );
       break;
     default:
@@ -495,6 +500,54 @@ EspiSmiClearStatus (
   }
 }
 
+/**
+  Clear a status for the SMI event
+
+  @param[in]  EspiSmiType  Type based on ESPI_SMI_TYPE
+**/
+STATIC
+VOID
+EspiSmiClearStatus (
+  IN CONST  ESPI_SMI_TYPE EspiSmiType
+  )
+{
+  EspiSmiWriteStatus (
+    EspiSmiType,
+    mEspiDescriptor[EspiSmiType].ClearStatusAndMask,
+    mEspiDescriptor[EspiSmiType].ClearStatusOrMask
+    );
+}
+
+/**
+  Find the first eSPI SMI type of the same top level type that uses the same status register
+
+  The search starts at FirstType, the start of the top level type barrier, so the
+  owner is always inside the range walked by the status clear loop.
+
+  @param[in]  FirstType    First ESPI_SMI_TYPE of the top level type being handled
+  @param[in]  EspiSmiType  Type based on ESPI_SMI_TYPE
+
+  @retval     The lowest ESPI_SMI_TYPE from FirstType whose descriptor has the same address
+**/
+STATIC
+ESPI_SMI_TYPE
+EspiSmiStatusOwner (
+  IN CONST  ESPI_SMI_TYPE FirstType,
+  IN CONST  ESPI_SMI_TYPE EspiSmiType
+  )
+{
+  ESPI_SMI_TYPE           Owner;
+
+  for (Owner = FirstType; Owner < EspiSmiType; ++Owner) {
+    if ((mEspiDescriptor[Owner].Address.Type == mEspiDescriptor[EspiSmiType].Address.Type) &&
+        (mEspiDescriptor[Owner].Address.Data.raw == mEspiDescriptor[EspiSmiType].Address.Data.raw)) {
+      break;
+    }
+  }
+
+  return Owner;
+}
+
 /**
   Checks if a source is active by looking at the enable and status bits
 
@@ -529,7 +582,10 @@ EspiSmiSourceIsActive (
       break;
 
     case PCR_ADDR_TYPE:
-      Data32 = PchPcrRead32 (
+      //
+      // PC, VW and Flash error types share their XERR register, read it once per SMI
+      //
+      Data32 = PchSmmStsSnapshotPcrRead32 (
                  Desc->Address.Data.Pcr.Fields.Pid,
                  Desc->Address.Data.Pcr.Fields.Offset
                  );
@@ -606,6 +662,9 @@ EspiSmiCallback (
   ESPI_SMI_TYPE       EspiSmiType;
   ESPI_SMI_RECORD     *RecordInDb;
   LIST_ENTRY          *LinkInDb;
+  ESPI_SMI_TYPE       Owner;
+  UINT32              ClearAndMask[EspiSmiTypeMax];
+  UINT32              ClearOrMask[EspiSmiTypeMax];
 
   PchSmiRecord = DATABASE_RECORD_FROM_LINK (DispatchHandle);
 
@@ -619,6 +678,9 @@ EspiSmiCallback (
     return;
   }
 
+  SetMem32 (ClearAndMask, sizeof (ClearAndMask), MAX_UINT32);
+  ZeroMem (ClearOrMask, sizeof (ClearOrMask));
+
   for (EspiSmiType = mEspiSmiInstance.Barrier[EspiTopLevelType].Start; EspiSmiType <= mEspiSmiInstance.Barrier[EspiTopLevelType].End; ++EspiSmiType) {
     if (!EspiSmiSourceIsActive (EspiSmiType)) {
       continue;
@@ -660,9 +722,18 @@ EspiSmiCallback (
     }
 
     //
-    // Finish walking the linked list for the EspiSmiType, so clear status
+    // Finish walking the linked list for the EspiSmiType, so queue its status clear.
+    // Types sharing a register are cleared together with a single write below.
     //
-    EspiSmiClearStatus (EspiSmiType);
+    Owner = EspiSmiStatusOwner (mEspiSmiInstance.Barrier[EspiTopLevelType].Start, EspiSmiType);
+    ClearAndMask[Owner] &= mEspiDescriptor[EspiSmiType].ClearStatusAndMask;
+    ClearOrMask[Owner]  |= mEspiDescriptor[EspiSmiType].ClearStatusOrMask;
+  }
+
+  for (EspiSmiType = mEspiSmiInstance.Barrier[EspiTopLevelType].Start; EspiSmiType <= mEspiSmiInstance.Barrier[EspiTopLevelType].End; ++EspiSmiType) {
+    if (ClearOrMask[EspiSmiType] != 0) {
+      EspiSmiWriteStatus (EspiSmiType, ClearAndMask[EspiSmiType], ClearOrMask[EspiSmiType]);
+    }
   }
 }
 
@@ -42,6 +42,31 @@
 //
 #define BIT_ZERO  0x00000001
 
+//
+// Number of distinct GPIO/PCR registers tracked by the per-SMI status snapshot.
+// GPI_SMI_STS DWs, TRPST and the eSPI XERR registers fit well below this.
+//
+#define PCH_SMM_STS_SNAPSHOT_MAX_ENTRIES  32
+
+typedef struct {
+  ADDR_TYPE   Type;
+  UINT32      Address;
+  UINT32      Value;
+} PCH_SMM_STS_SNAPSHOT_ENTRY;
+
+typedef struct {
+  BOOLEAN                     Enabled;
+  UINTN                       Count;
+  PCH_SMM_STS_SNAPSHOT_ENTRY  Entry[PCH_SMM_STS_SNAPSHOT_MAX_ENTRIES];
+} PCH_SMM_STS_SNAPSHOT;
+
+///
+/// Values of the GPIO and PCR registers already read during the current dispatcher pass.
+/// Every source that shares a register is evaluated against the same value, so
+/// each distinct status DW costs one MMIO or sideband read per pass.
+///
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMM_STS_SNAPSHOT  mPchSmmStsSnapshot;
+
 /**
   Publish SMI Dispatch protocols.
 
@@ -301,6 +326,120 @@ PchSmmGetSciEn (
   return SciEn;
 }
 
+/**
+  Start a new status snapshot. Called by the core dispatcher at the beginning
+  of each pass, right where SMI_EN and SMI_STS are cached.
+**/
+VOID
+PchSmmStsSnapshotStart (
+  VOID
+  )
+{
+  mPchSmmStsSnapshot.Count   = 0;
+  mPchSmmStsSnapshot.Enabled = TRUE;
+}
+
+/**
+  Stop using the status snapshot. Reads outside of the dispatcher always go
+  to hardware.
+**/
+VOID
+PchSmmStsSnapshotStop (
+  VOID
+  )
+{
+  mPchSmmStsSnapshot.Count   = 0;
+  mPchSmmStsSnapshot.Enabled = FALSE;
+}
+
+/**
+  Drop a register from the status snapshot so the next read goes to hardware.
+
+  @param[in] Type                 GPIO_ADDR_TYPE, MEMORY_MAPPED_IO_ADDRESS_TYPE or PCR_ADDR_TYPE
+  @param[in] Address              MMIO address or raw PCR address of the register
+**/
+VOID
+PchSmmStsSnapshotInvalidate (
+  IN ADDR_TYPE  Type,
+  IN UINT32     Address
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mPchSmmStsSnapshot.Count; Index++) {
+    if ((mPchSmmStsSnapshot.Entry[Index].Type == Type) &&
+        (mPchSmmStsSnapshot.Entry[Index].Address == Address)) {
+      mPchSmmStsSnapshot.Count--;
+      mPchSmmStsSnapshot.Entry[Index] = mPchSmmStsSnapshot.Entry[mPchSmmStsSnapshot.Count];
+      return;
+    }
+  }
+}
+
+/**
+  Read a 32 bit GPIO/MMIO or PCR register through the status snapshot.
+  The first read of a register in a dispatcher pass goes to hardware,
+  following reads return the cached value.
+
+  @param[in] Type                 GPIO_ADDR_TYPE, MEMORY_MAPPED_IO_ADDRESS_TYPE or PCR_ADDR_TYPE
+  @param[in] Address              MMIO address or raw PCR address of the register
+
+  @retval                         Register value
+**/
+STATIC
+UINT32
+PchSmmStsSnapshotRead32 (
+  IN ADDR_TYPE  Type,
+  IN UINT32     Address
+  )
+{
+  UINTN     Index;
+  UINT32    Value;
+  PCR_ADDR  PcrAddress;
+
+  if (mPchSmmStsSnapshot.Enabled) {
+    for (Index = 0; Index < mPchSmmStsSnapshot.Count; Index++) {
+      if ((mPchSmmStsSnapshot.Entry[Index].Type == Type) &&
+          (mPchSmmStsSnapshot.Entry[Index].Address == Address)) {
+        return mPchSmmStsSnapshot.Entry[Index].Value;
+      }
+    }
+  }
+
+  if (Type == PCR_ADDR_TYPE) {
+    PcrAddress.Raw = Address;
+    Value = PchPcrRead32 ((PCH_SBI_PID) PcrAddress.Fields.Pid, PcrAddress.Fields.Offset);
+  } else {
+    Value = MmioRead32 ((UINTN) Address);
+  }
+
+  if (mPchSmmStsSnapshot.Enabled && (mPchSmmStsSnapshot.Count < PCH_SMM_STS_SNAPSHOT_MAX_ENTRIES)) {
+    mPchSmmStsSnapshot.Entry[mPchSmmStsSnapshot.Count].Type    = Type;
+    mPchSmmStsSnapshot.Entry[mPchSmmStsSnapshot.Count].Address = Address;
+    mPchSmmStsSnapshot.Entry[mPchSmmStsSnapshot.Count].Value   = Value;
+    mPchSmmStsSnapshot.Count++;
+  }
+
+  return Value;
+}
+
+/**
+  Read a 32 bit PCR register through the status snapshot.
+
+  @param[in] Pid                  Port ID
+  @param[in] Offset               Register offset of this Port ID
+
+  @retval                         Register value
+**/
+UINT32
+PchSmmStsSnapshotPcrRead32 (
+  IN PCH_SBI_PID  Pid,
+  IN UINT32       Offset
+  )
+{
+  return PchSmmStsSnapshotRead32 (PCR_ADDR_TYPE, PCH_PCR_ADDRESS (Pid, Offset));
+}
+
 /**
   Read a specifying bit with the register
   These may or may not need to change w/ the PCH version; they're highly IA-32 dependent, though.
@@ -433,7 +572,7 @@ ReadBitDesc (
           break;
 
         case 4:
-          Register = (UINT64) MmioRead32 ((UINTN) BitDesc->Reg.Data.Mmio);
+          Register = (UINT64) PchSmmStsSnapshotRead32 (BitDesc->Reg.Type, (UINT32) (UINTN) BitDesc->Reg.Data.Mmio);
           break;
 
         case 8:
@@ -514,7 +653,7 @@ ReadBitDesc (
           break;
 
         case 4:
-          Register = PchPcrRead32 (BitDesc->Reg.Data.Pcr.Fields.Pid, BitDesc->Reg.Data.Pcr.Fields.Offset);
+          Register = PchSmmStsSnapshotRead32 (PCR_ADDR_TYPE, BitDesc->Reg.Data.Pcr.Raw);
           break;
 
         default:
@@ -683,6 +822,14 @@ WriteBitDesc (
 
     case GPIO_ADDR_TYPE:
     case MEMORY_MAPPED_IO_ADDRESS_TYPE:
+      PchSmmStsSnapshotInvalidate (BitDesc->Reg.Type, (UINT32) (UINTN) BitDesc->Reg.Data.Mmio);
+      if (WriteClear && ValueToWrite && (BitDesc->SizeInBytes == 4)) {
+        //
+        // Write-1-to-clear of a single status bit, the read back is not needed.
+        //
+        MmioWrite32 ((UINTN) BitDesc->Reg.Data.Mmio, (UINT32) OrVal);
+        break;
+      }
       //
       // Read the register, or it with the bit to set, then write it back.
       //
@@ -755,6 +902,14 @@ WriteBitDesc (
       break;
 
     case PCR_ADDR_TYPE:
+      PchSmmStsSnapshotInvalidate (PCR_ADDR_TYPE, BitDesc->Reg.Data.Pcr.Raw);
+      if (WriteClear && ValueToWrite && (BitDesc->SizeInBytes == 4)) {
+        //
+        // Write-1-to-clear of a single status bit, the read back is not needed.
+        //
+        PchPcrWrite32 ((PCH_SBI_PID) BitDesc->Reg.Data.Pcr.Fields.Pid, (UINT16) BitDesc->Reg.Data.Pcr.Fields.Offset, (UINT32) OrVal);
+        break;
+      }
       //
       // Read the register, or it with the bit to set, then write it back.
       //
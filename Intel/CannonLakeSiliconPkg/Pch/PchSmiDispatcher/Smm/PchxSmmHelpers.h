@@ -128,4 +128,48 @@ WriteBitDesc (
   CONST BOOLEAN           WriteClear
   );
 
+/**
+  Start a new status snapshot. Called by the core dispatcher at the beginning
+  of each pass, right where SMI_EN and SMI_STS are cached.
+**/
+VOID
+PchSmmStsSnapshotStart (
+  VOID
+  );
+
+/**
+  Stop using the status snapshot. Reads outside of the dispatcher always go
+  to hardware.
+**/
+VOID
+PchSmmStsSnapshotStop (
+  VOID
+  );
+
+/**
+  Drop a register from the status snapshot so the next read goes to hardware.
+
+  @param[in] Type                 GPIO_ADDR_TYPE, MEMORY_MAPPED_IO_ADDRESS_TYPE or PCR_ADDR_TYPE
+  @param[in] Address              MMIO address or raw PCR address of the register
+**/
+VOID
+PchSmmStsSnapshotInvalidate (
+  IN ADDR_TYPE  Type,
+  IN UINT32     Address
+  );
+
+/**
+  Read a 32 bit PCR register through the status snapshot.
+
+  @param[in] Pid                  Port ID
+  @param[in] Offset               Register offset of this Port ID
+
+  @retval                         Register value
+**/
+UINT32
+PchSmmStsSnapshotPcrRead32 (
+  IN PCH_SBI_PID  Pid,
+  IN UINT32       Offset
+  );
+
 #endif
@@ -38,11 +38,6 @@
 #ifdef BDAT_SUPPORT
 #include <Bdat4.h>
 #define CRC_SEED                  (0)
-#define CRC_XOR_MASK              (0x1021)
-
-#ifndef BIT15
-#define BIT15                     (1 << 15)
-#endif
 
 #ifndef MIN
 #define MIN(a, b)                 (((a) < (b)) ? (a) : (b))
@@ -82,37 +77,190 @@ STATIC EFI_BDAT_ACPI_DESCRIPTION_TABLE  mRmtAcpiTable = {
   }
 };
 
+///
+/// CRC16 lookup table, polynomial 0x1021 processed MSB first.
+///
+STATIC CONST UINT16 mCrc16Table[256] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+  0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+  0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+  0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+  0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+  0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+  0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+  0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+  0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+  0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+  0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+  0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+  0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+  0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+  0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+  0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+  0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+  0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+  0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+  0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+  0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+  0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
 /**
-  Calculate the CRC16 of the provided data. CRC16 formula is the same
+  Update a CRC16 with more data. CRC16 formula is the same
   one that is used for calculating the CRC16 stored in the memory SPD.
 
+  @param[in]  Crc    - CRC16 of the data processed so far, CRC_SEED for the first block.
   @param[in]  Buffer - Pointer to the start of the data.
   @param[in]  Size   - Amount of data in the buffer, in bytes.
 
-  @retval The calculated CRC16 value.
+  @retval The updated CRC16 value.
 **/
-static
+STATIC
 UINT16
-GetCrc16 (
+UpdateCrc16 (
+  IN  UINT16              Crc,
   IN  CONST UINT8  *CONST Buffer,
   IN  CONST UINT32        Size
   )
 {
   CONST UINT8  *Data;
-  UINT32       Value;
   UINT32       Byte;
-  UINT8        Bit;
 
-  Data  = Buffer;
-  Value = CRC_SEED;
+  Data = Buffer;
   for (Byte = 0; Byte < Size; Byte++) {
-    Value ^= (UINT32) *Data++ << 8;
-    for (Bit = 0; Bit < 8; Bit++) {
-      Value = (Value & BIT15) ? (Value << 1) ^ CRC_XOR_MASK : Value << 1;
+    Crc = (UINT16) ((Crc << 8) ^ mCrc16Table[(UINT8) (Crc >> 8) ^ *Data++]);
+  }
+
+  return Crc;
+}
+
+/**
+  Calculate the CRC16 of the provided data.
+
+  @param[in]  Buffer - Pointer to the start of the data.
+  @param[in]  Size   - Amount of data in the buffer, in bytes.
+
+  @retval The calculated CRC16 value.
+**/
+STATIC
+UINT16
+GetCrc16 (
+  IN  CONST UINT8  *CONST Buffer,
+  IN  CONST UINT32        Size
+  )
+{
+  return UpdateCrc16 (CRC_SEED, Buffer, Size);
+}
+
+/**
+  Check whether a schema GUID is listed before the given entry of the given schema list HOB.
+  Schemas that share a GUID are all copied when the GUID is first found.
+
+  @param[in]  HobList    - A pointer to the HOB list.
+  @param[in]  ListHob    - The schema list HOB that holds the entry.
+  @param[in]  EntryIndex - Index of the entry in ListHob.
+
+  @retval TRUE if the GUID of the entry was listed before, otherwise FALSE.
+**/
+STATIC
+BOOLEAN
+IsSchemaGuidListedBefore (
+  IN VOID                  *HobList,
+  IN BDAT_SCHEMA_LIST_HOB  *ListHob,
+  IN UINT16                EntryIndex
+  )
+{
+  BDAT_SCHEMA_LIST_HOB *Current;
+  UINT16               Index;
+  UINT16               Count;
+
+  for (Current = GetNextGuidHob (&gSchemaListGuid, HobList);
+       Current != NULL;
+       Current = GetNextGuidHob (&gSchemaListGuid, GET_NEXT_HOB (Current))) {
+    Count = (Current == ListHob) ? EntryIndex : MIN (Current->SchemaHobCount, MAX_SCHEMA_LIST_LENGTH);
+    for (Index = 0; Index < Count; Index++) {
+      if (CompareGuid (&Current->SchemaHobGuids[Index], &ListHob->SchemaHobGuids[EntryIndex])) {
+        return TRUE;
+      }
+    }
+    if (Current == ListHob) {
+      break;
     }
   }
+  return FALSE;
+}
 
-  return ((UINT16) Value);
+/**
+  Walk all schema HOBs listed in all BDAT schema list HOBs.
+  When Bdat is NULL only the schema count and size are returned, otherwise every schema
+  is copied straight to its place behind the BDAT header and its offset is recorded.
+
+  @param[in]      HobList     - A pointer to the HOB list.
+  @param[in, out] Bdat        - BDAT structure to fill, or NULL to only size the schemas.
+  @param[in]      HeaderSize  - Size of the BDAT header including the schema offset list.
+  @param[out]     SchemaCount - Number of schemas found.
+  @param[out]     DataSize    - Total size of the schemas found, in bytes.
+
+  @retval EFI_SUCCESS       The schemas were walked successfully.
+  @retval EFI_UNSUPPORTED   A schema list HOB is corrupted.
+**/
+STATIC
+EFI_STATUS
+WalkBdatSchemas (
+  IN     VOID            *HobList,
+  IN OUT BDAT_STRUCTURE  *Bdat,
+  IN     UINT32          HeaderSize,
+  OUT    UINT16          *SchemaCount,
+  OUT    UINT32          *DataSize
+  )
+{
+  BDAT_SCHEMA_LIST_HOB *ListHob;
+  EFI_GUID             *Guid;
+  VOID                 *Schema;
+  UINT32               *SchemaOffsetList;
+  UINT32               SchemaSize;
+  UINT16               Index;
+
+  *SchemaCount     = 0;
+  *DataSize        = 0;
+  SchemaOffsetList = (Bdat == NULL) ? NULL : (UINT32 *) (Bdat + 1);
+
+  for (ListHob = GetNextGuidHob (&gSchemaListGuid, HobList);
+       ListHob != NULL;
+       ListHob = GetNextGuidHob (&gSchemaListGuid, GET_NEXT_HOB (ListHob))) {
+    DEBUG ((DEBUG_INFO, "Found Schema List HOB, SchemaHobCount = %d\n", (UINT32) ListHob->SchemaHobCount));
+    for (Index = 0; Index < MIN (ListHob->SchemaHobCount, MAX_SCHEMA_LIST_LENGTH); Index++) {
+      Guid = &ListHob->SchemaHobGuids[Index];
+      if (IsZeroGuid (Guid)) {
+        DEBUG ((DEBUG_INFO, "BDAT Schema List HOB is corrupted, aborting\n"));
+        return EFI_UNSUPPORTED;
+      }
+      if (IsSchemaGuidListedBefore (HobList, ListHob, Index)) {
+        continue;
+      }
+      for (Schema = GetNextGuidHob (Guid, HobList); Schema != NULL; Schema = GetNextGuidHob (Guid, GET_NEXT_HOB (Schema))) {
+        SchemaSize = (UINT32) GET_GUID_HOB_DATA_SIZE (Schema);
+        if (Bdat != NULL) {
+          DEBUG ((DEBUG_INFO, "Schema %g, DataSize = %d\n", Guid, SchemaSize));
+          CopyMem ((UINT8 *) Bdat + HeaderSize + *DataSize, GET_GUID_HOB_DATA (Schema), SchemaSize);
+          SchemaOffsetList[*SchemaCount] = HeaderSize + *DataSize;
+        }
+        *DataSize += SchemaSize;
+        (*SchemaCount)++;
+      }
+    }
+  }
+  return EFI_SUCCESS;
 }
 
 /**
@@ -190,74 +338,29 @@ CreateBdatTable (
 #ifdef BDAT_SUPPORT
   VOID                 *Buffer;
   BDAT_STRUCTURE       *Bdat;
-  BDAT_SCHEMA_LIST_HOB *BdatSchemaListHob;
   UINT32               *ScratchPad;
   UINT32               MchBar;
-  EFI_GUID             *Guid;
-  EFI_HOB_GUID_TYPE    *Schema[MAX_SCHEMA_LIST_LENGTH];
-  UINT32               *SchemaOffsetList;
-  UINT8                *NextBlock;
-  UINT8                *SchemaData;
   EFI_STATUS           Status;
   UINT64               TempBuffer;
   UINTN                AcpiTableKey;
   UINT32               DataSize;
   UINT32               BufferSize;
   UINT32               BdatHeaderSize;
-  UINT16               SchemaListIndex;
-  UINT8                NextSchema;
-  UINT8                SchemaCount;
-  UINT8                Check;
-  UINT8                Index;
+  UINT16               SchemaCount;
+  UINT16               CopiedCount;
 
   Status = EFI_SUCCESS;
   while (Status == EFI_SUCCESS) {
     DEBUG ((DEBUG_INFO, "Creating BDAT Table...\n"));
 
     ///
-    /// Get the memory information HOB so we can locate the BDAT information.
+    /// Size all the schema HOBs listed in the schema list HOBs.
     ///
-    BdatSchemaListHob = GetNextGuidHob (&gSchemaListGuid, HobList);
-    if (BdatSchemaListHob == NULL) {
-      DEBUG ((DEBUG_INFO, "No BDAT data exists, exiting without creating table\n"));
-      Status = EFI_UNSUPPORTED;
+    Status = WalkBdatSchemas (HobList, NULL, 0, &SchemaCount, &DataSize);
+    if (EFI_ERROR (Status)) {
       break;
     }
-    DEBUG ((DEBUG_INFO, "Found Schema List HOB\n"));
-
-    ///
-    /// Gather up all the BDAT specific HOBs.
-    /// We need to get pointers to them and determine the buffer size needed to store them into the ACPI table.
-    ///
-    BufferSize  = 0;
-    SchemaCount = 0;
-    for (SchemaListIndex = 0; SchemaListIndex < BdatSchemaListHob->SchemaHobCount; SchemaListIndex++) {
-      Guid = (EFI_GUID *) &(BdatSchemaListHob->SchemaHobGuids[SchemaListIndex]);
-
-      Schema[SchemaListIndex] = NULL;
-      if (Guid != NULL) {
-        DEBUG ((DEBUG_INFO, "Checking GUID: "));
-        for (Index = 0, Check = 0; Index < sizeof (EFI_GUID); Index++) {
-          Check |= ((UINT8 *) Guid) [Index];
-        }
-        DEBUG ((DEBUG_INFO, "%d\n", (UINT32) Check));
-        DEBUG ((DEBUG_INFO, "GUID = %g\n", Guid));
-        if (Check != 0) {
-          Schema[SchemaListIndex] = GetNextGuidHob (Guid, HobList);
-          DEBUG ((DEBUG_INFO, "Schema HOB pointer: %x\n", (UINT32) (UINTN) Schema[SchemaListIndex]));
-          if (Schema[SchemaListIndex] != NULL) {
-            BufferSize += Schema[SchemaListIndex]->Header.HobLength - sizeof (EFI_HOB_GUID_TYPE);
-            DEBUG ((DEBUG_INFO, "HOB Length = %d\n", Schema[SchemaListIndex]->Header.HobLength));
-            SchemaCount++;
-          }
-        } else {
-          DEBUG ((DEBUG_INFO, "BDAT Schema List HOB is corrupted, aborting\n"));
-          Status = EFI_UNSUPPORTED;
-          break;
-        }
-      }
-    }
-    DEBUG ((DEBUG_INFO, "BdatSchemaListHob->SchemaHobCount = %d, SchemaCount = %d\n", (UINT32) BdatSchemaListHob->SchemaHobCount, (UINT32) SchemaCount));
+    DEBUG ((DEBUG_INFO, "SchemaCount = %d, DataSize = %d\n", (UINT32) SchemaCount, DataSize));
 
     ///
     /// Return if we did not find any schemas
@@ -271,40 +374,27 @@ CreateBdatTable (
     ///
     /// Allocate and clear memory, in 4kb pages. This memory is used to store the BDAT into the ACPI table.
     ///
-    Buffer         = NULL;
-    BdatHeaderSize = sizeof (BDAT_HEADER_STRUCTURE) + sizeof (BDAT_SCHEMA_LIST_STRUCTURE) + (SchemaCount * sizeof (UINT32));
-    BufferSize    += BdatHeaderSize;
+    BdatHeaderSize = sizeof (BDAT_STRUCTURE) + (SchemaCount * sizeof (UINT32));
+    BufferSize     = BdatHeaderSize + DataSize;
     DEBUG ((DEBUG_INFO, "BufferSize = %d\n", BufferSize));
     Buffer = AllocateReservedPages (EFI_SIZE_TO_PAGES (BufferSize));
     if (Buffer == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
       break;
     }
-    ZeroMem (Buffer, BufferSize);
+    ZeroMem (Buffer, BdatHeaderSize);
     DEBUG ((DEBUG_INFO, "Buffer = 0x%X\n", (UINT32) (UINTN) Buffer));
+
     ///
-    /// Copy the BDAT structure into the memory specified for the ACPI table.
+    /// Copy the schemas straight into the memory specified for the ACPI table.
     ///
-    Bdat       = (BDAT_STRUCTURE *) Buffer;
-    NextBlock  = (UINT8 *) ((UINTN) Buffer + BdatHeaderSize);
-    DEBUG ((DEBUG_INFO, "NextBlock = 0x%X\n", NextBlock));
-    NextSchema = 0;
-    SchemaOffsetList = (UINT32*) (((UINTN) Buffer) + sizeof (BDAT_STRUCTURE));
+    Bdat   = (BDAT_STRUCTURE *) Buffer;
     Status = CreateBdatHeader (SchemaCount, Bdat);
     ASSERT_EFI_ERROR (Status);
-    for (SchemaListIndex = 0; SchemaListIndex < SchemaCount; SchemaListIndex++) {
-      if (Schema[SchemaListIndex] != NULL) {
-        DataSize = Schema[SchemaListIndex]->Header.HobLength - sizeof (EFI_HOB_GUID_TYPE);
-        DEBUG ((DEBUG_INFO, "DataSize = %d\n", DataSize));
-        SchemaData = (UINT8*) Schema[SchemaListIndex];
-        SchemaData += sizeof (EFI_HOB_GUID_TYPE);
-        DEBUG ((DEBUG_INFO, "SchemaData = 0x%X\n", (UINT32) ((UINTN) SchemaData)));
-        CopyMem (NextBlock, SchemaData, DataSize);
-        SchemaOffsetList[NextSchema++] = (UINT32) ((UINTN) NextBlock  - (UINTN) Bdat);
-        NextBlock = (UINT8 *) ((UINTN) NextBlock + DataSize);
-        DEBUG ((DEBUG_INFO, "NextBlock = 0x%X\n", NextBlock));
-      }
-    }
+    Status = WalkBdatSchemas (HobList, Bdat, BdatHeaderSize, &CopiedCount, &DataSize);
+    ASSERT_EFI_ERROR (Status);
+    ASSERT (CopiedCount == SchemaCount);
+
     ///
     /// Initialize the Size and CRC of the BDAT structure.
     /// Ensure that the CRC calculation is the last field initialized.
@@ -43,6 +43,7 @@
 #include <Library/PeiSaPolicyLib.h>
 #include <Library/PchCycleDecodingLib.h>
 #include <Private/Library/PmcPrivateLib.h>
+#include <Library/TraceEventLib.h>
 
 #pragma pack (push, 1)
 typedef union {
@@ -850,6 +851,7 @@ DebugHook (
   Debug   = &Outputs->Debug;
 
   Debug->PostCode[MRC_POST_CODE] = DisplayDebugNumber;
+  TRACE_EVENT1 (TRACE_EVENT_MRC_POST_CODE, DisplayDebugNumber);
   IoWrite16 (0x80, DisplayDebugNumber);
   DEBUG ((DEBUG_INFO, "Post Code: %04Xh\n", DisplayDebugNumber));
 
@@ -89,9 +89,12 @@ SmbiosMemory (
   IN  EFI_SMBIOS_PROTOCOL *SmbiosProtocol
   )
 {
-  EFI_STATUS         Status;
-  SA_POLICY_PROTOCOL *SaPolicy;
-  EFI_HOB_GUID_TYPE  *GuidHob;
+  EFI_STATUS              Status;
+  SA_POLICY_PROTOCOL      *SaPolicy;
+  EFI_HOB_GUID_TYPE       *GuidHob;
+  SMBIOS_MEMORY_CACHE_KEY CacheKey;
+  BOOLEAN                 CacheKeyValid;
+  BOOLEAN                 Complete;
 
   Status = EFI_SUCCESS;
   //
@@ -115,14 +118,33 @@ SmbiosMemory (
       ASSERT_EFI_ERROR (Status);
     }
 
+    ///
+    /// Install the records generated on a previous boot if the memory configuration is unchanged
+    ///
+    CacheKeyValid = SmbiosMemoryCacheGetKey (&CacheKey);
+    if (CacheKeyValid) {
+      Status = SmbiosMemoryCacheInstall (SmbiosProtocol, &CacheKey);
+      if (!EFI_ERROR (Status)) {
+        return Status;
+      }
+      SmbiosMemoryCacheCaptureStart ();
+    }
+
     Status = InstallSmbiosType16 (SmbiosProtocol);
     ASSERT_EFI_ERROR (Status);
+    Complete = (BOOLEAN) !EFI_ERROR (Status);
 
     Status = InstallSmbiosType17 (SmbiosProtocol);
     ASSERT_EFI_ERROR (Status);
+    Complete = (BOOLEAN) (Complete && !EFI_ERROR (Status));
 
     Status = InstallSmbiosType19 (SmbiosProtocol);
     ASSERT_EFI_ERROR (Status);
+    Complete = (BOOLEAN) (Complete && !EFI_ERROR (Status));
+
+    if (CacheKeyValid) {
+      SmbiosMemoryCacheCaptureEnd (&CacheKey, Complete);
+    }
   } else {
     ASSERT_EFI_ERROR (Status);
   }
@@ -161,6 +183,7 @@ AddSmbiosEntry (
   EFI_SMBIOS_TABLE_HEADER *Record;
   CHAR8                   *StringPtr;
   UINTN                   Size;
+  UINTN                   RecordSize;
   UINTN                   i;
   EFI_SMBIOS_PROTOCOL     *Smbios;
 
@@ -194,6 +217,7 @@ AddSmbiosEntry (
   ///
   /// Initialize the full record
   ///
+  RecordSize = Size;
   Record = (EFI_SMBIOS_TABLE_HEADER *) AllocateZeroPool (Size);
   if (Record == NULL) {
     return EFI_OUT_OF_RESOURCES;
@@ -216,6 +240,9 @@ AddSmbiosEntry (
 
   *SmbiosHandle = SMBIOS_HANDLE_PI_RESERVED;
   Status = Smbios->Add (Smbios, NULL, SmbiosHandle, Record);
+  if (!EFI_ERROR (Status)) {
+    SmbiosMemoryCacheAppend (Record, RecordSize);
+  }
 
   FreePool (Record);
   return Status;
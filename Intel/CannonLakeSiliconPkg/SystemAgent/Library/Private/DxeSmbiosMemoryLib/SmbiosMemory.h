@@ -44,8 +44,10 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/PrintLib.h>
 #include <Library/HobLib.h>
+#include <Library/PcdLib.h>
 #include <Protocol/Smbios.h>
 #include <IndustryStandard/SmBus.h>
 #include <SaAccess.h>
@@ -153,6 +155,46 @@ typedef struct {
   CHAR8  *ManufactureName;
 } MEMORY_MODULE_MANUFACTURE_LIST;
 
+///
+/// SMBIOS memory record cache, stored in a non-volatile variable
+///
+#define SMBIOS_MEMORY_CACHE_VARIABLE_NAME  L"SmbiosMemoryCache"
+#define SMBIOS_MEMORY_CACHE_SIGNATURE      SIGNATURE_32 ('S', 'M', 'M', 'C')
+#define SMBIOS_MEMORY_CACHE_MAX_SIZE       SIZE_8KB
+#define SMBIOS_MEMORY_CACHE_REVISION       1         ///< Increase when the cache layout or the generated records change
+
+///
+/// Leading fields of the MRC save data (MrcSave or MrcSaveCompactHeader) published in the gSiMemoryS3DataGuid HOB
+///
+typedef struct {
+  UINT32  Size;
+  UINT32  Crc;             ///< CRC-32 of the MRC save data
+} SMBIOS_MEMORY_MRC_SAVE_HEADER;
+
+///
+/// The cached records are valid only while all of these are unchanged
+///
+typedef struct {
+  UINT32  Revision;        ///< SMBIOS_MEMORY_CACHE_REVISION of the code that wrote the cache
+  UINT32  FirmwareRevision;///< gST->FirmwareRevision of the firmware that wrote the cache
+  UINT32  SiliconVersion;  ///< Silicon reference code version, PcdSiliconInitVersion Major.Minor.Revision.Build
+  UINT32  MrcSaveCrc;      ///< CRC-32 of the MRC save data
+  UINT32  MemInfoCrc;      ///< CRC-32 of MEMORY_INFO_DATA_HOB
+  UINT8   ChannelASlotMap;
+  UINT8   ChannelBSlotMap;
+  UINT16  Reserved;
+} SMBIOS_MEMORY_CACHE_KEY;
+
+///
+/// Cache header, followed by RecordCount full SMBIOS records (formatted area and string-set)
+///
+typedef struct {
+  UINT32                   Signature;
+  SMBIOS_MEMORY_CACHE_KEY  Key;
+  UINT32                   RecordCount;
+  UINT32                   RecordSize;  ///< Total size of the records following the header
+} SMBIOS_MEMORY_CACHE_HEADER;
+
 #pragma pack(1)
 typedef struct {
   CHAR8 *DeviceLocator;
@@ -207,6 +249,70 @@ AddSmbiosEntry (
   OUT EFI_SMBIOS_HANDLE       *SmbiosHandle
   );
 
+/**
+  Get the key the cached SMBIOS memory records are valid for.
+
+  @param[out] Key               - Cache key for the current boot.
+
+  @retval TRUE                  - Key is valid, the cache can be used.
+  @retval FALSE                 - MRC save data is not available, the cache can't be used.
+**/
+BOOLEAN
+SmbiosMemoryCacheGetKey (
+  OUT SMBIOS_MEMORY_CACHE_KEY  *Key
+  );
+
+/**
+  Install the SMBIOS memory records from the cache if it matches the current boot.
+  The Type 17 and Type 19 memory array handles are updated to the newly assigned Type 16 handle.
+  If any record can't be added, the records added so far are removed again.
+
+  @param[in] SmbiosProtocol     - Instance of Smbios Protocol
+  @param[in] Key                - Cache key for the current boot.
+
+  @retval EFI_SUCCESS           - All records were installed from the cache.
+  @retval EFI_NOT_FOUND         - There is no valid cache for this memory configuration.
+  @retval others                - Records could not be added.
+**/
+EFI_STATUS
+SmbiosMemoryCacheInstall (
+  IN EFI_SMBIOS_PROTOCOL      *SmbiosProtocol,
+  IN SMBIOS_MEMORY_CACHE_KEY  *Key
+  );
+
+/**
+  Start recording the SMBIOS memory records added by AddSmbiosEntry.
+**/
+VOID
+SmbiosMemoryCacheCaptureStart (
+  VOID
+  );
+
+/**
+  Record one SMBIOS memory record, if recording was started.
+  Recording is abandoned if the records don't fit in the cache.
+
+  @param[in] Record             - Full SMBIOS record, including the string-set.
+  @param[in] RecordSize         - Size of the record.
+**/
+VOID
+SmbiosMemoryCacheAppend (
+  IN EFI_SMBIOS_TABLE_HEADER  *Record,
+  IN UINTN                    RecordSize
+  );
+
+/**
+  Stop recording and store the recorded SMBIOS memory records for the following boots.
+
+  @param[in] Key                - Cache key for the current boot.
+  @param[in] Save               - TRUE if the records are complete and shall be stored.
+**/
+VOID
+SmbiosMemoryCacheCaptureEnd (
+  IN SMBIOS_MEMORY_CACHE_KEY  *Key,
+  IN BOOLEAN                  Save
+  );
+
 /**
   This function installs SMBIOS Table Type 16 (Physical Memory Array).
 
@@ -0,0 +1,361 @@
+/** @file
+  Cache of the SMBIOS memory records (Type 16, 17 and 19) across boots.
+  The records generated on a boot are stored in a non-volatile variable keyed by
+  the MRC save data CRC and the memory information HOB, and are installed as-is on
+  the following boots until the memory configuration changes.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+
+#include "SmbiosMemory.h"
+
+GLOBAL_REMOVE_IF_UNREFERENCED UINT8   *mSmbiosMemoryCache = NULL;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN   mSmbiosMemoryCacheSize = 0;
+GLOBAL_REMOVE_IF_UNREFERENCED UINT32  mSmbiosMemoryCacheRecordCount = 0;
+
+/**
+  Get the key the cached SMBIOS memory records are valid for.
+
+  @param[out] Key               - Cache key for the current boot.
+
+  @retval TRUE                  - Key is valid, the cache can be used.
+  @retval FALSE                 - MRC save data is not available, the cache can't be used.
+**/
+BOOLEAN
+SmbiosMemoryCacheGetKey (
+  OUT SMBIOS_MEMORY_CACHE_KEY  *Key
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_HOB_GUID_TYPE             *GuidHob;
+  SMBIOS_MEMORY_MRC_SAVE_HEADER *MrcSaveHeader;
+
+  ZeroMem (Key, sizeof (SMBIOS_MEMORY_CACHE_KEY));
+
+  if ((mMemInfo == NULL) || (mMemoryDxeConfig == NULL)) {
+    return FALSE;
+  }
+
+  //
+  // A cache written by another firmware build is not used, even if the memory did not change.
+  //
+  Key->Revision         = SMBIOS_MEMORY_CACHE_REVISION;
+  Key->FirmwareRevision = gST->FirmwareRevision;
+  Key->SiliconVersion   = ((UINT32) PcdGet8 (PcdSiliconInitVersionMajor) << 24) |
+                          ((UINT32) PcdGet8 (PcdSiliconInitVersionMinor) << 16) |
+                          ((UINT32) PcdGet8 (PcdSiliconInitVersionRevision) << 8) |
+                          (UINT32) PcdGet8 (PcdSiliconInitVersionBuild);
+
+  GuidHob = GetFirstGuidHob (&gSiMemoryS3DataGuid);
+  if ((GuidHob == NULL) || (GET_GUID_HOB_DATA_SIZE (GuidHob) < sizeof (SMBIOS_MEMORY_MRC_SAVE_HEADER))) {
+    return FALSE;
+  }
+  MrcSaveHeader = (SMBIOS_MEMORY_MRC_SAVE_HEADER *) GET_GUID_HOB_DATA (GuidHob);
+  Key->MrcSaveCrc = MrcSaveHeader->Crc;
+
+  Status = gBS->CalculateCrc32 (mMemInfo, sizeof (MEMORY_INFO_DATA_HOB), &Key->MemInfoCrc);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+  Key->ChannelASlotMap = mMemoryDxeConfig->ChannelASlotMap;
+  Key->ChannelBSlotMap = mMemoryDxeConfig->ChannelBSlotMap;
+
+  return TRUE;
+}
+
+/**
+  Check that the cached records are well formed SMBIOS memory records.
+  The first record must be Type 16, followed by Type 17 and Type 19 records only.
+
+  @param[in] Records            - Cached records.
+  @param[in] RecordSize         - Total size of the cached records.
+  @param[in] RecordCount        - Number of the cached records.
+
+  @retval TRUE                  - Records are valid.
+  @retval FALSE                 - Records are corrupted.
+**/
+STATIC
+BOOLEAN
+SmbiosMemoryCacheValidate (
+  IN UINT8   *Records,
+  IN UINTN   RecordSize,
+  IN UINT32  RecordCount
+  )
+{
+  EFI_SMBIOS_TABLE_HEADER *Header;
+  UINTN                   Offset;
+  UINTN                   End;
+  UINT32                  Index;
+
+  Offset = 0;
+  for (Index = 0; Index < RecordCount; Index++) {
+    if ((RecordSize - Offset) < sizeof (EFI_SMBIOS_TABLE_HEADER)) {
+      return FALSE;
+    }
+    Header = (EFI_SMBIOS_TABLE_HEADER *) (Records + Offset);
+    if (Index == 0) {
+      if ((Header->Type != EFI_SMBIOS_TYPE_PHYSICAL_MEMORY_ARRAY) || (Header->Length < sizeof (SMBIOS_TABLE_TYPE16))) {
+        return FALSE;
+      }
+    } else if (Header->Type == EFI_SMBIOS_TYPE_MEMORY_DEVICE) {
+      if (Header->Length < OFFSET_OF (SMBIOS_TABLE_TYPE17, MemoryArrayHandle) + sizeof (UINT16)) {
+        return FALSE;
+      }
+    } else if (Header->Type == EFI_SMBIOS_TYPE_MEMORY_ARRAY_MAPPED_ADDRESS) {
+      if (Header->Length < OFFSET_OF (SMBIOS_TABLE_TYPE19, MemoryArrayHandle) + sizeof (UINT16)) {
+        return FALSE;
+      }
+    } else {
+      return FALSE;
+    }
+    if (Header->Length > (RecordSize - Offset)) {
+      return FALSE;
+    }
+
+    ///
+    /// The string-set ends with a double null
+    ///
+    End = Offset + Header->Length;
+    while (((End + 1) < RecordSize) && ((Records[End] != 0) || (Records[End + 1] != 0))) {
+      End++;
+    }
+    if ((End + 1) >= RecordSize) {
+      return FALSE;
+    }
+    Offset = End + 2;
+  }
+
+  return (BOOLEAN) (Offset == RecordSize);
+}
+
+/**
+  Install the SMBIOS memory records from the cache if it matches the current boot.
+  The Type 17 and Type 19 memory array handles are updated to the newly assigned Type 16 handle.
+  If any record can't be added, the records added so far are removed again.
+
+  @param[in] SmbiosProtocol     - Instance of Smbios Protocol
+  @param[in] Key                - Cache key for the current boot.
+
+  @retval EFI_SUCCESS           - All records were installed from the cache.
+  @retval EFI_NOT_FOUND         - There is no valid cache for this memory configuration.
+  @retval others                - Records could not be added.
+**/
+EFI_STATUS
+SmbiosMemoryCacheInstall (
+  IN EFI_SMBIOS_PROTOCOL      *SmbiosProtocol,
+  IN SMBIOS_MEMORY_CACHE_KEY  *Key
+  )
+{
+  EFI_STATUS                  Status;
+  SMBIOS_MEMORY_CACHE_HEADER  *Cache;
+  UINTN                       CacheSize;
+  UINT8                       *Records;
+  EFI_SMBIOS_TABLE_HEADER     *Header;
+  EFI_SMBIOS_HANDLE           *Handles;
+  UINTN                       Offset;
+  UINT32                      Index;
+
+  CacheSize = 0;
+  Status = gRT->GetVariable (
+                  SMBIOS_MEMORY_CACHE_VARIABLE_NAME,
+                  &gSmbiosMemoryCacheVariableGuid,
+                  NULL,
+                  &CacheSize,
+                  NULL
+                  );
+  if ((Status != EFI_BUFFER_TOO_SMALL) ||
+      (CacheSize <= sizeof (SMBIOS_MEMORY_CACHE_HEADER)) ||
+      (CacheSize > SMBIOS_MEMORY_CACHE_MAX_SIZE)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Cache = AllocatePool (CacheSize);
+  if (Cache == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Handles = NULL;
+
+  Status = gRT->GetVariable (
+                  SMBIOS_MEMORY_CACHE_VARIABLE_NAME,
+                  &gSmbiosMemoryCacheVariableGuid,
+                  NULL,
+                  &CacheSize,
+                  Cache
+                  );
+  if (EFI_ERROR (Status) ||
+      (Cache->Signature != SMBIOS_MEMORY_CACHE_SIGNATURE) ||
+      (CompareMem (&Cache->Key, Key, sizeof (SMBIOS_MEMORY_CACHE_KEY)) != 0) ||
+      (Cache->RecordSize != (CacheSize - sizeof (SMBIOS_MEMORY_CACHE_HEADER))) ||
+      !SmbiosMemoryCacheValidate ((UINT8 *) (Cache + 1), Cache->RecordSize, Cache->RecordCount)) {
+    DEBUG ((DEBUG_INFO, "SMBIOS memory cache miss\n"));
+    if (!EFI_ERROR (Status)) {
+      //
+      // The cache belongs to another firmware build or memory configuration, throw it away.
+      //
+      gRT->SetVariable (SMBIOS_MEMORY_CACHE_VARIABLE_NAME, &gSmbiosMemoryCacheVariableGuid, 0, 0, NULL);
+    }
+    Status = EFI_NOT_FOUND;
+    goto Done;
+  }
+
+  Handles = AllocateZeroPool (Cache->RecordCount * sizeof (EFI_SMBIOS_HANDLE));
+  if (Handles == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  Records = (UINT8 *) (Cache + 1);
+  Offset  = 0;
+  for (Index = 0; Index < Cache->RecordCount; Index++) {
+    Header = (EFI_SMBIOS_TABLE_HEADER *) (Records + Offset);
+    if (Header->Type == EFI_SMBIOS_TYPE_MEMORY_DEVICE) {
+      ((SMBIOS_TABLE_TYPE17 *) Header)->MemoryArrayHandle = mSmbiosType16Handle;
+    } else if (Header->Type == EFI_SMBIOS_TYPE_MEMORY_ARRAY_MAPPED_ADDRESS) {
+      ((SMBIOS_TABLE_TYPE19 *) Header)->MemoryArrayHandle = mSmbiosType16Handle;
+    }
+
+    Handles[Index] = SMBIOS_HANDLE_PI_RESERVED;
+    Status = SmbiosProtocol->Add (SmbiosProtocol, NULL, &Handles[Index], Header);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "SMBIOS memory cache record %d add failed: %r\n", Index, Status));
+      while (Index > 0) {
+        Index--;
+        SmbiosProtocol->Remove (SmbiosProtocol, Handles[Index]);
+      }
+      goto Done;
+    }
+    if (Index == 0) {
+      mSmbiosType16Handle = Handles[0];
+    }
+
+    ///
+    /// Skip the formatted area and the string-set (already validated to end with a double null)
+    ///
+    Offset += Header->Length;
+    while ((Records[Offset] != 0) || (Records[Offset + 1] != 0)) {
+      Offset++;
+    }
+    Offset += 2;
+  }
+
+  DEBUG ((DEBUG_INFO, "SMBIOS memory records installed from cache (%d records)\n", Cache->RecordCount));
+  Status = EFI_SUCCESS;
+
+Done:
+  if (Handles != NULL) {
+    FreePool (Handles);
+  }
+  FreePool (Cache);
+  return Status;
+}
+
+/**
+  Start recording the SMBIOS memory records added by AddSmbiosEntry.
+**/
+VOID
+SmbiosMemoryCacheCaptureStart (
+  VOID
+  )
+{
+  mSmbiosMemoryCache = AllocateZeroPool (SMBIOS_MEMORY_CACHE_MAX_SIZE);
+  mSmbiosMemoryCacheSize = sizeof (SMBIOS_MEMORY_CACHE_HEADER);
+  mSmbiosMemoryCacheRecordCount = 0;
+}
+
+/**
+  Record one SMBIOS memory record, if recording was started.
+  Recording is abandoned if the records don't fit in the cache.
+
+  @param[in] Record             - Full SMBIOS record, including the string-set.
+  @param[in] RecordSize         - Size of the record.
+**/
+VOID
+SmbiosMemoryCacheAppend (
+  IN EFI_SMBIOS_TABLE_HEADER  *Record,
+  IN UINTN                    RecordSize
+  )
+{
+  if (mSmbiosMemoryCache == NULL) {
+    return;
+  }
+
+  if (RecordSize > (SMBIOS_MEMORY_CACHE_MAX_SIZE - mSmbiosMemoryCacheSize)) {
+    DEBUG ((DEBUG_WARN, "SMBIOS memory cache too small, records will not be cached\n"));
+    FreePool (mSmbiosMemoryCache);
+    mSmbiosMemoryCache = NULL;
+    return;
+  }
+
+  CopyMem (mSmbiosMemoryCache + mSmbiosMemoryCacheSize, Record, RecordSize);
+  mSmbiosMemoryCacheSize += RecordSize;
+  mSmbiosMemoryCacheRecordCount++;
+}
+
+/**
+  Stop recording and store the recorded SMBIOS memory records for the following boots.
+
+  @param[in] Key                - Cache key for the current boot.
+  @param[in] Save               - TRUE if the records are complete and shall be stored.
+**/
+VOID
+SmbiosMemoryCacheCaptureEnd (
+  IN SMBIOS_MEMORY_CACHE_KEY  *Key,
+  IN BOOLEAN                  Save
+  )
+{
+  EFI_STATUS                  Status;
+  SMBIOS_MEMORY_CACHE_HEADER  *Cache;
+
+  if (mSmbiosMemoryCache == NULL) {
+    return;
+  }
+
+  if (Save && (mSmbiosMemoryCacheRecordCount != 0)) {
+    Cache = (SMBIOS_MEMORY_CACHE_HEADER *) mSmbiosMemoryCache;
+    Cache->Signature   = SMBIOS_MEMORY_CACHE_SIGNATURE;
+    Cache->RecordCount = mSmbiosMemoryCacheRecordCount;
+    Cache->RecordSize  = (UINT32) (mSmbiosMemoryCacheSize - sizeof (SMBIOS_MEMORY_CACHE_HEADER));
+    CopyMem (&Cache->Key, Key, sizeof (SMBIOS_MEMORY_CACHE_KEY));
+
+    Status = gRT->SetVariable (
+                    SMBIOS_MEMORY_CACHE_VARIABLE_NAME,
+                    &gSmbiosMemoryCacheVariableGuid,
+                    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                    mSmbiosMemoryCacheSize,
+                    Cache
+                    );
+    DEBUG ((DEBUG_INFO, "SMBIOS memory cache saved (%d records): %r\n", mSmbiosMemoryCacheRecordCount, Status));
+  }
+
+  FreePool (mSmbiosMemoryCache);
+  mSmbiosMemoryCache = NULL;
+}
@@ -1645,6 +1645,19 @@ typedef struct {
   MrcSaveData   Data;   ///< The data portion of the MRC saved data.
 } MrcSave;
 
+#define MRC_SAVE_COMPACT_SIGNATURE  (0x5043524D)  ///< "MRCP", marks MRC saved data in the compact format.
+
+///
+/// Header of the compact MRC saved data stream. The LZ compressed, delta coded MrcSaveData follows it.
+/// Size and Header match the leading fields of MrcSave so consumers of those fields see no difference.
+///
+typedef struct {
+  UINT32        Size;       ///< The size of the whole compact stream, in bytes. Must be the first entry in this structure.
+  MrcSaveHeader Header;     ///< The CRC-32 of the expanded MrcSaveData.
+  UINT32        Signature;  ///< MRC_SAVE_COMPACT_SIGNATURE.
+  UINT32        DataSize;   ///< The size of the expanded MrcSaveData, in bytes.
+} MrcSaveCompactHeader;
+
 typedef struct {
   // Global variables that will be copied to the HOB follow.
   UINT8        MrcDataString[4]; ///< Beginning of global data marker, starts with "MRC". Must be the first entry in this structure.
@@ -1714,6 +1727,42 @@ MrcCalculateCrc32 (
   IN     const UINT32 DataSize
   );
 
+/**
+  Serializes the MRC saved data into the compact format used for NV storage.
+  Per-strobe registers are delta coded against strobe 0 of their channel and the result is LZ compressed.
+
+  @param[in, out] MrcData    - Include all the MRC global data. The saved data is left unchanged on return.
+  @param[out]     Buffer     - Location to store the compact stream, or NULL to only calculate its size.
+  @param[in]      BufferSize - Size of Buffer, in bytes.
+
+  @retval The size of the compact stream in bytes, or 0 if it does not fit in Buffer.
+**/
+extern
+UINT32
+MrcSaveCompact (
+  IN OUT MrcParameters *const MrcData,
+  OUT    UINT8         *const Buffer,
+  IN     const UINT32  BufferSize
+  );
+
+/**
+  Expands MRC saved data in the compact format back into an MrcSave structure.
+  The caller is still responsible for checking the CRC of the expanded data.
+
+  @param[in]  Buffer     - Pointer to the compact stream.
+  @param[in]  BufferSize - Size of Buffer, in bytes.
+  @param[out] Save       - Location to store the expanded saved data.
+
+  @retval mrcSuccess if Buffer holds a well formed compact stream, otherwise mrcFail.
+**/
+extern
+MrcStatus
+MrcSaveExpand (
+  IN     const UINT8  *const Buffer,
+  IN     const UINT32 BufferSize,
+  OUT    MrcSave      *const Save
+  );
+
 /**
   This function resets the DISB bit in General PM Configuration 2 B:D:F 0,31,0 offset 0xA2.
 
@@ -102,6 +102,16 @@ extern EFI_GUID gMargin2DResultColumnsGuid;
 */
 extern EFI_GUID gMrcSchemaListHobGuid;
 
+/*
+ MRC step profile schema GUID
+ Identifies the MRC_PROFILE_SCHEMA HOB and its copy in the BDAT.
+ {6B2B0E5C-2C8A-4F4B-9E07-3D1C5A7E4F21}
+*/
+extern EFI_GUID gMrcProfileSchemaGuid;
+
+#define MRC_PROFILE_REVISION   (2)
+#define MRC_PROFILE_MAX_STEPS  (96)   ///< Must be at least OemNumOfCommands.
+
 #pragma pack(push, 1)
 
 typedef struct {
@@ -277,6 +287,40 @@ typedef struct {
   BDAT_MEMORY_DATA_STRUCTURE  MemorySchema;
 } BDAT_MEMORY_DATA_HOB;
 
+///
+/// Profile of one MRC step. A step starts at an MrcOemStatusCommand checkpoint and ends at the next checkpoint.
+/// The register counters only cover accesses made through the register cache (MrcRegisterCache.c).
+/// Direct MrcReadCR/MrcWriteCR and MRC_FUNCTION MMIO accesses are not counted.
+///
+typedef struct {
+  UINT32                      Calls;                            ///< Number of times the checkpoint was reached.
+  UINT32                      TimeUs;                           ///< Total time spent in the step, in microseconds.
+  UINT32                      CrReads;                          ///< MCHBAR register reads issued by the register cache.
+  UINT32                      CrWrites;                         ///< MCHBAR register writes issued by the register cache.
+  UINT32                      CacheHits;                        ///< Register reads satisfied from the register cache.
+} MRC_PROFILE_STEP;
+
+typedef struct {
+  UINT8                       Revision;                         ///< MRC_PROFILE_REVISION.
+  UINT8                       BootMode;                         ///< MRC boot mode of the profiled boot.
+  UINT8                       DdrType;                          ///< DDR type of the populated DIMMs.
+  UINT8                       StepCount;                        ///< Number of valid entries in Step, indexed by MrcOemStatusCommand.
+  UINT32                      Frequency;                        ///< Memory frequency, in MT/s.
+  UINT32                      TotalTimeUs;                      ///< Time from the first to the last checkpoint, in microseconds.
+  UINT8                       RankMask[MAX_CONTROLLERS][MAX_CHANNEL]; ///< Populated ranks per channel, identifies the DIMM population.
+  UINT32                      HeapSize;                         ///< MRC heap size, in bytes.
+  UINT32                      HeapHighWater;                    ///< Highest MRC heap usage, in bytes. Minimum heap size for this configuration.
+  UINT32                      HeapAllocCount;                   ///< Number of MRC heap allocations.
+  UINT32                      HeapFailCount;                    ///< Number of MRC heap allocations that failed.
+  UINT32                      HeapFreeListBytes;                ///< MRC heap bytes held in free lists at the end of MRC.
+  MRC_PROFILE_STEP            Step[MRC_PROFILE_MAX_STEPS];      ///< Per step data.
+} MRC_PROFILE_DATA;
+
+typedef struct {
+  MRC_BDAT_SCHEMA_HEADER_STRUCTURE SchemaHeader;                ///< The schema header, SchemaId is gMrcProfileSchemaGuid.
+  MRC_PROFILE_DATA            Profile;                          ///< The profile data.
+} MRC_PROFILE_SCHEMA;
+
 #pragma pack (pop)
 
 typedef struct {
@@ -923,23 +923,15 @@ addr_decode_map_parse (
   BOOLEAN second_round
   )
 {
-  // gets the configuration case we need from the addr_decode_map.csv file
-  UINT16 i;
-  UINT8 curr_cfg;
-  for (i = 0; i < MAXFLDSIZE; i++) {
-    curr_cfg = ConfigArrayConst[i][0];
-    if (second_round) {
-      if (curr_cfg == config_case) { // if match the configuration case we are lookink for
-        break;
-      }
-    } else {
-      if ((curr_cfg >= config_case) && (curr_cfg < (config_case + 1))) { // if almost match the configuration case we are lookink for
-        break;
-      }
-    }
+  // ConfigArrayConst rows are stored in configuration case order (row N holds case N),
+  // so the row is indexed directly instead of being searched for.
+  if (config_case >= MAXFLDSIZE) {
+    // Unknown configuration - return an empty map rather than reading past the table
+    MrcCall->MrcSetMem ((UINT8 *) config_arr, sizeof (ConfigArrayConst[0]), 0);
+    return;
   }
-  //Found a configuration - copying it to the config array
-  MrcCall->MrcCopyMem ((UINT8 *) config_arr, (UINT8 *) &ConfigArrayConst[i], sizeof (ConfigArrayConst[i]));
+  ASSERT (ConfigArrayConst[config_case][0] == config_case);
+  MrcCall->MrcCopyMem ((UINT8 *) config_arr, (UINT8 *) &ConfigArrayConst[config_case], sizeof (ConfigArrayConst[config_case]));
 
 }
 
@@ -951,22 +943,13 @@ enhanced_mode_map_parse (
   BOOLEAN second_round
   )
 {
-  UINT16 i = 0;
-
-  // gets the configuration case we need
-  for (i = 0; i < MAXFLDSIZE; i++) {
-    if (second_round) {
-      if (EnhConfigArrayConst[i][0] == config_case) { // if match the configuration case we are looking for
-        break;
-      }
-    } else {
-      if ((EnhConfigArrayConst[i][0] >= config_case) && (EnhConfigArrayConst[i][0] < (config_case + 1))) { // if almost match the configuration case we are lookink for
-       break;
-      }
-    }
+  // EnhConfigArrayConst rows are stored in configuration case order, same as ConfigArrayConst
+  if (config_case >= MAXFLDSIZE) {
+    MrcCall->MrcSetMem ((UINT8 *) enh_config_arr, sizeof (EnhConfigArrayConst[0]), 0);
+    return;
   }
-  //Found a configuration - copying it to the config array
-  MrcCall->MrcCopyMem ((UINT8 *) enh_config_arr, (UINT8 *) &EnhConfigArrayConst[i], sizeof (EnhConfigArrayConst[i]));
+  ASSERT (EnhConfigArrayConst[config_case][0] == config_case);
+  MrcCall->MrcCopyMem ((UINT8 *) enh_config_arr, (UINT8 *) &EnhConfigArrayConst[config_case], sizeof (EnhConfigArrayConst[config_case]));
 
 }
 
@@ -1690,33 +1673,7 @@ MrcDecode (
 
 
     if (chan_line < MrcCall->MrcLeftShift64 (dimm_s_size, 1)) { // Range 0 limit = 2 * dimm_s_size
-      // get the configuration case
-      config_case_num = get_the_config_case_num(
-                          MrcCall,
-                          ddr_type,
-                          is_ddr4e,
-                          chnl_num_of_dimms,
-                          chnl_num_of_ranks,
-                          get_dimm_l_number_of_ranks (selected_mad_dimm),
-                          get_dimm_l_width (selected_mad_dimm),
-                          same_dimm_width,
-                          dimm_and_rank_interleaving,
-                          TRUE,
-                          get_wio2_configuration (selected_mad_dimm, CHANNEL_EHASH)
-                          );
-
-
-      config_case_num_int_for_switch = config_case_num;
-
-      // calling the parsing method, to get the address decode map for the current configuration.
-      // This is the first call, just to know the DIMM shifters
-      // in the case of no interleave mode, we don't need this call
-      if (dimm_and_rank_interleaving) {
-        addr_decode_map_parse (MrcCall, config_arr, config_case_num, FALSE);
-        if (enhanced_interleave_mode) {
-          enhanced_mode_map_parse (MrcCall, enh_config_arr, config_case_num, FALSE);
-        }
-      }
+      // config_case_num, config_arr and enh_config_arr already hold the zone 0 map parsed above.
 
 
       // Determine if the sub channel hash feature is being used
@@ -2673,21 +2630,7 @@ MrcEncode (
   // Find the dimm width chnl configuration
   same_dimm_width =   (dimm_s_size) ?
                       ((get_dimm_l_width (mad_dimm_l[chan]) == get_dimm_s_width (mad_dimm_l[chan])) ? TRUE : FALSE) : TRUE;
-  // get the configuration case
-  config_case_num = get_the_config_case_num (
-                      MrcCall,
-                      ddr_type,
-                      is_ddr4e,
-                      chnl_num_of_dimms,
-                      chnl_num_of_ranks,
-                      get_dimm_l_number_of_ranks (mad_dimm_l[chan]),
-                      get_dimm_l_width (mad_dimm_l[chan]),
-                      same_dimm_width,
-                      dimm_and_rank_interleaving,
-                      !rerun_zone_1,
-                      get_wio2_configuration (mad_dimm_l[chan],CHANNEL_EHASH)
-                      );
-
+  // The configuration case is computed at the top of the zone loop below
   while (!found_the_dimm_zone) {
     config_case_num = get_the_config_case_num (
                         MrcCall,
@@ -67,6 +67,8 @@
 #include "MrcDebugHook.h"
 #include "MrcMalloc.h"
 #include "MrcMemoryMap.h"
+#include "MrcCallRecorder.h"
+#include "MrcProfile.h"
 #include <Library/PcdLib.h>
 #include <Library/PerformanceLib.h>
 #include <Library/TxtLib.h>
@@ -591,11 +593,20 @@ DEBUG_CODE_END();
   if ((MiscPeiPreMemConfig->S3DataPtr != NULL) && (SysBootMode != BOOT_WITH_DEFAULT_SETTINGS)) {
     SaveSys = (MrcSave *) (MiscPeiPreMemConfig->S3DataPtr);
     Save    = SaveSys;
+    //
+    // Saved data in the compact format is expanded directly into the MRC global data.
+    //
+    if (MrcSaveExpand ((UINT8 *) SaveSys, SaveSys->Size, &MrcData->Save) == mrcSuccess) {
+      DEBUG ((DEBUG_INFO, "Expanded compact saved data of size %d\n", SaveSys->Size));
+      Save = &MrcData->Save;
+    }
     Crc32 = MrcCalculateCrc32 ((UINT8 *) (&Save->Data), sizeof (MrcSaveData));
     DEBUG ((DEBUG_INFO, "Calc. crc = 0x%x, Header crc = 0x%x\n", Crc32, Save->Header.Crc));
     if (Crc32 == Save->Header.Crc) {
       DEBUG ((DEBUG_INFO, "Saved memory configuration data is valid\n"));
-      ((*PeiServices)->CopyMem) ((VOID *) &MrcData->Save, (VOID *) SaveSys, sizeof (MrcSave));
+      if (Save == SaveSys) {
+        ((*PeiServices)->CopyMem) ((VOID *) &MrcData->Save, (VOID *) SaveSys, sizeof (MrcSave));
+      }
       SaveDataValid = TRUE;
     }
   }
@@ -893,6 +904,12 @@ DEBUG_CODE_END();
     } // switch MrcStatus
   } while (MrcStatus == mrcColdBootRequired);
 
+  MrcHeapReport (MrcData);
+
+  if (FeaturePcdGet (PcdMrcProfileEnable)) {
+    MrcProfileFinalize (MrcData);
+  }
+
   // Set the MSR bit VIRTUAL_MSR_CR_POWER_CTL.SAPM_iMC_C2_POLICY(bit2) to 0 if.serialize_zq is 1.
   if (Inputs->SharedZqPin == 1) {
     MsrData = MrcCall->MrcReadMsr64 (MSR_POWER_CTL);
@@ -2249,7 +2266,13 @@ MrcGetBdatSchemaListHob (
   MRC_BDAT_SCHEMA_LIST_HOB *Buffer;
 
   Status = EFI_SUCCESS;
+  //
+  // The schema list may continue over several HOBs, new schemas go to the last one.
+  //
   Buffer = (MRC_BDAT_SCHEMA_LIST_HOB *) GetFirstGuidHob (&SchemaListGuid);
+  while ((Buffer != NULL) && (GetNextGuidHob (&SchemaListGuid, GET_NEXT_HOB (Buffer)) != NULL)) {
+    Buffer = (MRC_BDAT_SCHEMA_LIST_HOB *) GetNextGuidHob (&SchemaListGuid, GET_NEXT_HOB (Buffer));
+  }
 
   if (Buffer != NULL) {
     DEBUG ((DEBUG_INFO, "BDAT Schema List HOB already exists\n"));
@@ -2565,6 +2588,14 @@ MrcSetupOem (
 
   MrcCall->MrcTxtAcheck            = (MRC_TXT_ACHECK) MrcTxtAcheck;
 
+  if (FeaturePcdGet (PcdMrcCallRecordEnable)) {
+    MrcCallRecorderInstall (MrcCall);
+  }
+
+  if (FeaturePcdGet (PcdMrcProfileEnable)) {
+    MrcProfileInstall (MrcData);
+  }
+
   return;
 }
 
@@ -3041,7 +3072,8 @@ BuildMemoryS3DataHob (
   IN MrcParameters            *MrcData
   )
 {
-  VOID *HobPtr;
+  VOID   *HobPtr;
+  UINT32 CompactSize;
 
   HobPtr = NULL;
 
@@ -3052,11 +3084,24 @@ BuildMemoryS3DataHob (
           (UINTN) MrcData->Save.Size
           ));
 
-  HobPtr = BuildGuidDataHob (
-             &gSiMemoryS3DataGuid,
-             (VOID *)&(MrcData->Save),
-             (UINTN) MrcData->Save.Size
-           );
+  //
+  // Publish the compact form of the saved data when it is smaller, so that less data is written to NV storage.
+  //
+  CompactSize = MrcSaveCompact (MrcData, NULL, 0);
+  if ((CompactSize != 0) && (CompactSize < MrcData->Save.Size)) {
+    HobPtr = BuildGuidHob (&gSiMemoryS3DataGuid, CompactSize);
+    if (HobPtr != NULL) {
+      CompactSize = MrcSaveCompact (MrcData, (UINT8 *) HobPtr, CompactSize);
+      ASSERT (CompactSize != 0);
+      DEBUG ((DEBUG_INFO, "MemoryS3DataHob Compact Size : %x\n", CompactSize));
+    }
+  } else {
+    HobPtr = BuildGuidDataHob (
+               &gSiMemoryS3DataGuid,
+               (VOID *)&(MrcData->Save),
+               (UINTN) MrcData->Save.Size
+             );
+  }
   ASSERT (HobPtr != NULL);
 }
 
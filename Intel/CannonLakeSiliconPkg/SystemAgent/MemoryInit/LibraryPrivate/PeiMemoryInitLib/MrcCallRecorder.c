@@ -0,0 +1,525 @@
+/** @file
+  MRC call table recorder.
+
+  The MRC call table entries take no context argument and MRC runs before
+  permanent memory, so the wrappers cannot keep a copy of the replaced entries.
+  They forward to the same IoLib, SmbusLib, CpuMailboxLib and BaseLib services
+  that the reference SA policy installs into SA_FUNCTION_CALLS.
+  The 64-bit MMIO entries are left alone: the platform provides MMX based
+  accessors for them because some MC registers need a single atomic access.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/TraceEventLib.h>
+#include "MrcInterface.h"
+#include "MrcCallRecorder.h"
+
+/**
+  Return the MRC call table as it was before the recording wrappers were installed.
+
+  The MRC callbacks get no MRC context, so the original entries are kept in a GUID HOB.
+  The HOB moves with the HOB list when memory is installed, which the MRC global data
+  on the temporary RAM stack does not.
+
+  @retval Pointer to the saved MRC call table.
+**/
+STATIC
+CONST MRC_FUNCTION *
+MrcRecOriginal (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE *GuidHob;
+
+  GuidHob = GetFirstGuidHob (&gMrcCallRecorderHobGuid);
+  ASSERT (GuidHob != NULL);
+  return (CONST MRC_FUNCTION *) GET_GUID_HOB_DATA (GuidHob);
+}
+
+/**
+  Read 8 bits from an IO port and record the access.
+
+  @param[in] IoAddress - IO port to read.
+
+  @retval The value read.
+**/
+STATIC
+UINT8
+MrcRecIoRead8 (
+  IN UINT32 IoAddress
+  )
+{
+  UINT8 Value;
+
+  Value = MrcRecOriginal ()->MrcIoRead8 (IoAddress);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_IO_READ, IoAddress, Value, sizeof (UINT8));
+  return Value;
+}
+
+/**
+  Read 16 bits from an IO port and record the access.
+
+  @param[in] IoAddress - IO port to read.
+
+  @retval The value read.
+**/
+STATIC
+UINT16
+MrcRecIoRead16 (
+  IN UINT32 IoAddress
+  )
+{
+  UINT16 Value;
+
+  Value = MrcRecOriginal ()->MrcIoRead16 (IoAddress);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_IO_READ, IoAddress, Value, sizeof (UINT16));
+  return Value;
+}
+
+/**
+  Read 32 bits from an IO port and record the access.
+
+  @param[in] IoAddress - IO port to read.
+
+  @retval The value read.
+**/
+STATIC
+UINT32
+MrcRecIoRead32 (
+  IN UINT32 IoAddress
+  )
+{
+  UINT32 Value;
+
+  Value = MrcRecOriginal ()->MrcIoRead32 (IoAddress);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_IO_READ, IoAddress, Value, sizeof (UINT32));
+  return Value;
+}
+
+/**
+  Write 8 bits to an IO port and record the access.
+
+  @param[in] IoAddress - IO port to write.
+  @param[in] Value     - The value to write.
+**/
+STATIC
+void
+MrcRecIoWrite8 (
+  IN UINT32 IoAddress,
+  IN UINT8  Value
+  )
+{
+  MrcRecOriginal ()->MrcIoWrite8 (IoAddress, Value);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_IO_WRITE, IoAddress, Value, sizeof (UINT8));
+}
+
+/**
+  Write 16 bits to an IO port and record the access.
+
+  @param[in] IoAddress - IO port to write.
+  @param[in] Value     - The value to write.
+**/
+STATIC
+void
+MrcRecIoWrite16 (
+  IN UINT32 IoAddress,
+  IN UINT16 Value
+  )
+{
+  MrcRecOriginal ()->MrcIoWrite16 (IoAddress, Value);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_IO_WRITE, IoAddress, Value, sizeof (UINT16));
+}
+
+/**
+  Write 32 bits to an IO port and record the access.
+
+  @param[in] IoAddress - IO port to write.
+  @param[in] Value     - The value to write.
+**/
+STATIC
+void
+MrcRecIoWrite32 (
+  IN UINT32 IoAddress,
+  IN UINT32 Value
+  )
+{
+  MrcRecOriginal ()->MrcIoWrite32 (IoAddress, Value);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_IO_WRITE, IoAddress, Value, sizeof (UINT32));
+}
+
+/**
+  Read 8 bits from MMIO and record the access.
+
+  @param[in] Address - MMIO address to read.
+
+  @retval The value read.
+**/
+STATIC
+UINT8
+MrcRecMmioRead8 (
+  IN UINT32 Address
+  )
+{
+  UINT8 Value;
+
+  Value = MrcRecOriginal ()->MrcMmioRead8 (Address);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MMIO_READ, Address, Value, 0, sizeof (UINT8));
+  return Value;
+}
+
+/**
+  Read 16 bits from MMIO and record the access.
+
+  @param[in] Address - MMIO address to read.
+
+  @retval The value read.
+**/
+STATIC
+UINT16
+MrcRecMmioRead16 (
+  IN UINT32 Address
+  )
+{
+  UINT16 Value;
+
+  Value = MrcRecOriginal ()->MrcMmioRead16 (Address);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MMIO_READ, Address, Value, 0, sizeof (UINT16));
+  return Value;
+}
+
+/**
+  Read 32 bits from MMIO and record the access.
+
+  @param[in] Address - MMIO address to read.
+
+  @retval The value read.
+**/
+STATIC
+UINT32
+MrcRecMmioRead32 (
+  IN UINT32 Address
+  )
+{
+  UINT32 Value;
+
+  Value = MrcRecOriginal ()->MrcMmioRead32 (Address);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MMIO_READ, Address, Value, 0, sizeof (UINT32));
+  return Value;
+}
+
+/**
+  Write 8 bits to MMIO and record the access.
+
+  @param[in] Address - MMIO address to write.
+  @param[in] Value   - The value to write.
+
+  @retval The value written.
+**/
+STATIC
+UINT8
+MrcRecMmioWrite8 (
+  IN UINT32 Address,
+  IN UINT8  Value
+  )
+{
+  Value = MrcRecOriginal ()->MrcMmioWrite8 (Address, Value);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MMIO_WRITE, Address, Value, 0, sizeof (UINT8));
+  return Value;
+}
+
+/**
+  Write 16 bits to MMIO and record the access.
+
+  @param[in] Address - MMIO address to write.
+  @param[in] Value   - The value to write.
+
+  @retval The value written.
+**/
+STATIC
+UINT16
+MrcRecMmioWrite16 (
+  IN UINT32 Address,
+  IN UINT16 Value
+  )
+{
+  Value = MrcRecOriginal ()->MrcMmioWrite16 (Address, Value);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MMIO_WRITE, Address, Value, 0, sizeof (UINT16));
+  return Value;
+}
+
+/**
+  Write 32 bits to MMIO and record the access.
+
+  @param[in] Address - MMIO address to write.
+  @param[in] Value   - The value to write.
+
+  @retval The value written.
+**/
+STATIC
+UINT32
+MrcRecMmioWrite32 (
+  IN UINT32 Address,
+  IN UINT32 Value
+  )
+{
+  Value = MrcRecOriginal ()->MrcMmioWrite32 (Address, Value);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MMIO_WRITE, Address, Value, 0, sizeof (UINT32));
+  return Value;
+}
+
+/**
+  Read a byte from an SMBus device and record the access.
+
+  @param[in]  Address - SMBus address as encoded by SMBUS_LIB_ADDRESS.
+  @param[out] Status  - Return status of the transaction.
+
+  @retval The value read.
+**/
+STATIC
+UINT8
+MrcRecSmbusRead8 (
+  IN  UINT32 Address,
+  OUT UINT32 *Status
+  )
+{
+  UINT8 Value;
+
+  Value = MrcRecOriginal ()->MrcSmbusRead8 (Address, Status);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_SMBUS_READ, Address, Value, sizeof (UINT8), *Status);
+  return Value;
+}
+
+/**
+  Read a word from an SMBus device and record the access.
+
+  @param[in]  Address - SMBus address as encoded by SMBUS_LIB_ADDRESS.
+  @param[out] Status  - Return status of the transaction.
+
+  @retval The value read.
+**/
+STATIC
+UINT16
+MrcRecSmbusRead16 (
+  IN  UINT32 Address,
+  OUT UINT32 *Status
+  )
+{
+  UINT16 Value;
+
+  Value = MrcRecOriginal ()->MrcSmbusRead16 (Address, Status);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_SMBUS_READ, Address, Value, sizeof (UINT16), *Status);
+  return Value;
+}
+
+/**
+  Write a byte to an SMBus device and record the access.
+
+  @param[in]  Address - SMBus address as encoded by SMBUS_LIB_ADDRESS.
+  @param[in]  Value   - The value to write.
+  @param[out] Status  - Return status of the transaction.
+
+  @retval The value written.
+**/
+STATIC
+UINT8
+MrcRecSmbusWrite8 (
+  IN  UINT32 Address,
+  IN  UINT8  Value,
+  OUT UINT32 *Status
+  )
+{
+  Value = MrcRecOriginal ()->MrcSmbusWrite8 (Address, Value, Status);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_SMBUS_WRITE, Address, Value, sizeof (UINT8), *Status);
+  return Value;
+}
+
+/**
+  Write a word to an SMBus device and record the access.
+
+  @param[in]  Address - SMBus address as encoded by SMBUS_LIB_ADDRESS.
+  @param[in]  Value   - The value to write.
+  @param[out] Status  - Return status of the transaction.
+
+  @retval The value written.
+**/
+STATIC
+UINT16
+MrcRecSmbusWrite16 (
+  IN  UINT32 Address,
+  IN  UINT16 Value,
+  OUT UINT32 *Status
+  )
+{
+  Value = MrcRecOriginal ()->MrcSmbusWrite16 (Address, Value, Status);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_SMBUS_WRITE, Address, Value, sizeof (UINT16), *Status);
+  return Value;
+}
+
+/**
+  Issue a CPU mailbox read command and record the access.
+
+  @param[in]  Type    - Mailbox type.
+  @param[in]  Command - Mailbox command.
+  @param[out] Value   - Data returned by the mailbox.
+  @param[out] Status  - Mailbox status returned by pcode.
+
+  @retval The status returned by the original callback.
+**/
+STATIC
+UINT32
+MrcRecCpuMailboxRead (
+  IN  UINT32 Type,
+  IN  UINT32 Command,
+  OUT UINT32 *Value,
+  OUT UINT32 *Status
+  )
+{
+  UINT32 RetStatus;
+
+  RetStatus = MrcRecOriginal ()->MrcCpuMailboxRead (Type, Command, Value, Status);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MBOX_READ, Type, Command, *Value, *Status);
+  return RetStatus;
+}
+
+/**
+  Issue a CPU mailbox write command and record the access.
+
+  @param[in]  Type    - Mailbox type.
+  @param[in]  Command - Mailbox command.
+  @param[in]  Value   - Data to write.
+  @param[out] Status  - Mailbox status returned by pcode.
+
+  @retval The status returned by the original callback.
+**/
+STATIC
+UINT32
+MrcRecCpuMailboxWrite (
+  IN  UINT32 Type,
+  IN  UINT32 Command,
+  IN  UINT32 Value,
+  OUT UINT32 *Status
+  )
+{
+  UINT32 RetStatus;
+
+  RetStatus = MrcRecOriginal ()->MrcCpuMailboxWrite (Type, Command, Value, Status);
+  TRACE_EVENT4 (TRACE_EVENT_MRC_CALL_MBOX_WRITE, Type, Command, Value, *Status);
+  return RetStatus;
+}
+
+/**
+  Read an MSR and record the access.
+
+  @param[in] Location - MSR index.
+
+  @retval The value read.
+**/
+STATIC
+UINT64
+MrcRecReadMsr64 (
+  IN UINT32 Location
+  )
+{
+  UINT64 Value;
+
+  Value = MrcRecOriginal ()->MrcReadMsr64 (Location);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_MSR_READ, Location, (UINT32) Value, (UINT32) RShiftU64 (Value, 32));
+  return Value;
+}
+
+/**
+  Write an MSR and record the access.
+
+  @param[in] Location - MSR index.
+  @param[in] Data     - The value to write.
+
+  @retval The value written.
+**/
+STATIC
+UINT64
+MrcRecWriteMsr64 (
+  IN UINT32 Location,
+  IN UINT64 Data
+  )
+{
+  Data = MrcRecOriginal ()->MrcWriteMsr64 (Location, Data);
+  TRACE_EVENT3 (TRACE_EVENT_MRC_CALL_MSR_WRITE, Location, (UINT32) Data, (UINT32) RShiftU64 (Data, 32));
+  return Data;
+}
+
+/**
+  Save the MRC call table in a HOB and install the recording wrappers, which forward
+  every access to the saved entry before recording it.
+
+  @param[in, out] MrcCall         - MRC call table to patch.
+**/
+VOID
+MrcCallRecorderInstall (
+  IN OUT MRC_FUNCTION             *MrcCall
+  )
+{
+  MRC_FUNCTION *Original;
+
+  Original = BuildGuidHob (&gMrcCallRecorderHobGuid, sizeof (MRC_FUNCTION));
+  if (Original == NULL) {
+    DEBUG ((DEBUG_WARN, "MRC call recorder HOB could not be created\n"));
+    return;
+  }
+  CopyMem (Original, MrcCall, sizeof (MRC_FUNCTION));
+
+  MrcCall->MrcIoRead8         = (MRC_IO_READ_8) MrcRecIoRead8;
+  MrcCall->MrcIoRead16        = (MRC_IO_READ_16) MrcRecIoRead16;
+  MrcCall->MrcIoRead32        = (MRC_IO_READ_32) MrcRecIoRead32;
+  MrcCall->MrcIoWrite8        = (MRC_IO_WRITE_8) MrcRecIoWrite8;
+  MrcCall->MrcIoWrite16       = (MRC_IO_WRITE_16) MrcRecIoWrite16;
+  MrcCall->MrcIoWrite32       = (MRC_IO_WRITE_32) MrcRecIoWrite32;
+  MrcCall->MrcMmioRead8       = (MRC_MMIO_READ_8) MrcRecMmioRead8;
+  MrcCall->MrcMmioRead16      = (MRC_MMIO_READ_16) MrcRecMmioRead16;
+  MrcCall->MrcMmioRead32      = (MRC_MMIO_READ_32) MrcRecMmioRead32;
+  MrcCall->MrcMmioWrite8      = (MRC_MMIO_WRITE_8) MrcRecMmioWrite8;
+  MrcCall->MrcMmioWrite16     = (MRC_MMIO_WRITE_16) MrcRecMmioWrite16;
+  MrcCall->MrcMmioWrite32     = (MRC_MMIO_WRITE_32) MrcRecMmioWrite32;
+  MrcCall->MrcSmbusRead8      = (MRC_SMBUS_READ_8) MrcRecSmbusRead8;
+  MrcCall->MrcSmbusRead16     = (MRC_SMBUS_READ_16) MrcRecSmbusRead16;
+  MrcCall->MrcSmbusWrite8     = (MRC_SMBUS_WRITE_8) MrcRecSmbusWrite8;
+  MrcCall->MrcSmbusWrite16    = (MRC_SMBUS_WRITE_16) MrcRecSmbusWrite16;
+  MrcCall->MrcCpuMailboxRead  = (MRC_CPU_MAILBOX_READ) MrcRecCpuMailboxRead;
+  MrcCall->MrcCpuMailboxWrite = (MRC_CPU_MAILBOX_WRITE) MrcRecCpuMailboxWrite;
+  MrcCall->MrcReadMsr64       = (MRC_MSR_READ_64) MrcRecReadMsr64;
+  MrcCall->MrcWriteMsr64      = (MRC_MSR_WRITE_64) MrcRecWriteMsr64;
+}
@@ -0,0 +1,227 @@
+/** @file
+  MRC step profile.
+
+  Times every MRC checkpoint and counts the register accesses made by each step.
+  The result is kept in a HOB in the BDAT schema format, so it is also published
+  through the BDAT for OS tools.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/TimerLib.h>
+#include "MrcGlobal.h"
+#include "MrcSpdProcessing.h"
+#include "MrcMalloc.h"
+#include "MrcBdat.h"
+#include "MrcProfile.h"
+
+#define MRC_PROFILE_NO_STEP  MAX_UINT32
+
+/**
+  Charge the time and register accesses since the last checkpoint to the current step.
+
+  @param[in, out] MrcIntData      - Pointer to the MRC internal data structure.
+  @param[in]      Now             - Current performance counter value.
+**/
+STATIC
+VOID
+MrcProfileCloseStep (
+  IN OUT MrcIntOutput             *MrcIntData,
+  IN     UINT64                   Now
+  )
+{
+  MRC_PROFILE_DATA  *Profile;
+  MRC_PROFILE_STEP  *Step;
+  MrcIntAccessCount *Start;
+  UINT32            TimeUs;
+
+  Profile = (MRC_PROFILE_DATA *) MrcIntData->Profile.Data;
+  Start   = &MrcIntData->Profile.StepAccess;
+  if (MrcIntData->Profile.Step < MRC_PROFILE_MAX_STEPS) {
+    TimeUs               = (UINT32) DivU64x32 (GetTimeInNanoSecond (Now - MrcIntData->Profile.StepStart), 1000);
+    Step                 = &Profile->Step[MrcIntData->Profile.Step];
+    Step->TimeUs        += TimeUs;
+    Step->CrReads       += MrcIntData->AccessCount.CrReads - Start->CrReads;
+    Step->CrWrites      += MrcIntData->AccessCount.CrWrites - Start->CrWrites;
+    Step->CacheHits     += MrcIntData->AccessCount.CacheHits - Start->CacheHits;
+    Profile->TotalTimeUs += TimeUs;
+  }
+  MrcIntData->Profile.StepStart = Now;
+  CopyMem (Start, &MrcIntData->AccessCount, sizeof (MrcIntAccessCount));
+}
+
+/**
+  MRC checkpoint callback used while profiling. Starts a new step and calls the
+  checkpoint callback that was installed before.
+
+  @param[in] GlobalData           - Pointer to the MRC global data structure.
+  @param[in] CheckPoint           - MrcOemStatusCommand of the step about to run.
+  @param[in] Status               - General pointer passed on to the original callback.
+
+  @retval The status returned by the original checkpoint callback.
+**/
+STATIC
+UINT32
+MrcProfileCheckpoint (
+  IN VOID                         *GlobalData,
+  IN UINT32                       CheckPoint,
+  IN VOID                         *Status
+  )
+{
+  MrcIntOutput     *MrcIntData;
+  MRC_PROFILE_DATA *Profile;
+  UINT32           Result;
+
+  MrcIntData = (MrcIntOutput *) ((MrcParameters *) GlobalData)->IntOutputs.Internal;
+  Profile    = (MRC_PROFILE_DATA *) MrcIntData->Profile.Data;
+
+  MrcProfileCloseStep (MrcIntData, GetPerformanceCounter ());
+  MrcIntData->Profile.Step = CheckPoint;
+  if (CheckPoint < MRC_PROFILE_MAX_STEPS) {
+    Profile->Step[CheckPoint].Calls++;
+  }
+
+  Result = MrcIntData->Profile.Checkpoint (GlobalData, CheckPoint, Status);
+
+  //
+  // Leave the platform callback out of the step time.
+  //
+  MrcIntData->Profile.StepStart = GetPerformanceCounter ();
+  return Result;
+}
+
+/**
+  Create the MRC profile HOB and hook the MRC checkpoint callback.
+
+  @param[in, out] MrcData         - Pointer to the MRC global data structure.
+**/
+VOID
+MrcProfileInstall (
+  IN OUT MrcParameters            *MrcData
+  )
+{
+  MrcIntOutput       *MrcIntData;
+  MRC_FUNCTION       *MrcCall;
+  MRC_PROFILE_SCHEMA *Schema;
+
+  MrcIntData = (MrcIntOutput *) MrcData->IntOutputs.Internal;
+  MrcCall    = MrcData->Inputs.Call.Func;
+
+  Schema = BuildGuidHob (&gMrcProfileSchemaGuid, sizeof (MRC_PROFILE_SCHEMA));
+  if (Schema == NULL) {
+    DEBUG ((DEBUG_WARN, "MRC profile HOB could not be created\n"));
+    return;
+  }
+  ZeroMem (Schema, sizeof (MRC_PROFILE_SCHEMA));
+  CopyMem (&Schema->SchemaHeader.SchemaId, &gMrcProfileSchemaGuid, sizeof (EFI_GUID));
+  Schema->SchemaHeader.DataSize = sizeof (MRC_PROFILE_SCHEMA);
+  GetDimmCrc ((const UINT8 *const) &Schema->SchemaHeader, sizeof (MRC_BDAT_SCHEMA_HEADER_STRUCTURE), &Schema->SchemaHeader.Crc16);
+  Schema->Profile.Revision  = MRC_PROFILE_REVISION;
+  Schema->Profile.StepCount = (UINT8) MIN (OemNumOfCommands, MRC_PROFILE_MAX_STEPS);
+
+  MrcIntData->Profile.Data       = &Schema->Profile;
+  MrcIntData->Profile.Checkpoint = MrcCall->MrcCheckpoint;
+  MrcIntData->Profile.Step       = MRC_PROFILE_NO_STEP;
+  MrcCall->MrcCheckpoint         = (MRC_CHECKPOINT) MrcProfileCheckpoint;
+}
+
+/**
+  Close the last MRC step, complete the profile HOB and add it to the BDAT schema list.
+
+  @param[in, out] MrcData         - Pointer to the MRC global data structure.
+**/
+VOID
+MrcProfileFinalize (
+  IN OUT MrcParameters            *MrcData
+  )
+{
+  MrcIntOutput             *MrcIntData;
+  MrcOutput                *Outputs;
+  MRC_PROFILE_DATA         *Profile;
+  MRC_HEAP_STATS           HeapStats;
+  MRC_PROFILE_STEP         *Step;
+  UINT8                    Controller;
+  UINT8                    Channel;
+  UINT32                   Index;
+
+  MrcIntData = (MrcIntOutput *) MrcData->IntOutputs.Internal;
+  Outputs    = &MrcData->Outputs;
+  Profile    = (MRC_PROFILE_DATA *) MrcIntData->Profile.Data;
+  if (Profile == NULL) {
+    return;
+  }
+
+  MrcProfileCloseStep (MrcIntData, GetPerformanceCounter ());
+  MrcIntData->Profile.Step = MRC_PROFILE_NO_STEP;
+
+  Profile->BootMode  = (UINT8) MrcData->Inputs.BootMode;
+  Profile->DdrType   = (UINT8) Outputs->DdrType;
+  Profile->Frequency = Outputs->Frequency;
+  for (Controller = 0; Controller < MAX_CONTROLLERS; Controller++) {
+    for (Channel = 0; Channel < MAX_CHANNEL; Channel++) {
+      Profile->RankMask[Controller][Channel] = Outputs->Controller[Controller].Channel[Channel].ValidRankBitMask;
+    }
+  }
+
+  MrcHeapGetStats (MrcData, &HeapStats);
+  Profile->HeapSize          = MrcData->Inputs.HeapSize;
+  Profile->HeapHighWater     = HeapStats.HighWater;
+  Profile->HeapAllocCount    = HeapStats.AllocCount;
+  Profile->HeapFailCount     = HeapStats.FailCount;
+  Profile->HeapFreeListBytes = HeapStats.FreeListBytes;
+
+  DEBUG ((DEBUG_INFO, "MRC profile, total %d us\n Step  Calls  Time(us)  CrReads  CrWrites  CacheHits\n", Profile->TotalTimeUs));
+  for (Index = 0; Index < Profile->StepCount; Index++) {
+    Step = &Profile->Step[Index];
+    if (Step->Calls != 0) {
+      DEBUG ((
+        DEBUG_INFO,
+        " %4d  %5d  %8d  %7d  %8d  %9d\n",
+        Index,
+        Step->Calls,
+        Step->TimeUs,
+        Step->CrReads,
+        Step->CrWrites,
+        Step->CacheHits
+        ));
+    }
+  }
+
+#ifdef BDAT_SUPPORT
+  MrcBdatAddSchemaToList (MrcData, &gMrcProfileSchemaGuid);
+#endif
+}
@@ -582,6 +582,50 @@ FillMargin2DBdatStructure (
   Margin2DResults->Metadata.ResultEleCount = (UINT16) *ResultElementCount;
 } // FillBdatStructure
 
+/**
+  Add a schema GUID to the BDAT schema list. When the current schema list HOB is full,
+  the list continues in a new schema list HOB.
+
+  @param[in, out] MrcData    - Constant pointer to the Mrc data structure.
+  @param[in]      SchemaGuid - GUID of the HOB that holds the schema.
+
+  @retval mrcSuccess if the GUID was added, otherwise mrcFail.
+**/
+MrcStatus
+MrcBdatAddSchemaToList (
+  IN OUT MrcParameters  *const MrcData,
+  IN     const EFI_GUID *const SchemaGuid
+  )
+{
+#ifndef MRC_MINIBIOS_BUILD
+  const MRC_FUNCTION       *MrcCall;
+  MrcOutput                *Outputs;
+  MRC_BDAT_SCHEMA_LIST_HOB *SchemaList;
+  EFI_STATUS               Status;
+
+  MrcCall    = MrcData->Inputs.Call.Func;
+  Outputs    = &MrcData->Outputs;
+  SchemaList = Outputs->BdatSchemasHob.Pointer;
+  if (SchemaList == NULL) {
+    return mrcFail;
+  }
+
+  if (SchemaList->SchemaHobCount >= MAX_SCHEMA_LIST_LENGTH) {
+    Status = MrcGetHobForDataStorage ((VOID **) &SchemaList, sizeof (MRC_BDAT_SCHEMA_LIST_HOB), &gMrcSchemaListHobGuid);
+    if (Status != EFI_SUCCESS) {
+      return mrcFail;
+    }
+    Outputs->BdatSchemasHob.Pointer = SchemaList;
+  }
+
+  // Housekeeping for the list of schema IDs
+  MrcCall->MrcCopyMem ((UINT8 *) &SchemaList->SchemaHobGuids[SchemaList->SchemaHobCount], (UINT8 *) SchemaGuid, sizeof (EFI_GUID));
+  SchemaList->SchemaHobCount++;
+  MRC_DEBUG_MSG (&Outputs->Debug, MSG_LEVEL_NOTE, ">SchemaHobCount: %d \n", SchemaList->SchemaHobCount);
+#endif
+  return mrcSuccess;
+}
+
 /**
 @brief
   Fill the compatible data structure BDAT with the information provided by
@@ -604,7 +648,6 @@ MrcFillBdatStructure (
   MRC_BDAT_SCHEMA_HEADER_STRUCTURE *BdatSchemaHdrPtr;
   EFI_STATUS   Status;
   UINT8        Index;
-  UINT16       NextSchema;
   UINT32       BdatSchemaSize;
   UINT16       BdatHobSize;
   UINT8        BdatSchemaType;
@@ -650,10 +693,9 @@ MrcFillBdatStructure (
       if (Status == EFI_SUCCESS) {
         MRC_DEBUG_MSG (Debug, MSG_LEVEL_NOTE, "%s HOB at %08Xh\n", SchemaTypeString, Outputs->BdatMemoryHob[Index]);
         MRC_DEBUG_MSG (Debug, MSG_LEVEL_NOTE, "%s HOB size: %d\n", SchemaTypeString, BdatHobSize);
-        NextSchema = Outputs->BdatSchemasHob.Pointer->SchemaHobCount;
-        Outputs->BdatSchemasHob.Pointer->SchemaHobCount = NextSchema + 1;
-        MRC_DEBUG_MSG (Debug, MSG_LEVEL_NOTE, ">SchemaHobCount: %d \n", Outputs->BdatSchemasHob.Pointer->SchemaHobCount);
-        MrcCall->MrcCopyMem ((UINT8 *) &(Outputs->BdatSchemasHob.Pointer->SchemaHobGuids[NextSchema]), (UINT8 *) &gSsaBiosResultsGuid, sizeof (EFI_GUID));  // Housekeeping for the list of schema IDs
+        if (MrcBdatAddSchemaToList (MrcData, &gSsaBiosResultsGuid) != mrcSuccess) {
+          return mrcFail;
+        }
         BdatSchemaHdrPtr = (MRC_BDAT_SCHEMA_HEADER_STRUCTURE *) &((Outputs->BdatMemoryHob[Index].Pointer)->MemorySchema);
         MrcCall->MrcCopyMem ((UINT8 *) &BdatSchemaHdrPtr->SchemaId, (UINT8 *) &gSsaBiosResultsGuid, sizeof (EFI_GUID));
         BdatSchemaHdrPtr->DataSize = BdatSchemaSize;
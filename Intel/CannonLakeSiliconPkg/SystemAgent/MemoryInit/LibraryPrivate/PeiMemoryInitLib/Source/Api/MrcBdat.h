@@ -55,5 +55,21 @@ MrcFillBdatStructure (
   IN OUT MrcParameters *const MrcData
   );
 
+/**
+  Add a schema GUID to the BDAT schema list. When the current schema list HOB is full,
+  the list continues in a new schema list HOB.
+
+  @param[in, out] MrcData    - Constant pointer to the Mrc data structure.
+  @param[in]      SchemaGuid - GUID of the HOB that holds the schema.
+
+  @retval mrcSuccess if the GUID was added, otherwise mrcFail.
+**/
+extern
+MrcStatus
+MrcBdatAddSchemaToList (
+  IN OUT MrcParameters  *const MrcData,
+  IN     const EFI_GUID *const SchemaGuid
+  );
+
 #pragma pack(pop)
 #endif // _MrcBdat_h_
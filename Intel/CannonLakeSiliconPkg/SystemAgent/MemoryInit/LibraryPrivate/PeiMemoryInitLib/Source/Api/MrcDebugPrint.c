@@ -828,11 +828,11 @@ MrcSerialBufferMalloc (
   MrcInput *Inputs;
 
   Inputs = &MrcData->Inputs;
-  for (Inputs->SerialBufferSize = Inputs->HeapSize / 2; (Inputs->SerialBufferSize > 0); Inputs->SerialBufferSize /= 2) {
-    Inputs->SerialBuffer.Ptr = MrcHeapMalloc (MrcData, Inputs->SerialBufferSize);
-    if (Inputs->SerialBuffer.Ptr != 0) {
-      break;
-    }
+  // Use up to half of the heap, limited to what the heap can still provide.
+  Inputs->SerialBufferSize = MIN (Inputs->HeapSize / 2, MrcHeapLargestFree (MrcData));
+  Inputs->SerialBuffer.Ptr = (Inputs->SerialBufferSize > 0) ? MrcHeapMalloc (MrcData, Inputs->SerialBufferSize) : NULL;
+  if (Inputs->SerialBuffer.Ptr == NULL) {
+    Inputs->SerialBufferSize = 0;
   }
 }
 #endif // MRC_DEBUG_PRINT
@@ -1030,6 +1030,428 @@ MrcCalculateCrc32 (
   return ~crc;
 }
 
+//
+// Compact saved data stream format, following MrcSaveCompactHeader:
+//   Control byte < 0x80  : (Control + 1) literal bytes follow.
+//   Control byte >= 0x80 : copy ((Control & 0x7F) + MRC_LZ_MIN_MATCH) bytes from Distance bytes back in the
+//                          expanded data, Distance follows as a little endian UINT16.
+// Zero (reset default) register runs and repeated SA GV point values collapse into matches.
+//
+#define MRC_LZ_MIN_MATCH    3
+#define MRC_LZ_MAX_MATCH    (0x7F + MRC_LZ_MIN_MATCH)
+#define MRC_LZ_MAX_LITERAL  0x80
+#define MRC_LZ_HASH_BITS    10
+#define MRC_LZ_HASH_EMPTY   0xFFFF
+
+/**
+  Returns the number of registers described by a save data control table.
+
+  @param[in] Table     - Pointer to the save data control table.
+  @param[in] TableSize - Number of entries in the table.
+
+  @retval The number of UINT32 registers covered by the table.
+**/
+static
+UINT32
+MrcSaveRegisterCount (
+  IN     const SaveDataControl *const Table,
+  IN     const UINT32          TableSize
+  )
+{
+  UINT32 Index;
+  UINT32 Count;
+
+  Count = 0;
+  for (Index = 0; Index < TableSize; Index++) {
+    Count += ((Table[Index].EndMchbarOffset - Table[Index].StartMchbarOffset) / sizeof (UINT32)) + 1;
+  }
+  return Count;
+}
+
+/**
+  Returns the number of per-byte registers described by a short save data control table.
+
+  @param[in] Table     - Pointer to the short save data control table.
+  @param[in] TableSize - Number of entries in the table.
+
+  @retval The number of UINT32 registers covered by the table, per byte.
+**/
+static
+UINT32
+MrcSaveRegisterCountShort (
+  IN     const SaveDataControlShort *const Table,
+  IN     const UINT32               TableSize
+  )
+{
+  UINT32 Index;
+  UINT32 Count;
+
+  Count = 0;
+  for (Index = 0; Index < TableSize; Index++) {
+    Count += ((Table[Index].EndMchbarOffset - Table[Index].StartMchbarOffset) / sizeof (UINT32)) + 1;
+  }
+  return Count;
+}
+
+/**
+  Delta codes the per-strobe registers of one register array against strobe 0 of the same channel.
+  Trained values are packed bit fields, so the delta is a XOR: fields equal to strobe 0 become zero.
+  Strobe 0 is not modified, which makes this function its own inverse.
+
+  @param[in, out] McRegister  - Pointer to the first per-byte register in the array.
+  @param[in]      RegCount    - Number of per-byte registers, as listed in the control table.
+  @param[in]      StrobeCount - Number of strobes saved per channel for each register.
+**/
+static
+void
+MrcSaveStrobeDeltaArray (
+  IN OUT UINT32       *McRegister,
+  IN     const UINT32 RegCount,
+  IN     const UINT32 StrobeCount
+  )
+{
+  UINT32 Index;
+  UINT32 Channel;
+  UINT32 Byte;
+
+  for (Index = 0; Index < RegCount; Index++) {
+    for (Channel = 0; Channel < MAX_CHANNEL; Channel++) {
+      for (Byte = 1; Byte < StrobeCount; Byte++) {
+        McRegister[Byte] ^= McRegister[0];
+      }
+      McRegister += StrobeCount;
+    }
+  }
+}
+
+/**
+  Applies or removes the per-strobe delta coding on all saved register arrays.
+  The layout follows the order in which MrcSaveMCValues fills the arrays.
+
+  @param[in, out] SaveData - Pointer to the saved data.
+**/
+static
+void
+MrcSaveStrobeDelta (
+  IN OUT MrcSaveData *const SaveData
+  )
+{
+  UINT32 PerByteCount;
+
+  PerByteCount = MrcSaveRegisterCountShort (SaveDataCommonPerByte, ARRAY_COUNT (SaveDataCommonPerByte));
+  MrcSaveStrobeDeltaArray (
+    &SaveData->RegSaveCommon[MrcSaveRegisterCount (SaveDataCommon, ARRAY_COUNT (SaveDataCommon))],
+    PerByteCount,
+    MAX_SDRAM_IN_DIMM
+    );
+
+  PerByteCount = MrcSaveRegisterCountShort (SaveDataSaGvPerByte, ARRAY_COUNT (SaveDataSaGvPerByte));
+  MrcSaveStrobeDeltaArray (
+    &SaveData->RegSaveLow[MrcSaveRegisterCount (SaveDataSaGv, ARRAY_COUNT (SaveDataSaGv))],
+    PerByteCount,
+    MAX_SDRAM_IN_DIMM - 1
+    );
+  MrcSaveStrobeDeltaArray (
+    &SaveData->RegSaveMid[MrcSaveRegisterCount (SaveDataSaGv, ARRAY_COUNT (SaveDataSaGv))],
+    PerByteCount,
+    MAX_SDRAM_IN_DIMM - 1
+    );
+  MrcSaveStrobeDeltaArray (
+    &SaveData->RegSaveHigh[MrcSaveRegisterCount (SaveDataSaGv, ARRAY_COUNT (SaveDataSaGv))],
+    PerByteCount,
+    MAX_SDRAM_IN_DIMM - 1
+    );
+}
+
+/**
+  Stores one byte of LZ output, or only counts it if there is no output buffer.
+
+  @param[out]     Dst     - Output buffer, or NULL.
+  @param[in]      DstSize - Size of the output buffer, in bytes.
+  @param[in, out] Out     - Current output position.
+  @param[in]      Value   - Byte to store.
+
+  @retval TRUE if the byte was stored or counted, FALSE if the output buffer is full.
+**/
+static
+BOOLEAN
+MrcLzPut (
+  OUT    UINT8        *const Dst,
+  IN     const UINT32 DstSize,
+  IN OUT UINT32       *const Out,
+  IN     const UINT8  Value
+  )
+{
+  if (Dst != NULL) {
+    if (*Out >= DstSize) {
+      return FALSE;
+    }
+    Dst[*Out] = Value;
+  }
+  (*Out)++;
+  return TRUE;
+}
+
+/**
+  Emits a run of literal bytes as one or more literal blocks.
+
+  @param[in]      Src     - Pointer to the first literal byte.
+  @param[in]      Count   - Number of literal bytes.
+  @param[out]     Dst     - Output buffer, or NULL.
+  @param[in]      DstSize - Size of the output buffer, in bytes.
+  @param[in, out] Out     - Current output position.
+
+  @retval TRUE if the literals were stored or counted, FALSE if the output buffer is full.
+**/
+static
+BOOLEAN
+MrcLzPutLiterals (
+  IN     const UINT8  *Src,
+  IN     UINT32       Count,
+  OUT    UINT8        *const Dst,
+  IN     const UINT32 DstSize,
+  IN OUT UINT32       *const Out
+  )
+{
+  UINT32 Block;
+
+  while (Count > 0) {
+    Block = MIN (Count, MRC_LZ_MAX_LITERAL);
+    if (!MrcLzPut (Dst, DstSize, Out, (UINT8) (Block - 1))) {
+      return FALSE;
+    }
+    Count -= Block;
+    while (Block-- > 0) {
+      if (!MrcLzPut (Dst, DstSize, Out, *Src++)) {
+        return FALSE;
+      }
+    }
+  }
+  return TRUE;
+}
+
+/**
+  LZ compresses a buffer using a single-probe hash of the next three bytes.
+
+  @param[in]  Src     - Pointer to the data to compress.
+  @param[in]  SrcSize - Size of the data, in bytes. Must be less than MRC_LZ_HASH_EMPTY.
+  @param[out] Dst     - Output buffer, or NULL to only calculate the compressed size.
+  @param[in]  DstSize - Size of the output buffer, in bytes.
+
+  @retval The compressed size in bytes, or 0 if it does not fit in the output buffer.
+**/
+static
+UINT32
+MrcLzCompress (
+  IN     const UINT8  *const Src,
+  IN     const UINT32 SrcSize,
+  OUT    UINT8        *const Dst,
+  IN     const UINT32 DstSize
+  )
+{
+  UINT16 HashTable[1 << MRC_LZ_HASH_BITS];
+  UINT32 Pos;
+  UINT32 Literal;
+  UINT32 Candidate;
+  UINT32 Distance;
+  UINT32 Length;
+  UINT32 Hash;
+  UINT32 Out;
+
+  if (SrcSize >= MRC_LZ_HASH_EMPTY) {
+    return 0;
+  }
+  for (Hash = 0; Hash < ARRAY_COUNT (HashTable); Hash++) {
+    HashTable[Hash] = MRC_LZ_HASH_EMPTY;
+  }
+
+  Out     = 0;
+  Pos     = 0;
+  Literal = 0;
+  while ((Pos + MRC_LZ_MIN_MATCH) <= SrcSize) {
+    Hash            = ((Src[Pos] << 16) | (Src[Pos + 1] << 8) | Src[Pos + 2]) * 2654435761U;
+    Hash          >>= (32 - MRC_LZ_HASH_BITS);
+    Candidate       = HashTable[Hash];
+    HashTable[Hash] = (UINT16) Pos;
+
+    Length   = 0;
+    Distance = 0;
+    if (Candidate != MRC_LZ_HASH_EMPTY) {
+      Distance = Pos - Candidate;
+      while (((Pos + Length) < SrcSize) && (Length < MRC_LZ_MAX_MATCH) && (Src[Candidate + Length] == Src[Pos + Length])) {
+        Length++;
+      }
+    }
+    if (Length < MRC_LZ_MIN_MATCH) {
+      Pos++;
+      continue;
+    }
+
+    if (!MrcLzPutLiterals (&Src[Literal], Pos - Literal, Dst, DstSize, &Out) ||
+        !MrcLzPut (Dst, DstSize, &Out, (UINT8) (0x80 | (Length - MRC_LZ_MIN_MATCH))) ||
+        !MrcLzPut (Dst, DstSize, &Out, (UINT8) Distance) ||
+        !MrcLzPut (Dst, DstSize, &Out, (UINT8) (Distance >> 8))) {
+      return 0;
+    }
+    Pos    += Length;
+    Literal = Pos;
+  }
+
+  if (!MrcLzPutLiterals (&Src[Literal], SrcSize - Literal, Dst, DstSize, &Out)) {
+    return 0;
+  }
+  return Out;
+}
+
+/**
+  Expands an LZ stream produced by MrcLzCompress.
+
+  @param[in]  Src     - Pointer to the compressed stream.
+  @param[in]  SrcSize - Size of the compressed stream, in bytes.
+  @param[out] Dst     - Output buffer.
+  @param[in]  DstSize - Expected size of the expanded data, in bytes.
+
+  @retval TRUE if the stream expanded to exactly DstSize bytes, otherwise FALSE.
+**/
+static
+BOOLEAN
+MrcLzExpand (
+  IN     const UINT8  *const Src,
+  IN     const UINT32 SrcSize,
+  OUT    UINT8        *const Dst,
+  IN     const UINT32 DstSize
+  )
+{
+  UINT32 In;
+  UINT32 Out;
+  UINT32 Length;
+  UINT32 Distance;
+  UINT8  Control;
+
+  In  = 0;
+  Out = 0;
+  while (In < SrcSize) {
+    Control = Src[In++];
+    if (Control < 0x80) {
+      Length = Control + 1;
+      if (((In + Length) > SrcSize) || ((Out + Length) > DstSize)) {
+        return FALSE;
+      }
+      while (Length-- > 0) {
+        Dst[Out++] = Src[In++];
+      }
+    } else {
+      Length = (Control & 0x7F) + MRC_LZ_MIN_MATCH;
+      if ((In + sizeof (UINT16)) > SrcSize) {
+        return FALSE;
+      }
+      Distance = Src[In] | (Src[In + 1] << 8);
+      In      += sizeof (UINT16);
+      if ((Distance == 0) || (Distance > Out) || ((Out + Length) > DstSize)) {
+        return FALSE;
+      }
+      // Matches may overlap their own output, so copy forward one byte at a time.
+      while (Length-- > 0) {
+        Dst[Out] = Dst[Out - Distance];
+        Out++;
+      }
+    }
+  }
+  return (Out == DstSize);
+}
+
+/**
+  Serializes the MRC saved data into the compact format used for NV storage.
+  Per-strobe registers are delta coded against strobe 0 of their channel and the result is LZ compressed.
+
+  @param[in, out] MrcData    - Include all the MRC global data. The saved data is left unchanged on return.
+  @param[out]     Buffer     - Location to store the compact stream, or NULL to only calculate its size.
+  @param[in]      BufferSize - Size of Buffer, in bytes.
+
+  @retval The size of the compact stream in bytes, or 0 if it does not fit in Buffer.
+**/
+UINT32
+MrcSaveCompact (
+  IN OUT MrcParameters *const MrcData,
+  OUT    UINT8         *const Buffer,
+  IN     const UINT32  BufferSize
+  )
+{
+  MrcSave              *Save;
+  MrcSaveCompactHeader *Compact;
+  UINT32               StreamSize;
+
+  Save = &MrcData->Save;
+  if ((Buffer != NULL) && (BufferSize <= sizeof (MrcSaveCompactHeader))) {
+    return 0;
+  }
+
+  // Delta code in place for the duration of the compression, then restore the original values.
+  MrcSaveStrobeDelta (&Save->Data);
+  StreamSize = MrcLzCompress (
+                 (const UINT8 *) &Save->Data,
+                 sizeof (MrcSaveData),
+                 (Buffer == NULL) ? NULL : &Buffer[sizeof (MrcSaveCompactHeader)],
+                 (Buffer == NULL) ? 0 : BufferSize - sizeof (MrcSaveCompactHeader)
+                 );
+  MrcSaveStrobeDelta (&Save->Data);
+  if (StreamSize == 0) {
+    return 0;
+  }
+
+  StreamSize += sizeof (MrcSaveCompactHeader);
+  if (Buffer != NULL) {
+    Compact             = (MrcSaveCompactHeader *) Buffer;
+    Compact->Size       = StreamSize;
+    Compact->Header.Crc = Save->Header.Crc;
+    Compact->Signature  = MRC_SAVE_COMPACT_SIGNATURE;
+    Compact->DataSize   = sizeof (MrcSaveData);
+  }
+  return StreamSize;
+}
+
+/**
+  Expands MRC saved data in the compact format back into an MrcSave structure.
+  The caller is still responsible for checking the CRC of the expanded data.
+
+  @param[in]  Buffer     - Pointer to the compact stream.
+  @param[in]  BufferSize - Size of Buffer, in bytes.
+  @param[out] Save       - Location to store the expanded saved data.
+
+  @retval mrcSuccess if Buffer holds a well formed compact stream, otherwise mrcFail.
+**/
+MrcStatus
+MrcSaveExpand (
+  IN     const UINT8  *const Buffer,
+  IN     const UINT32 BufferSize,
+  OUT    MrcSave      *const Save
+  )
+{
+  const MrcSaveCompactHeader *Compact;
+
+  Compact = (const MrcSaveCompactHeader *) Buffer;
+  if ((BufferSize < sizeof (MrcSaveCompactHeader)) ||
+      (Compact->Signature != MRC_SAVE_COMPACT_SIGNATURE) ||
+      (Compact->DataSize != sizeof (MrcSaveData)) ||
+      (Compact->Size < sizeof (MrcSaveCompactHeader)) ||
+      (Compact->Size > BufferSize)) {
+    return mrcFail;
+  }
+
+  if (!MrcLzExpand (
+         &Buffer[sizeof (MrcSaveCompactHeader)],
+         Compact->Size - sizeof (MrcSaveCompactHeader),
+         (UINT8 *) &Save->Data,
+         sizeof (MrcSaveData)
+         )) {
+    return mrcFail;
+  }
+  MrcSaveStrobeDelta (&Save->Data);
+  Save->Size       = sizeof (MrcSave);
+  Save->Header.Crc = Compact->Header.Crc;
+  return mrcSuccess;
+}
+
 
 #ifdef UP_SERVER_FLAG
 #ifdef MRC_DEBUG_PRINT
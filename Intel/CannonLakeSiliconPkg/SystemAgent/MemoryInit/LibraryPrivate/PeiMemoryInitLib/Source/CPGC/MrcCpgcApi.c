@@ -637,6 +637,173 @@ MrcGetErrCounterStatus (
   }
 }
 
+/**
+  This function builds the list of error counters to read for all populated channels.
+  It should be called once per test setup, after the counters were configured with MrcSetupErrCounterCtl().
+
+  @param[in]  MrcData     - Include all MRC global data.
+  @param[in]  ErrControl  - ErrCounterCtlAllLanes (one result per SubChannel) or ErrCounterCtlPerByte (one result per Byte).
+  @param[out] Plan        - Pointer to the error counter plan to build.
+
+  @retval mrcWrongInputParameter if ErrControl is not supported, otherwise mrcSuccess.
+**/
+MrcStatus
+MrcSetupErrCounterPlan (
+  IN  MrcParameters         *const  MrcData,
+  IN  MRC_ERR_COUNTER_CTL_TYPE      ErrControl,
+  OUT MRC_ERR_COUNTER_PLAN  *const  Plan
+  )
+{
+  MrcOutput *Outputs;
+  UINT32    Channel;
+  UINT32    SubChannel;
+  UINT32    Byte;
+  UINT8     Count;
+
+  Outputs          = &MrcData->Outputs;
+  Plan->ErrControl = ErrControl;
+  Plan->Count      = 0;
+  Count            = 0;
+
+  for (Channel = 0; Channel < MAX_CHANNEL; Channel++) {
+    if (!MrcChannelExist (Outputs, Channel)) {
+      continue;
+    }
+    switch (ErrControl) {
+      case ErrCounterCtlAllLanes:
+        for (SubChannel = 0; SubChannel < MAX_SUB_CHANNEL; SubChannel++) {
+          if (!MrcSubChannelExist (MrcData, Channel, SubChannel)) {
+            continue;
+          }
+          Plan->Counter[Count] = (UINT8) ((8 * Channel) + (4 * SubChannel));
+          Plan->Channel[Count] = (UINT8) Channel;
+          Plan->Index[Count]   = (UINT8) SubChannel;
+          Count++;
+          if ((SubChannel == 1) && (Outputs->EccSupport)) {
+            // ECC errors are added to SubChannel 1, same as MrcGetErrCounterStatus()
+            Plan->Counter[Count] = (Channel == 0) ? 16 : 17;
+            Plan->Channel[Count] = (UINT8) Channel;
+            Plan->Index[Count]   = (UINT8) SubChannel;
+            Count++;
+          }
+        }
+        break;
+
+      case ErrCounterCtlPerByte:
+        for (Byte = 0; Byte < MAX_SDRAM_IN_DIMM; Byte++) {
+          if (Byte < (MAX_SDRAM_IN_DIMM - 1)) {
+            Plan->Counter[Count] = (UINT8) ((8 * Channel) + Byte);
+          } else if (Outputs->EccSupport) {
+            Plan->Counter[Count] = (Channel == 0) ? 16 : 17;
+          } else {
+            continue;
+          }
+          Plan->Channel[Count] = (UINT8) Channel;
+          Plan->Index[Count]   = (UINT8) Byte;
+          Count++;
+        }
+        break;
+
+      default:
+        return mrcWrongInputParameter;
+    }
+  }
+
+  Plan->Count = Count;
+  return mrcSuccess;
+}
+
+/**
+  This function returns the Error Counter status of all counters in the plan.
+  Results of channels, subchannels or bytes that are not populated are returned as zero.
+
+  @param[in]  MrcData   - Include all MRC global data.
+  @param[in]  Plan      - Error counter plan built by MrcSetupErrCounterPlan().
+  @param[out] Status    - Counter status per Channel and SubChannel / Byte.
+  @param[out] Overflow  - Counter overflow per Channel and SubChannel / Byte.
+
+  @retval mrcFail if the test engine is not supported, otherwise mrcSuccess.
+**/
+MrcStatus
+MrcGetErrCounterStatusAll (
+  IN  MrcParameters               *const  MrcData,
+  IN  const MRC_ERR_COUNTER_PLAN  *const  Plan,
+  OUT UINT32                              Status[MAX_CHANNEL][MAX_SDRAM_IN_DIMM],
+  OUT BOOLEAN                             Overflow[MAX_CHANNEL][MAX_SDRAM_IN_DIMM]
+  )
+{
+  const MRC_FUNCTION  *MrcCall;
+  BOOLEAN             CounterOverflow;
+  UINT32              CounterStatus;
+  UINT8               Entry;
+
+  MrcCall = MrcData->Inputs.Call.Func;
+  MrcCall->MrcSetMem ((UINT8 *) Status, sizeof (UINT32) * MAX_CHANNEL * MAX_SDRAM_IN_DIMM, 0);
+  MrcCall->MrcSetMem ((UINT8 *) Overflow, sizeof (BOOLEAN) * MAX_CHANNEL * MAX_SDRAM_IN_DIMM, 0);
+
+  switch (MrcData->Inputs.TestEngine) {
+    case MrcTeCpgc15:
+      for (Entry = 0; Entry < Plan->Count; Entry++) {
+        Cpgc15GetErrCounterStatus (MrcData, Plan->Counter[Entry], &CounterStatus, &CounterOverflow);
+        Status[Plan->Channel[Entry]][Plan->Index[Entry]]   += CounterStatus;
+        Overflow[Plan->Channel[Entry]][Plan->Index[Entry]] |= CounterOverflow;
+      }
+      break;
+
+    case MrcTeCpgc10:
+    default:
+      return mrcFail;
+  }
+
+  return mrcSuccess;
+}
+
+/**
+  This function returns the Bit Group Error status results of all populated channels and subchannels.
+  Lane error status of subchannels that are not populated is returned as zero.
+
+  @param[in]  MrcData - Include all MRC global data.
+  @param[out] Status  - Lane error status per Channel, SubChannel and Byte.
+
+  @retval mrcFail if the test engine is not supported, otherwise mrcSuccess.
+**/
+MrcStatus
+MrcGetBitGroupErrStatusAll (
+  IN  MrcParameters *const  MrcData,
+  OUT UINT8                 Status[MAX_CHANNEL][MAX_SUB_CHANNEL][MAX_SDRAM_IN_DIMM]
+  )
+{
+  const MRC_FUNCTION  *MrcCall;
+  MrcOutput           *Outputs;
+  UINT32              Channel;
+  UINT32              SubChannel;
+
+  MrcCall = MrcData->Inputs.Call.Func;
+  Outputs = &MrcData->Outputs;
+  MrcCall->MrcSetMem ((UINT8 *) Status, MAX_CHANNEL * MAX_SUB_CHANNEL * MAX_SDRAM_IN_DIMM, 0);
+
+  switch (MrcData->Inputs.TestEngine) {
+    case MrcTeCpgc15:
+      for (Channel = 0; Channel < MAX_CHANNEL; Channel++) {
+        if (!MrcChannelExist (Outputs, Channel)) {
+          continue;
+        }
+        for (SubChannel = 0; SubChannel < MAX_SUB_CHANNEL; SubChannel++) {
+          if (MrcSubChannelExist (MrcData, Channel, SubChannel)) {
+            Cpgc15GetBitGroupErrStatus (MrcData, Channel, SubChannel, Status[Channel][SubChannel]);
+          }
+        }
+      }
+      break;
+
+    case MrcTeCpgc10:
+    default:
+      return mrcFail;
+  }
+
+  return mrcSuccess;
+}
+
 /**
   This function will program the PGs Mux Seeds.  The PGs must be selected before this call.
 
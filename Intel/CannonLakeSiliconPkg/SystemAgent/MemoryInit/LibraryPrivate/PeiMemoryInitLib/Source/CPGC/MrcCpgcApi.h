@@ -42,6 +42,7 @@
 #define MRC_CPGC_MAX_CHUNKS (8)
 #define MRC_NUM_MUX_SEEDS   (3)
 #define MRC_MUX_PB_LENGTH   (24)
+#define MRC_ERR_COUNTER_MAX (MAX_CHANNEL * MAX_SDRAM_IN_DIMM)  ///< Upper bound of error counters read by one MRC_ERR_COUNTER_PLAN.
 
 typedef enum {
   ErrCounterCtlAllLanes = 0,      ///< Indicates Counter Status will count errors for all lanes
@@ -91,6 +92,18 @@ typedef union {
   UINT32  Data32;
 } MRC_CA_MAP_TYPE;
 
+///
+/// Error counters that are read for all populated channels in one pass.
+/// Built once per test setup by MrcSetupErrCounterPlan() and consumed by MrcGetErrCounterStatusAll().
+///
+typedef struct {
+  MRC_ERR_COUNTER_CTL_TYPE  ErrControl;                     ///< ErrCounterCtlAllLanes or ErrCounterCtlPerByte.
+  UINT8                     Count;                          ///< Number of valid entries below.
+  UINT8                     Counter[MRC_ERR_COUNTER_MAX];   ///< CPGC error counter number to read.
+  UINT8                     Channel[MRC_ERR_COUNTER_MAX];   ///< Channel the counter result belongs to.
+  UINT8                     Index[MRC_ERR_COUNTER_MAX];     ///< SubChannel (AllLanes) or Byte (PerByte) the counter result is added to.
+} MRC_ERR_COUNTER_PLAN;
+
 ///
 /// Public Function Declaration
 ///
@@ -320,6 +333,57 @@ MrcGetErrCounterStatus (
   OUT BOOLEAN         *const    Overflow
   );
 
+/**
+  This function builds the list of error counters to read for all populated channels.
+  It should be called once per test setup, after the counters were configured with MrcSetupErrCounterCtl().
+
+  @param[in]  MrcData     - Include all MRC global data.
+  @param[in]  ErrControl  - ErrCounterCtlAllLanes (one result per SubChannel) or ErrCounterCtlPerByte (one result per Byte).
+  @param[out] Plan        - Pointer to the error counter plan to build.
+
+  @retval mrcWrongInputParameter if ErrControl is not supported, otherwise mrcSuccess.
+**/
+MrcStatus
+MrcSetupErrCounterPlan (
+  IN  MrcParameters         *const  MrcData,
+  IN  MRC_ERR_COUNTER_CTL_TYPE      ErrControl,
+  OUT MRC_ERR_COUNTER_PLAN  *const  Plan
+  );
+
+/**
+  This function returns the Error Counter status of all counters in the plan.
+  Results of channels, subchannels or bytes that are not populated are returned as zero.
+
+  @param[in]  MrcData   - Include all MRC global data.
+  @param[in]  Plan      - Error counter plan built by MrcSetupErrCounterPlan().
+  @param[out] Status    - Counter status per Channel and SubChannel / Byte.
+  @param[out] Overflow  - Counter overflow per Channel and SubChannel / Byte.
+
+  @retval mrcFail if the test engine is not supported, otherwise mrcSuccess.
+**/
+MrcStatus
+MrcGetErrCounterStatusAll (
+  IN  MrcParameters               *const  MrcData,
+  IN  const MRC_ERR_COUNTER_PLAN  *const  Plan,
+  OUT UINT32                              Status[MAX_CHANNEL][MAX_SDRAM_IN_DIMM],
+  OUT BOOLEAN                             Overflow[MAX_CHANNEL][MAX_SDRAM_IN_DIMM]
+  );
+
+/**
+  This function returns the Bit Group Error status results of all populated channels and subchannels.
+  Lane error status of subchannels that are not populated is returned as zero.
+
+  @param[in]  MrcData - Include all MRC global data.
+  @param[out] Status  - Lane error status per Channel, SubChannel and Byte.
+
+  @retval mrcFail if the test engine is not supported, otherwise mrcSuccess.
+**/
+MrcStatus
+MrcGetBitGroupErrStatusAll (
+  IN  MrcParameters *const  MrcData,
+  OUT UINT8                 Status[MAX_CHANNEL][MAX_SUB_CHANNEL][MAX_SDRAM_IN_DIMM]
+  );
+
 /**
   This function will program all present channels with the seeds passed in.
 
@@ -205,10 +205,12 @@ GetRegisterCachedData64 (
   }
 
   if (Count == 3) {
+    ((MrcIntOutput *) MrcData->IntOutputs.Internal)->AccessCount.CacheHits++;
     for (Pass = 0; Pass < (sizeof (Index) / sizeof (Index[0])); Pass++) {
       Value.Data32[Pass] = RegisterCache->Data[Index[Pass]].Data;
     }
   } else {
+    ((MrcIntOutput *) MrcData->IntOutputs.Internal)->AccessCount.CrReads++;
     Value.Data = MrcReadCR64 (MrcData, Offset);
     for (Pass = 0; Pass < (sizeof (Index) / sizeof (Index[0])); Pass++) {
       SetCache32 (MrcData, Reg[Pass], TRUE, FALSE, FALSE, Value.Data32[Pass]);
@@ -526,6 +528,7 @@ MrcFlushRegisterCachedData (
   for (Index = 0; Index < MAX_REGISTER_CACHE_ENTRIES; Index++) {
     Cache = &RegisterCache->Data[Index];
     if ((Cache->Flags.Bits.Valid != 0) && (Cache->Flags.Bits.Pending != 0)) {
+      MrcIntData->AccessCount.CrWrites++;
       if ((Cache->Flags.Bits.Size != 0) && (Index != MAX_REGISTER_CACHE_ENTRIES - 1)) {
         Value64.Data32.Low = Cache->Data;
         Value64.Data32.High = RegisterCache->Data[Index + 1].Data;
@@ -632,6 +635,7 @@ MrcCrCacheWrite (
 
   if (((Mode & GSM_FORCE_WRITE) != 0) || ((Mode & GSM_CACHE_ONLY) == 0)) {
     Pending = FALSE;
+    ((MrcIntOutput *) MrcData->IntOutputs.Internal)->AccessCount.CrWrites++;
     if (RegSize) {
       MrcWriteCR64 (MrcData, Offset, Value);
     } else {
@@ -691,6 +695,7 @@ MrcCrCacheRead (
       RegisterCache = &((MrcIntOutput *) MrcData->IntOutputs.Internal)->Controller[0].RegisterCache;
       Status        = SeekCacheLocation (MrcData, &Index, Offset);
       if (Status == RegCacheSuccess) {
+        ((MrcIntOutput *) MrcData->IntOutputs.Internal)->AccessCount.CacheHits++;
         return (RegisterCache->Data[Index].Data);
       }
     }
@@ -708,6 +713,7 @@ MrcCrCacheRead (
       );
   }
 
+  ((MrcIntOutput *) MrcData->IntOutputs.Internal)->AccessCount.CrReads++;
   Value.Data = RegSize ? MrcReadCR64 (MrcData, Offset) : MrcReadCR (MrcData, Offset);
   if ((!Multicast && ((Mode & GSM_UPDATE_CACHE) != 0))) {
     SetCache32 (MrcData, Offset, FALSE, FALSE, FALSE, Value.Data32.Low);
@@ -252,6 +252,26 @@ typedef struct {
 
 } MrcIntControllerOut;
 
+///
+/// Register access counters, used to profile the MRC steps.
+///
+typedef struct {
+  UINT32  CacheHits;  ///< Register reads satisfied from the register cache.
+  UINT32  CrReads;    ///< Register reads issued to MCHBAR by the register cache.
+  UINT32  CrWrites;   ///< Register writes issued to MCHBAR by the register cache.
+} MrcIntAccessCount;
+
+///
+/// State of the MRC step profile, see MrcProfile.c.
+///
+typedef struct {
+  void              *Data;        ///< The profile data being filled, NULL when profiling is disabled.
+  MRC_CHECKPOINT    Checkpoint;   ///< The checkpoint function that was installed before profiling.
+  UINT64            StepStart;    ///< Performance counter value at the last checkpoint.
+  MrcIntAccessCount StepAccess;   ///< Register access counters at the last checkpoint.
+  UINT32            Step;         ///< The checkpoint that started the current step.
+} MrcIntProfile;
+
 ///
 /// This data structure contains all the "global data" values that are considered output by the MRC.
 /// The following are system level definitions. All memory controllers in the system are set to these values.
@@ -270,6 +290,8 @@ typedef struct {
   UINT16                      ResistanceDynamicLeg;         ///< Resistance of a single dynamic leg
   UINT16                      ResistanceStaticLeg;          ///< Resistance of a single static leg
   UINT32                      PeiServices;
+  MrcIntAccessCount           AccessCount;                  ///< Register access counters since the start of the MRC.
+  MrcIntProfile               Profile;                      ///< MRC step profile state.
 } MrcIntOutput;
 
 #pragma pack (pop)
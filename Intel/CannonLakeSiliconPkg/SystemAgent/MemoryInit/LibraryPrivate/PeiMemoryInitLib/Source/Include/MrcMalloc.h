@@ -38,6 +38,18 @@
 #include "MrcInterface.h"
 #include "MrcDebugPrint.h"
 
+///
+/// Heap usage statistics, kept in the heap control block.
+///
+typedef struct {
+  UINT32  AllocCount;     ///< Number of successful allocations.
+  UINT32  FreeCount;      ///< Number of buffers released.
+  UINT32  FailCount;      ///< Number of allocations that could not be satisfied.
+  UINT32  InUse;          ///< Bytes currently allocated, including block headers.
+  UINT32  HighWater;      ///< Highest number of heap bytes ever carved, including the control block. Minimum HeapSize that avoids failures.
+  UINT32  FreeListBytes;  ///< Bytes held in free lists below the arena top.
+} MRC_HEAP_STATS;
+
 /**
   Function used to initialize the MRC memory used for heap.
 
@@ -85,4 +97,45 @@ MrcHeapFree (
   void                 *Buffer
   );
 
+/**
+  Function used to get the largest buffer size that MrcHeapMalloc can currently return.
+
+  @param[in] MrcData - The MRC global data area.
+
+  @retval Size in bytes of the largest available buffer, zero if the heap is exhausted or not initialized.
+**/
+extern
+UINT32
+MrcHeapLargestFree (
+  MrcParameters *const MrcData
+  );
+
+/**
+  Function used to get the heap usage statistics.
+
+  @param[in]  MrcData - The MRC global data area.
+  @param[out] Stats   - Heap usage statistics.
+
+  @retval mrcSuccess if the heap is initialized, otherwise mrcFail.
+**/
+extern
+MrcStatus
+MrcHeapGetStats (
+  MrcParameters  *const MrcData,
+  MRC_HEAP_STATS *const Stats
+  );
+
+/**
+  Function used to print the heap usage statistics to the MRC debug output.
+
+  @param[in] MrcData - The MRC global data area.
+
+  @retval Nothing.
+**/
+extern
+void
+MrcHeapReport (
+  MrcParameters *const MrcData
+  );
+
 #endif // _MrcMalloc_h_
@@ -0,0 +1,353 @@
+/** @file
+  Memory controller buffer allocation routines.
+
+@copyright
+  INTEL CONFIDENTIAL
+  Copyright 2014 - 2018 Intel Corporation.
+
+  The source code contained or described herein and all documents related to the
+  source code ("Material") are owned by Intel Corporation or its suppliers or
+  licensors. Title to the Material remains with Intel Corporation or its suppliers
+  and licensors. The Material may contain trade secrets and proprietary and
+  confidential information of Intel Corporation and its suppliers and licensors,
+  and is protected by worldwide copyright and trade secret laws and treaty
+  provisions. No part of the Material may be used, copied, reproduced, modified,
+  published, uploaded, posted, transmitted, distributed, or disclosed in any way
+  without Intel's prior express written permission.
+
+  No license under any patent, copyright, trade secret or other intellectual
+  property right is granted to or conferred upon you by disclosure or delivery
+  of the Materials, either expressly, by implication, inducement, estoppel or
+  otherwise. Any license under such intellectual property rights must be
+  express and approved by Intel in writing.
+
+  Unless otherwise agreed by Intel in writing, you may not remove or alter
+  this notice or any other notice embedded in Materials by Intel or
+  Intel's suppliers or licensors in any way.
+
+  This file contains an 'Intel Peripheral Driver' and is uniquely identified as
+  "Intel Reference Module" and is licensed for Intel CPUs and chipsets under
+  the terms of your license agreement with Intel or your vendor. This file may
+  be modified by the user, subject to additional terms of the license agreement.
+
+@par Specification Reference:
+**/
+#include "MrcMalloc.h"
+
+///
+/// The heap is an arena that is carved from the bottom up. Small buffers are rounded up to a
+/// power of two size class, and released buffers of each class are kept on a free list so that
+/// both allocation and release are O(1). Larger buffers are kept on a separate first fit list.
+/// Releasing the buffer at the top of the arena gives its space back to the arena.
+///
+#define MRC_HEAP_SIGNATURE        (0x5048524D)  ///< "MRHP"
+#define MRC_HEAP_BLOCK_SIGNATURE  (0xB10C)
+#define MRC_HEAP_ALIGNMENT        (8)
+#define MRC_HEAP_CLASS_MIN_SHIFT  (4)           ///< Smallest size class is 16 bytes.
+#define MRC_HEAP_CLASS_MAX        (5)           ///< Size classes 16, 32, 64, 128 and 256 bytes.
+#define MRC_HEAP_CLASS_LARGE      (MRC_HEAP_CLASS_MAX)
+#define MRC_HEAP_CLASS_SIZE(c)    (1 << ((c) + MRC_HEAP_CLASS_MIN_SHIFT))
+#define MRC_HEAP_ALIGN(x)         (((x) + (MRC_HEAP_ALIGNMENT - 1)) & ~(MRC_HEAP_ALIGNMENT - 1))
+
+typedef struct {
+  UINT32  Size;       ///< Buffer size in bytes, excluding this header.
+  UINT16  Class;      ///< Size class, or MRC_HEAP_CLASS_LARGE.
+  UINT16  Signature;  ///< MRC_HEAP_BLOCK_SIGNATURE while allocated, zero while on a free list.
+  UINT32  Next;       ///< Heap offset of the next free block of the same class, zero for the last one. Only valid while free.
+  UINT32  Reserved;
+} MRC_HEAP_BLOCK;
+
+typedef struct {
+  UINT32          Signature;
+  UINT32          Size;                               ///< Size of the heap in bytes, including this control block.
+  UINT32          Top;                                ///< Heap offset of the first byte not yet carved.
+  UINT32          FreeList[MRC_HEAP_CLASS_MAX + 1];   ///< Heap offset of the first free block per class, zero if empty.
+  MRC_HEAP_STATS  Stats;
+} MRC_HEAP_HEADER;
+
+/**
+  Return the heap control block, or NULL if the heap has not been initialized.
+
+  @param[in] MrcData - The MRC global data area.
+
+  @retval Pointer to the heap control block.
+**/
+static
+MRC_HEAP_HEADER *
+MrcHeapGetHeader (
+  MrcParameters *const MrcData
+  )
+{
+  MRC_HEAP_HEADER *Heap;
+
+  Heap = (MRC_HEAP_HEADER *) MrcData->Inputs.HeapBase.Ptr;
+  if ((Heap == NULL) || (Heap->Signature != MRC_HEAP_SIGNATURE)) {
+    return NULL;
+  }
+  return Heap;
+}
+
+/**
+  Function used to initialize the MRC memory used for heap.
+
+  @param[in, out] MrcData  - The MRC global data area.
+  @param[in]      HeapBase - The base address of the heap.
+  @param[in]      HeapSize - Amount of memory in bytes to allocate.
+
+  @retval mrcSuccess if the heap is usable, otherwise mrcFail.
+**/
+MrcStatus
+MrcHeapInitialize (
+  MrcParameters *const MrcData,
+  void          *HeapBase,
+  UINT32        HeapSize
+  )
+{
+  MrcInput        *Inputs;
+  MRC_HEAP_HEADER *Heap;
+
+  Inputs               = &MrcData->Inputs;
+  Inputs->HeapBase.Ptr = HeapBase;
+  Inputs->HeapSize     = HeapSize;
+  if ((HeapBase == NULL) || (HeapSize < MRC_HEAP_ALIGN (sizeof (MRC_HEAP_HEADER)))) {
+    Inputs->HeapBase.Ptr = NULL;
+    return mrcFail;
+  }
+
+  Heap = (MRC_HEAP_HEADER *) HeapBase;
+  Inputs->Call.Func->MrcSetMem ((UINT8 *) Heap, sizeof (MRC_HEAP_HEADER), 0);
+  Heap->Signature       = MRC_HEAP_SIGNATURE;
+  Heap->Size            = HeapSize;
+  Heap->Top             = MRC_HEAP_ALIGN (sizeof (MRC_HEAP_HEADER));
+  Heap->Stats.HighWater = Heap->Top;
+  return mrcSuccess;
+}
+
+/**
+  Function used to dynamically allocate memory.
+
+  @param[in, out] MrcData - The MRC global data area.
+  @param[in]         Size - Amount of memory in bytes to allocate.
+
+  @retval Returns a pointer to an allocated memory block on success or NULL on failure.
+**/
+void *
+MrcHeapMalloc (
+  MrcParameters *const MrcData,
+  UINT32               Size
+  )
+{
+  MRC_HEAP_HEADER *Heap;
+  MRC_HEAP_BLOCK  *Block;
+  UINT32          *Link;
+  UINT32          Offset;
+  UINT32          BlockSize;
+  UINT16          Class;
+
+  Heap = MrcHeapGetHeader (MrcData);
+  if ((Heap == NULL) || (Size == 0) || (Size > Heap->Size)) {
+    if (Heap != NULL) {
+      Heap->Stats.FailCount++;
+    }
+    return NULL;
+  }
+
+  BlockSize = MRC_HEAP_ALIGN (Size);
+  for (Class = 0; Class < MRC_HEAP_CLASS_MAX; Class++) {
+    if (BlockSize <= MRC_HEAP_CLASS_SIZE (Class)) {
+      BlockSize = MRC_HEAP_CLASS_SIZE (Class);
+      break;
+    }
+  }
+
+  Block = NULL;
+  Link  = &Heap->FreeList[Class];
+  if (Class < MRC_HEAP_CLASS_MAX) {
+    // Same size class, take the first one.
+    if (*Link != 0) {
+      Block = (MRC_HEAP_BLOCK *) ((UINT8 *) Heap + *Link);
+    }
+  } else {
+    // Large buffer, take the first one that is big enough.
+    while (*Link != 0) {
+      Block = (MRC_HEAP_BLOCK *) ((UINT8 *) Heap + *Link);
+      if (Block->Size >= BlockSize) {
+        break;
+      }
+      Link  = &Block->Next;
+      Block = NULL;
+    }
+  }
+
+  if (Block != NULL) {
+    *Link = Block->Next;
+    Heap->Stats.FreeListBytes -= sizeof (MRC_HEAP_BLOCK) + Block->Size;
+  } else {
+    Offset = Heap->Top;
+    if ((Heap->Size - Offset) < (sizeof (MRC_HEAP_BLOCK) + BlockSize)) {
+      Heap->Stats.FailCount++;
+      return NULL;
+    }
+    Block        = (MRC_HEAP_BLOCK *) ((UINT8 *) Heap + Offset);
+    Block->Size  = BlockSize;
+    Block->Class = Class;
+    Heap->Top    = Offset + sizeof (MRC_HEAP_BLOCK) + BlockSize;
+    Heap->Stats.HighWater = MAX (Heap->Stats.HighWater, Heap->Top);
+  }
+
+  Block->Signature = MRC_HEAP_BLOCK_SIGNATURE;
+  Block->Next      = 0;
+  Heap->Stats.AllocCount++;
+  Heap->Stats.InUse += sizeof (MRC_HEAP_BLOCK) + Block->Size;
+  return (void *) (Block + 1);
+}
+
+/**
+  Function used to release memory allocated using MrcMalloc.
+
+  @param[in, out] MrcData - The MRC global data area.
+  @param[in]      Buffer  - The buffer to return to the free pool.
+
+  @retval Nothing.
+**/
+void
+MrcHeapFree (
+  MrcParameters *const MrcData,
+  void                 *Buffer
+  )
+{
+  MRC_HEAP_HEADER *Heap;
+  MRC_HEAP_BLOCK  *Block;
+  UINT32          Offset;
+  UINT32          BlockSize;
+
+  Heap = MrcHeapGetHeader (MrcData);
+  if ((Heap == NULL) || (Buffer == NULL)) {
+    return;
+  }
+
+  Block  = (MRC_HEAP_BLOCK *) Buffer - 1;
+  Offset = (UINT32) ((UINT8 *) Block - (UINT8 *) Heap);
+  if ((Offset >= Heap->Top) || (Block->Signature != MRC_HEAP_BLOCK_SIGNATURE)) {
+    MRC_DEBUG_MSG (&MrcData->Outputs.Debug, MSG_LEVEL_ERROR, "MrcHeapFree: invalid buffer at heap offset %Xh\n", Offset);
+    return;
+  }
+
+  BlockSize        = sizeof (MRC_HEAP_BLOCK) + Block->Size;
+  Block->Signature = 0;
+  Heap->Stats.FreeCount++;
+  Heap->Stats.InUse -= BlockSize;
+
+  if (Heap->Stats.InUse == 0) {
+    // Nothing is allocated anymore, start over with an empty arena.
+    MrcData->Inputs.Call.Func->MrcSetMem ((UINT8 *) Heap->FreeList, sizeof (Heap->FreeList), 0);
+    Heap->Top                 = MRC_HEAP_ALIGN (sizeof (MRC_HEAP_HEADER));
+    Heap->Stats.FreeListBytes = 0;
+  } else if ((Offset + BlockSize) == Heap->Top) {
+    // Top of the arena, give the space back.
+    Heap->Top = Offset;
+  } else {
+    Block->Next                  = Heap->FreeList[Block->Class];
+    Heap->FreeList[Block->Class] = Offset;
+    Heap->Stats.FreeListBytes   += BlockSize;
+  }
+}
+
+/**
+  Function used to get the largest buffer size that MrcHeapMalloc can currently return.
+
+  @param[in] MrcData - The MRC global data area.
+
+  @retval Size in bytes of the largest available buffer, zero if the heap is exhausted or not initialized.
+**/
+UINT32
+MrcHeapLargestFree (
+  MrcParameters *const MrcData
+  )
+{
+  MRC_HEAP_HEADER *Heap;
+  MRC_HEAP_BLOCK  *Block;
+  UINT32          Offset;
+  UINT32          Largest;
+
+  Heap = MrcHeapGetHeader (MrcData);
+  if (Heap == NULL) {
+    return 0;
+  }
+
+  Largest = 0;
+  if ((Heap->Size - Heap->Top) > sizeof (MRC_HEAP_BLOCK)) {
+    Largest = (Heap->Size - Heap->Top - sizeof (MRC_HEAP_BLOCK)) & ~(MRC_HEAP_ALIGNMENT - 1);
+  }
+  for (Offset = Heap->FreeList[MRC_HEAP_CLASS_LARGE]; Offset != 0; Offset = Block->Next) {
+    Block   = (MRC_HEAP_BLOCK *) ((UINT8 *) Heap + Offset);
+    Largest = MAX (Largest, Block->Size);
+  }
+  return Largest;
+}
+
+/**
+  Function used to get the heap usage statistics.
+
+  @param[in]  MrcData - The MRC global data area.
+  @param[out] Stats   - Heap usage statistics.
+
+  @retval mrcSuccess if the heap is initialized, otherwise mrcFail.
+**/
+MrcStatus
+MrcHeapGetStats (
+  MrcParameters  *const MrcData,
+  MRC_HEAP_STATS *const Stats
+  )
+{
+  MRC_HEAP_HEADER *Heap;
+
+  Heap = MrcHeapGetHeader (MrcData);
+  if (Heap == NULL) {
+    MrcData->Inputs.Call.Func->MrcSetMem ((UINT8 *) Stats, sizeof (MRC_HEAP_STATS), 0);
+    return mrcFail;
+  }
+  MrcData->Inputs.Call.Func->MrcCopyMem ((UINT8 *) Stats, (UINT8 *) &Heap->Stats, sizeof (MRC_HEAP_STATS));
+  return mrcSuccess;
+}
+
+/**
+  Function used to print the heap usage statistics to the MRC debug output.
+  Fragmentation is the share of the free heap space that is held in free lists
+  below the arena top, and so only usable for buffers of the same size class.
+
+  @param[in] MrcData - The MRC global data area.
+
+  @retval Nothing.
+**/
+void
+MrcHeapReport (
+  MrcParameters *const MrcData
+  )
+{
+  MrcDebug        *Debug;
+  MRC_HEAP_HEADER *Heap;
+  UINT32          FreeBytes;
+  UINT32          Fragmentation;
+
+  Debug = &MrcData->Outputs.Debug;
+  Heap  = MrcHeapGetHeader (MrcData);
+  if (Heap == NULL) {
+    return;
+  }
+
+  FreeBytes     = (Heap->Size - Heap->Top) + Heap->Stats.FreeListBytes;
+  Fragmentation = (FreeBytes == 0) ? 0 : (Heap->Stats.FreeListBytes * 100) / FreeBytes;
+  MRC_DEBUG_MSG (
+    Debug,
+    MSG_LEVEL_NOTE,
+    "MRC heap: Size %u, HighWater %u, InUse %u, Allocs %u, Frees %u, Failed %u, Fragmentation %u%%\n",
+    Heap->Size,
+    Heap->Stats.HighWater,
+    Heap->Stats.InUse,
+    Heap->Stats.AllocCount,
+    Heap->Stats.FreeCount,
+    Heap->Stats.FailCount,
+    Fragmentation
+    );
+}